@@ -1,27 +1,62 @@
 #include "Action.h"
 
+// Names of the actions, by ActionId
+static const std::string ACTION_NAMES[] =
+{
+    "NONE",
+    "TOGGLE_GRID", "TOGGLE_BOUNDING_BOXES", "TOGGLE_TEXTURES",
+    "UP", "DOWN", "LEFT", "RIGHT", "RUN", "JUMP",
+    "REWIND", "SAVE_STATE", "LOAD_STATE"
+};
+static_assert(sizeof(ACTION_NAMES) / sizeof(ACTION_NAMES[0]) == (size_t) ActionId::COUNT, "Every action needs a name");
+
 Action::Action()
 {
 }
 
-Action::Action(const std::string & name, const std::string & type)
-    : m_name(name)
+Action::Action(ActionId id, ActionType type)
+    : m_id(id)
     , m_type(type)
 {
 }
 
-const std::string & Action::name() const
+ActionId Action::id() const
 {
-    return m_name;
+    return m_id;
 }
 
-const std::string & Action::type() const
+ActionType Action::type() const
 {
     return m_type;
 }
 
+const std::string & Action::name() const
+{
+    return getName(m_id);
+}
+
 std::string Action::toString() const
 {
-    // TODO
-    return "";
-}
\ No newline at end of file
+    return name() + (m_type == ActionType::START ? " START" : m_type == ActionType::END ? " END" : " NONE");
+}
+
+const std::string & Action::getName(ActionId id)
+{
+    return ACTION_NAMES[(size_t) id];
+}
+
+/**
+ * Returns the action with the given name, or NONE. For reading actions from text, not for game logic.
+ */
+ActionId Action::getId(const std::string & name)
+{
+    for (size_t i = 0; i < (size_t) ActionId::COUNT; i++)
+    {
+        if (ACTION_NAMES[i] == name)
+        {
+            return (ActionId) i;
+        }
+    }
+
+    return ActionId::NONE;
+}
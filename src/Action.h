@@ -1,17 +1,37 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
+
+// Every action a scene can register. Names, for config files and debugging, are in Action.cpp.
+enum class ActionId : uint8_t
+{
+    NONE,
+    TOGGLE_GRID, TOGGLE_BOUNDING_BOXES, TOGGLE_TEXTURES,
+    UP, DOWN, LEFT, RIGHT, RUN, JUMP,
+    REWIND, SAVE_STATE, LOAD_STATE,
+    COUNT
+};
+
+enum class ActionType : uint8_t
+{
+    NONE, START, END
+};
 
 class Action
 {
 private:
-    std::string m_name = "NONE";
-    std::string m_type = "NONE";
+    ActionId   m_id = ActionId::NONE;
+    ActionType m_type = ActionType::NONE;
 public:
     Action();
-    Action(const std::string & name, const std::string & type);
+    Action(ActionId id, ActionType type);
 
+    ActionId id() const;
+    ActionType type() const;
     const std::string & name() const;
-    const std::string & type() const;
     std::string toString() const;
-};
\ No newline at end of file
+
+    static const std::string & getName(ActionId id);
+    static ActionId getId(const std::string & name);
+};
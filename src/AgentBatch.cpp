@@ -0,0 +1,178 @@
+#include "AgentBatch.h"
+#include "PlayerKinematics.h"
+#include "Physics.h"
+#include "PhysicsConstants.h"
+#include <algorithm>
+
+// Number of agents handed to a worker at a time
+static const size_t AGENT_CHUNK_SIZE = 64;
+
+AgentBatch::AgentBatch(const TileMap & tileMap)
+    : m_tileMap(tileMap)
+{
+}
+
+/**
+ * Puts the tiles of a level in a tile map. Every tile is solid.
+ */
+void AgentBatch::buildTileMap(const EntitySpecVec & specs, TileMap & tileMap)
+{
+    for (const EntitySpec & spec : specs)
+    {
+        if (spec.type == "Tile")
+        {
+            tileMap.setTile((int) spec.gx, (int) spec.gy, tileMap.addType(spec.animation, TILE_SOLID));
+        }
+    }
+}
+
+/**
+ * Adds an agent, standing at the given position, and returns its index.
+ */
+size_t AgentBatch::addAgent(const Vec2 & pos, const InputScript & script)
+{
+    const CState cState;
+
+    m_posX.push_back(pos.x);
+    m_posY.push_back(pos.y);
+    m_prevPosX.push_back(pos.x);
+    m_prevPosY.push_back(pos.y);
+    m_velocityX.push_back(0);
+    m_velocityY.push_back(0);
+    m_accX.push_back(0);
+    m_accY.push_back(AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_S);
+    m_initialJumpXSpeed.push_back(cState.initialJumpXSpeed);
+    m_maxX.push_back(pos.x);
+    m_acceleration.push_back((uint8_t) cState.acceleration);
+    m_facingDir.push_back((uint8_t) cState.facingDir);
+    m_isGrounded.push_back(cState.isGrounded);
+    m_isSkidding.push_back(cState.isSkidding);
+    m_canJump.push_back(false);
+    m_isAlive.push_back(true);
+    m_scripts.push_back(script);
+
+    return m_posX.size() - 1;
+}
+
+/**
+ * Advances one agent by one frame.
+ */
+void AgentBatch::stepAgent(size_t i)
+{
+    if (!m_isAlive[i])
+    {
+        return;
+    }
+
+    const uint8_t buttons = m_frame < m_scripts[i].size() ? m_scripts[i][m_frame] : 0;
+
+    CInput cInput;
+    cInput.left = buttons & AGENT_LEFT;
+    cInput.right = buttons & AGENT_RIGHT;
+    cInput.B = buttons & AGENT_RUN;
+    cInput.A = buttons & AGENT_JUMP;
+    cInput.canJump = m_canJump[i];
+
+    CTransform cTransform;
+    cTransform.pos = Vec2(m_posX[i], m_posY[i]);
+    cTransform.prevPos = Vec2(m_prevPosX[i], m_prevPosY[i]);
+    cTransform.velocity = Vec2(m_velocityX[i], m_velocityY[i]);
+    cTransform.acc_x = m_accX[i];
+    cTransform.acc_y = m_accY[i];
+
+    CState cState;
+    cState.isGrounded = m_isGrounded[i];
+    cState.isSkidding = m_isSkidding[i];
+    cState.facingDir = (Direction) m_facingDir[i];
+    cState.acceleration = (Acceleration) m_acceleration[i];
+    cState.initialJumpXSpeed = m_initialJumpXSpeed[i];
+
+    PlayerKinematics::updateState(cTransform, cInput, cState);
+    PlayerKinematics::move(cTransform, cInput, cState);
+
+    // Fell off the map
+    if (cTransform.pos.y - m_halfSize.y > m_tileMap.worldHeight())
+    {
+        m_isAlive[i] = false;
+    }
+    else
+    {
+        // Can not move past the left edge of the level
+        if (cTransform.pos.x - m_halfSize.x < 0)
+        {
+            cTransform.pos.x = m_halfSize.x;
+        }
+
+        // Agent-tile collisions (detection & resolution), with the same rules as the player
+        BlockHit hits[COLLISION_DIRECTION_COUNT];
+        Physics::PickTileMapHits(m_tileMap, cTransform, m_halfSize, hits);
+        Physics::ResolveBlockHits(hits, m_halfSize, cTransform, cInput, cState, nullptr);
+    }
+
+    m_posX[i] = cTransform.pos.x;
+    m_posY[i] = cTransform.pos.y;
+    m_prevPosX[i] = cTransform.prevPos.x;
+    m_prevPosY[i] = cTransform.prevPos.y;
+    m_velocityX[i] = cTransform.velocity.x;
+    m_velocityY[i] = cTransform.velocity.y;
+    m_accX[i] = cTransform.acc_x;
+    m_accY[i] = cTransform.acc_y;
+    m_initialJumpXSpeed[i] = cState.initialJumpXSpeed;
+    m_maxX[i] = std::max(m_maxX[i], cTransform.pos.x);
+    m_acceleration[i] = (uint8_t) cState.acceleration;
+    m_facingDir[i] = (uint8_t) cState.facingDir;
+    m_isGrounded[i] = cState.isGrounded;
+    m_isSkidding[i] = cState.isSkidding;
+    m_canJump[i] = cInput.canJump;
+}
+
+/**
+ * Advances every agent by one frame, in parallel chunks if there is a job system.
+ */
+void AgentBatch::step(JobSystem * jobs)
+{
+    if (jobs == nullptr)
+    {
+        for (size_t i = 0; i < size(); i++)
+        {
+            stepAgent(i);
+        }
+    }
+    else
+    {
+        jobs->parallelFor(size(), AGENT_CHUNK_SIZE, [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                stepAgent(i);
+            }
+        });
+    }
+
+    m_frame++;
+}
+
+size_t AgentBatch::size() const
+{
+    return m_posX.size();
+}
+
+size_t AgentBatch::frame() const
+{
+    return m_frame;
+}
+
+Vec2 AgentBatch::position(size_t agent) const
+{
+    return Vec2(m_posX[agent], m_posY[agent]);
+}
+
+float AgentBatch::maxX(size_t agent) const
+{
+    return m_maxX[agent];
+}
+
+bool AgentBatch::isAlive(size_t agent) const
+{
+    return m_isAlive[agent];
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "JobSystem.h"
+#include "LevelStream.h"
+#include "TileMap.h"
+#include "Vec2.h"
+#include <cstdint>
+#include <vector>
+
+// Buttons held by an agent on one frame
+enum AgentButton : uint8_t
+{
+    AGENT_LEFT  = 1 << 0,
+    AGENT_RIGHT = 1 << 1,
+    AGENT_RUN   = 1 << 2,
+    AGENT_JUMP  = 1 << 3
+};
+
+// Buttons held on each frame. No buttons are held after the end of the script.
+typedef std::vector<uint8_t> InputScript;
+
+/**
+ * Many independent players (agents) running through the same level, for level testing.
+ * 
+ * Agent state is stored as a structure of arrays (one array per field), and step()
+ * advances every agent by one frame: scripted input, PlayerKinematics, and collisions with
+ * the solid cells of a shared, read-only tile map, with the same rules as the player in
+ * Scene_Play. Agents don't see each other, enemies, or the camera, and blocks hit from below
+ * don't change. Agents that fall off the bottom of the level are dead, and stop.
+ * 
+ * Each agent only reads and writes its own state, so agents are stepped in parallel chunks
+ * when given a job system, with the same results as a serial step.
+ */
+class AgentBatch
+{
+private:
+    const TileMap & m_tileMap;
+    Vec2            m_halfSize = { 28.f, 32.f };
+    size_t          m_frame = 0;
+
+    std::vector<float>    m_posX;
+    std::vector<float>    m_posY;
+    std::vector<float>    m_prevPosX;
+    std::vector<float>    m_prevPosY;
+    std::vector<float>    m_velocityX;
+    std::vector<float>    m_velocityY;
+    std::vector<double>   m_accX;
+    std::vector<double>   m_accY;
+    std::vector<float>    m_initialJumpXSpeed;
+    std::vector<float>    m_maxX;
+    std::vector<uint8_t>  m_acceleration; // Acceleration
+    std::vector<uint8_t>  m_facingDir;    // Direction
+    std::vector<uint8_t>  m_isGrounded;
+    std::vector<uint8_t>  m_isSkidding;
+    std::vector<uint8_t>  m_canJump;
+    std::vector<uint8_t>  m_isAlive;
+    std::vector<InputScript> m_scripts;
+
+    void stepAgent(size_t i);
+public:
+    AgentBatch(const TileMap & tileMap);
+
+    static void buildTileMap(const EntitySpecVec & specs, TileMap & tileMap);
+
+    size_t addAgent(const Vec2 & pos, const InputScript & script);
+    void step(JobSystem * jobs);
+
+    size_t size() const;
+    size_t frame() const;
+    Vec2 position(size_t agent) const;
+    float maxX(size_t agent) const;
+    bool isAlive(size_t agent) const;
+};
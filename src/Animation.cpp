@@ -1,5 +1,4 @@
 #include "Animation.h"
-#include <cmath>
 #include <cassert>
 #include <iostream>
 
@@ -33,63 +32,138 @@ Animation::Animation(const std::string & name, const sf::Texture & t, size_t fra
 {
 }
 
+// For single-frame or multi-frame textures, with the frames side by side over the whole texture
+Animation::Animation(const std::string & name, const sf::Texture & t, size_t frameCount, size_t speed, float scaleX, float scaleY, float ox, float oy)
+    : Animation(name, t, sf::IntRect(0, 0, t.getSize().x, t.getSize().y), frameCount, 1, frameCount, speed, scaleX, scaleY, ox, oy)
+{
+}
+
 /**
- * If ox or oy are -1, then the origin will placed on the center of the first frame.
+ * For sprite sheets: area (e.g. a sub-rect of a packed sheet) is split into rows of columns
+ * frames of the same size, and the first frameCount of them are played left to right, then
+ * top to bottom, each for speed game frames.
+ *
+ * If ox or oy are -1, then the origin will placed on the center of the frames.
  */
-Animation::Animation(const std::string & name, const sf::Texture & t, size_t frameCount, size_t speed, float scaleX, float scaleY, float ox, float oy)
-    : m_name(name)
-    , m_sprite(t)
-    , m_frameCount(frameCount)
-    , m_currentFrame(0)
-    , m_speed(speed)
+Animation::Animation(const std::string & name, const sf::Texture & t, const sf::IntRect & area, size_t columns, size_t rows, size_t frameCount, size_t speed, float scaleX, float scaleY, float ox, float oy)
+    : m_sprite(t)
+    , m_name(name)
 {
     assert(frameCount > 1 ? (speed > 0) : true); // Speed must be non-zero for multi-frame assets
-    m_size = Vec2((float)t.getSize().x / frameCount, (float)t.getSize().y);
-    if (ox == -1 || oy == -1)
+    assert(frameCount <= columns * rows && "More frames than the sheet has");
+    m_size = Vec2((float)area.width / columns, (float)area.height / rows);
+
+    sf::Vector2f origin (m_size.x / 2.0f, m_size.y / 2.0f);
+    if (ox != -1 && oy != -1)
     {
-        m_sprite.setOrigin(m_size.x / 2.0f, m_size.y / 2.0f);
+        std::cout << "Custom Origin " << ox << " " << oy << "\n";
+        origin = sf::Vector2f(ox, oy);
     }
-    else
+
+    std::vector<Frame> frames (frameCount);
+    for (size_t i = 0; i < frameCount; i++)
     {
-        std::cout << "Custom Origin " << ox << " " << oy << "\n";
-        m_sprite.setOrigin(ox,oy);
+        const size_t column = i % columns;
+        const size_t row = i / columns;
+        frames[i].rect = sf::IntRect(area.left + (int) (column * m_size.x), area.top + (int) (row * m_size.y), m_size.x, m_size.y);
+        frames[i].origin = origin;
+        frames[i].duration = speed;
     }
-    m_sprite.setTextureRect(sf::IntRect(0, 0, m_size.x, m_size.y));
+
+    setFrames(frames);
+    m_sprite.setScale(sf::Vector2f(scaleX, scaleY));
+}
+
+/**
+ * For frames of different sizes, origins, or durations. The size of the animation is the size
+ * of its first frame.
+ */
+Animation::Animation(const std::string & name, const sf::Texture & t, const std::vector<Frame> & frames, float scaleX, float scaleY)
+    : m_sprite(t)
+    , m_name(name)
+{
+    assert(!frames.empty() && "Animation has no frames");
+    m_size = Vec2(frames[0].rect.width, frames[0].rect.height);
+
+    setFrames(frames);
     m_sprite.setScale(sf::Vector2f(scaleX, scaleY));
 }
 
+/**
+ * Makes the frame table, with the frame shown at each game frame of a loop, and shows the first frame.
+ */
+void Animation::setFrames(const std::vector<Frame> & frames)
+{
+    std::shared_ptr<FrameTable> table = std::make_shared<FrameTable>();
+    table->frames = frames;
+    assert(frames.size() <= 65536 && "Too many frames");
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        assert(frames.size() > 1 ? (frames[i].duration > 0) : true); // Duration must be non-zero for multi-frame assets
+        table->starts.push_back(table->duration);
+        table->duration += frames[i].duration;
+        if (frames.size() > 1)
+        {
+            table->frameAt.insert(table->frameAt.end(), frames[i].duration, (uint16_t) i);
+        }
+    }
+
+    m_frames = table;
+    showFrame(0);
+}
+
+void Animation::showFrame(int index)
+{
+    const Frame & frame = m_frames->frames[index];
+    m_frameIndex = index;
+    m_sprite.setTextureRect(frame.rect);
+    m_sprite.setOrigin(frame.origin);
+}
+
 // Call once per frame.
 void Animation::update()
 {
-    m_currentFrame++;
+    setCurrentFrame(m_currentFrame + 1);
+}
 
-    if (m_frameCount > 1)
-    {
-        // zero-indexed frame count
-        int fullAnimationFramesPlayed = (int) floor(m_currentFrame / m_speed);
-        // zero-indexed animation frames
-        int currentAnimationFrame = fullAnimationFramesPlayed % m_frameCount;
+/*
+Number of times update() was called since the animation started.
+*/
+int Animation::getCurrentFrame() const
+{
+    return m_currentFrame;
+}
 
-        m_sprite.setTextureRect(sf::IntRect(currentAnimationFrame * m_size.x, 0, m_size.x, m_size.y));
+/*
+Sets the number of times update() was called since the animation started,
+and shows the texture frame for it. Used to restore saved animations.
+*/
+void Animation::setCurrentFrame(int frame)
+{
+    m_currentFrame = frame;
+
+    if (m_frames != nullptr && m_frames->frames.size() > 1)
+    {
+        const int index = m_frames->frameAt[m_currentFrame % m_frames->duration];
+        if (index != m_frameIndex)
+        {
+            showFrame(index);
+        }
     }
 }
 
 /*
     Returns true if all texture frames have been fully played.
     A texture frame has been fully played if it has been played for X
-    frames, where X is equal to the speed/duration. Else, it returns 
+    frames, where X is equal to its duration. Else, it returns 
     false.
 
     Note, a speed or duration of 0 always returns true.
 */
 bool Animation::hasEnded() const
 {
-    if (m_speed == 0 || floor(m_currentFrame / m_speed) >= (double) m_frameCount)
-    {
-        return true;
-    }
-
-    return false;
+    return m_frames == nullptr || m_currentFrame >= m_frames->duration;
 }
 
 const std::string & Animation::getName() const
@@ -97,6 +171,19 @@ const std::string & Animation::getName() const
     return m_name;
 }
 
+/*
+Id of the animation in Assets, or NONE. Faster to compare than names.
+*/
+AnimationId Animation::getId() const
+{
+    return m_id;
+}
+
+void Animation::setId(AnimationId id)
+{
+    m_id = id;
+}
+
 const Vec2 & Animation::getSize() const
 {
     return m_size;
@@ -107,34 +194,42 @@ sf::Sprite & Animation::getSprite()
     return m_sprite;
 }
 
+int Animation::getFrameCount() const
+{
+    return m_frames == nullptr ? 0 : (int) m_frames->frames.size();
+}
+
+const Animation::Frame & Animation::getFrame(int index) const
+{
+    assert(index < getFrameCount() && "Frame index is wrong.");
+
+    return m_frames->frames[index];
+}
+
 /*
 Returns the index of the texture frame that the animation
 is currently on.
 */
 int Animation::getCurrentAnimationFrameIndex() const
 {
-    if (m_speed == 0)
+    if (m_frames == nullptr || m_frames->frames.size() < 2)
     {
         return 0;
     }
 
-    // zero-indexed frame count
-    int fullAnimationFramesPlayed = (int) floor(m_currentFrame / m_speed);
-    // zero-indexed animation frames
-    int currentAnimationFrame = fullAnimationFramesPlayed % m_frameCount;
-
-    return currentAnimationFrame;
+    return m_frames->frameAt[m_currentFrame % m_frames->duration];
 }
 
 /*
 Sets the current texture frame the animation is on.
 
 This is what it does:
-currentFrame = index * speed
+currentFrame = the game frame the texture frame starts at
 
 Take this into account when using this method.
 */
 void Animation::setCurrentAnimationFrame(int index)
 {
-    m_currentFrame = index * m_speed;
+    const int frameCount = getFrameCount();
+    m_currentFrame = frameCount == 0 ? 0 : (index / frameCount) * m_frames->duration + m_frames->starts[index % frameCount];
 }
\ No newline at end of file
@@ -1,31 +1,71 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <memory>
 #include <string>
+#include <cstdint>
+#include <vector>
 
 #include "Vec2.h"
 
+typedef uint16_t AnimationId;
+
+/**
+ * An animation plays the frames of a frame table, which is made once, when the animation is made,
+ * and shared by its copies. Frames can come from a horizontal strip (the whole texture), a grid of
+ * rows and columns in a sub-rect of a packed sheet, or be given one by one, each with its own
+ * rect, origin and duration.
+ */
 class Animation
 {
+public:
+    struct Frame
+    {
+        sf::IntRect  rect;         // in the texture
+        sf::Vector2f origin;       // relative to the top left of rect
+        int          duration = 0; // game frames
+    };
 private:
+    struct FrameTable
+    {
+        std::vector<Frame>    frames;
+        std::vector<int>      starts;       // game frame each frame starts at
+        std::vector<uint16_t> frameAt;      // frame shown at each game frame of a loop
+        int                   duration = 0; // game frames in a loop
+    };
+
     sf::Sprite   m_sprite;
-    int          m_frameCount     = 0;
+    std::shared_ptr<const FrameTable> m_frames;
     int          m_currentFrame   = 0;
-    int          m_speed          = 0;
+    int          m_frameIndex     = 0; // frame the sprite shows
     Vec2         m_size           = { 0.0, 0.0 };
     std::string  m_name           = "";
+    AnimationId  m_id             = NONE;
+
+    void setFrames(const std::vector<Frame> & frames);
+    void showFrame(int index);
 public:
+    static const AnimationId NONE = 65535; // not added to Assets
+
     Animation();
     Animation(const std::string & name, const sf::Texture & t);
     Animation(const std::string & name, const sf::Texture & t, size_t duration);
     Animation(const std::string & name, const sf::Texture & t, size_t frameCount, size_t speed);
     Animation(const std::string & name, const sf::Texture & t, size_t frameCount, size_t speed, float scaleX, float scaleY);
     Animation(const std::string & name, const sf::Texture & t, size_t frameCount, size_t speed, float scaleX, float scaleY, float ox, float oy);
+    Animation(const std::string & name, const sf::Texture & t, const sf::IntRect & area, size_t columns, size_t rows, size_t frameCount, size_t speed, float scaleX, float scaleY, float ox, float oy);
+    Animation(const std::string & name, const sf::Texture & t, const std::vector<Frame> & frames, float scaleX, float scaleY);
     void update();
     bool hasEnded() const;
     const std::string & getName() const;
+    AnimationId getId() const;
+    void setId(AnimationId id);
     const Vec2 & getSize() const;
     sf::Sprite & getSprite();
+    int getFrameCount() const;
+    const Frame & getFrame(int index) const;
     int getCurrentAnimationFrameIndex() const;
     void setCurrentAnimationFrame(int index);
+    int getCurrentFrame() const;
+    void setCurrentFrame(int frame);
 };
@@ -0,0 +1,140 @@
+#include "AssetLoader.h"
+#include <thread>
+#include <cassert>
+
+AssetLoader::AssetLoader(Assets & assets, JobSystem * jobs, TextureResidency * residency)
+    : m_assets(assets)
+    , m_jobs(jobs)
+    , m_residency(residency)
+{
+}
+
+/**
+ * Waits for images still being decoded, since the decode jobs write into this object.
+ */
+AssetLoader::~AssetLoader()
+{
+    for (auto & request : m_textures)
+    {
+        while (!request->isDecoded)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void AssetLoader::decode(TextureRequest & request)
+{
+    request.result = request.image.loadFromFile(request.path);
+    request.isDecoded = true;
+}
+
+/**
+ * Reads the assets file, loads fonts, and starts decoding texture images.
+ */
+void AssetLoader::start(const std::string & assetsFilePath)
+{
+    AssetsFile assetsFile;
+    assetsFile.loadFromFile(assetsFilePath);
+
+    for (const AssetsFile::FileEntry & texture : assetsFile.getTextures())
+    {
+        std::unique_ptr<TextureRequest> request (new TextureRequest());
+        request->name = texture.name;
+        request->path = texture.path;
+        m_textures.push_back(std::move(request));
+    }
+
+    for (const AssetsFile::AnimationEntry & animation : assetsFile.getAnimations())
+    {
+        AnimationRequest request;
+        request.entry = animation;
+        m_animations.push_back(request);
+    }
+
+    for (const AssetsFile::FileEntry & font : assetsFile.getFonts())
+    {
+        m_assets.addFont(font.name, font.path);
+    }
+
+    m_total = m_textures.size() + m_animations.size();
+
+    for (auto & request : m_textures)
+    {
+        TextureRequest * r = request.get();
+        if (m_jobs != nullptr)
+        {
+            m_jobs->submit([this, r]() { decode(*r); });
+        }
+        else
+        {
+            decode(*r);
+        }
+    }
+}
+
+/**
+ * Uploads decoded images, and creates animations whose texture is ready.
+ * 
+ * Must be called on the thread that owns the window (OpenGL context).
+ * Returns true once everything is loaded.
+ */
+bool AssetLoader::update()
+{
+    for (auto & request : m_textures)
+    {
+        if (request->isUploaded || !request->isDecoded)
+        {
+            continue;
+        }
+
+        assert(request->result && "Failed to load texture");
+        m_assets.addTexture(request->name, request->image);
+        request->image = sf::Image(); // free decoded pixels
+        request->isUploaded = true;
+        m_loaded++;
+
+        // Animations need their texture's size, so are made before it can be evicted
+        if (m_residency != nullptr)
+        {
+            m_residency->add(request->name, request->path);
+            createAnimations();
+            m_residency->beginFrame();
+            m_residency->trim();
+        }
+    }
+
+    createAnimations();
+    return isDone();
+}
+
+/**
+ * Creates the animations whose texture is loaded.
+ */
+void AssetLoader::createAnimations()
+{
+    for (auto & request : m_animations)
+    {
+        if (request.isCreated || !m_assets.hasTexture(request.entry.texture))
+        {
+            continue;
+        }
+
+        m_assets.addAnimation(request.entry.name, request.entry.create(m_assets.getTexture(request.entry.texture)));
+        request.isCreated = true;
+        m_loaded++;
+    }
+}
+
+bool AssetLoader::isDone() const
+{
+    return m_loaded == m_total;
+}
+
+/**
+ * Fraction of textures and animations loaded, from 0 to 1.
+ */
+float AssetLoader::progress() const
+{
+    return m_total == 0 ? 1.f : (float) m_loaded / m_total;
+}
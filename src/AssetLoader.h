@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Assets.h"
+#include "AssetsFile.h"
+#include "JobSystem.h"
+#include "TextureResidency.h"
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Loads the assets listed in an assets file (see LevelSpecification.txt).
+ * 
+ * Fonts are loaded right away by start(). Texture images are decoded on the job system,
+ * while update() (called on the thread that owns the window) uploads decoded images into
+ * textures, and creates the animations whose textures are ready.
+ * 
+ * Without a job system, images are decoded by start() on the calling thread.
+ * 
+ * With texture residency, each texture's animations are made right after it is uploaded, and
+ * the least recently loaded textures are evicted as soon as they are over the budget.
+ */
+class AssetLoader
+{
+private:
+    struct TextureRequest
+    {
+        std::string       name;
+        std::string       path;
+        sf::Image         image;
+        bool              result = false;
+        std::atomic<bool> isDecoded { false };
+        bool              isUploaded = false;
+    };
+
+    struct AnimationRequest
+    {
+        AssetsFile::AnimationEntry entry;
+        bool                       isCreated = false;
+    };
+
+    Assets &    m_assets;
+    JobSystem * m_jobs = nullptr;
+    TextureResidency * m_residency = nullptr;
+    std::vector<std::unique_ptr<TextureRequest>> m_textures;
+    std::vector<AnimationRequest> m_animations;
+    size_t m_loaded = 0; // textures uploaded + animations created
+    size_t m_total = 0;
+
+    void decode(TextureRequest & request);
+    void createAnimations();
+public:
+    AssetLoader(Assets & assets, JobSystem * jobs, TextureResidency * residency = nullptr);
+    ~AssetLoader();
+
+    void start(const std::string & assetsFilePath);
+    bool update();
+    bool isDone() const;
+    float progress() const;
+};
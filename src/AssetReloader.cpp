@@ -0,0 +1,138 @@
+#include "AssetReloader.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+AssetReloader::AssetReloader()
+{
+}
+
+/**
+ * Reads the assets file as it was loaded, and starts watching it and its images.
+ */
+void AssetReloader::start(const std::string & assetsPath)
+{
+    m_assetsPath = assetsPath;
+    read(m_texturePaths, m_animations);
+    watchFiles();
+}
+
+/**
+ * Reads the textures and animations of the assets file, by name.
+ */
+bool AssetReloader::read(std::map<std::string, std::string> & texturePaths, std::map<std::string, AnimationEntry> & animations) const
+{
+    AssetsFile assetsFile;
+    if (!assetsFile.loadFromFile(m_assetsPath))
+    {
+        return false;
+    }
+
+    texturePaths.clear();
+    animations.clear();
+    for (const AssetsFile::FileEntry & texture : assetsFile.getTextures())
+    {
+        texturePaths[texture.name] = texture.path;
+    }
+    for (const AnimationEntry & animation : assetsFile.getAnimations())
+    {
+        animations[animation.name] = animation;
+    }
+
+    return true;
+}
+
+void AssetReloader::watchFiles()
+{
+    m_watcher.clear();
+    m_watcher.watch(m_assetsPath);
+    for (auto & texture : m_texturePaths)
+    {
+        m_watcher.watch(texture.second);
+    }
+}
+
+/**
+ * Reloads whatever changed since the last update, and appends the ids of the animations that
+ * were made again to changedAnimations. Returns true if anything was reloaded.
+ */
+bool AssetReloader::update(Assets & assets, TextureResidency * residency, std::vector<AnimationId> & changedAnimations)
+{
+    std::vector<std::string> changedFiles;
+    if (!m_watcher.poll(changedFiles))
+    {
+        return false;
+    }
+
+    sf::Clock clock;
+    const auto isChanged = [&changedFiles](const std::string & path)
+    {
+        return std::find(changedFiles.begin(), changedFiles.end(), path) != changedFiles.end();
+    };
+
+    // Keep the loaded assets if the new assets file can't be read
+    std::map<std::string, std::string> texturePaths = m_texturePaths;
+    std::map<std::string, AnimationEntry> animations = m_animations;
+    const bool isListChanged = isChanged(m_assetsPath);
+    if (isListChanged && !read(texturePaths, animations))
+    {
+        return false;
+    }
+
+    std::set<std::string> uploaded;
+    for (auto & texture : texturePaths)
+    {
+        auto old = m_texturePaths.find(texture.first);
+        if (old != m_texturePaths.end() && old->second == texture.second && !isChanged(texture.second))
+        {
+            continue;
+        }
+
+        // A texture that fails to load (e.g. still being written) keeps its old image
+        sf::Image image;
+        if (!image.loadFromFile(texture.second))
+        {
+            std::cout << "Error: could not load " << texture.second << "\n";
+            continue;
+        }
+        assets.addTexture(texture.first, image);
+        uploaded.insert(texture.first);
+        if (residency != nullptr)
+        {
+            residency->add(texture.first, texture.second);
+        }
+    }
+
+    for (auto & animation : animations)
+    {
+        const AnimationEntry & entry = animation.second;
+        auto old = m_animations.find(animation.first);
+        if (old != m_animations.end() && old->second == entry && uploaded.find(entry.texture) == uploaded.end())
+        {
+            continue;
+        }
+
+        if (!assets.hasTexture(entry.texture))
+        {
+            std::cout << "Error: animation " << animation.first << " uses missing texture " << entry.texture << "\n";
+            continue;
+        }
+        if (residency != nullptr)
+        {
+            residency->use(&assets.getTexture(entry.texture)); // animations need the texture's size
+        }
+        assets.addAnimation(animation.first, entry.create(assets.getTexture(entry.texture)));
+        changedAnimations.push_back(assets.getAnimationId(animation.first));
+    }
+
+    m_texturePaths.swap(texturePaths);
+    m_animations.swap(animations);
+    if (isListChanged)
+    {
+        watchFiles();
+    }
+
+    std::cout << "Hot reload: " << uploaded.size() << " textures and " << changedAnimations.size() << " animations in "
+              << clock.getElapsedTime().asMicroseconds() / 1000.0 << " ms\n";
+    return !uploaded.empty() || !changedAnimations.empty();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Assets.h"
+#include "AssetsFile.h"
+#include "FileWatcher.h"
+#include "TextureResidency.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Hot reloads textures and animations while the game runs.
+ *
+ * Watches the assets file and the images it lists. When the assets file changes, it is read
+ * again and compared with what was loaded; only textures that are new, have a new path, or whose
+ * image changed are uploaded again (into the same sf::Texture, so sprites keep pointing at it).
+ * Animations that are new, changed, or use an uploaded texture are made again, and keep their ids.
+ * Fonts, and assets removed from the file, are left as they are.
+ */
+class AssetReloader
+{
+private:
+    typedef AssetsFile::AnimationEntry AnimationEntry;
+
+    std::string                           m_assetsPath;
+    FileWatcher                           m_watcher;
+    std::map<std::string, std::string>    m_texturePaths; // texture name -> image path
+    std::map<std::string, AnimationEntry> m_animations;   // animation name -> entry
+
+    bool read(std::map<std::string, std::string> & texturePaths, std::map<std::string, AnimationEntry> & animations) const;
+    void watchFiles();
+public:
+    AssetReloader();
+
+    void start(const std::string & assetsPath);
+    bool update(Assets & assets, TextureResidency * residency, std::vector<AnimationId> & changedAnimations);
+};
@@ -6,18 +6,55 @@ Assets::Assets()
 {
 }
 
+/**
+ * Returns the texture named name, adding an empty one if there is none. A texture added again
+ * is loaded into the same sf::Texture, so sprites keep pointing at it.
+ */
+sf::Texture & Assets::textureSlot(const std::string & name)
+{
+    TextureId id = m_textureIds.find(name);
+    if (id == NameTable::NONE)
+    {
+        assert(m_textures.size() < NameTable::NONE && "Too many textures");
+        id = (TextureId) m_textures.size();
+        m_textureIds.insert(name, id);
+        m_textures.emplace_back(new sf::Texture());
+    }
+
+    return *m_textures[id];
+}
+
 void Assets::addTexture(const std::string & name, const std::string & path)
 {
-    sf::Texture texture;
-    bool result = texture.loadFromFile(path);
+    bool result = textureSlot(name).loadFromFile(path);
+    assert(result && "Failed to load texture");
+}
+
+/**
+ * Adds a texture from an already decoded image.
+ */
+void Assets::addTexture(const std::string & name, const sf::Image & image)
+{
+    bool result = textureSlot(name).loadFromImage(image);
     assert(result && "Failed to load texture");
-    
-    m_textures[name] = texture;
 }
 
+/**
+ * Adds an animation, and gives it an id. Adding an animation with the same name replaces it, and keeps its id.
+ */
 void Assets::addAnimation(const std::string & name, const Animation & animation)
 {
-    m_animations[name] = animation;
+    AnimationId id = m_animationIds.find(name);
+    if (id == NameTable::NONE)
+    {
+        assert(m_animations.size() < Animation::NONE && "Too many animations");
+        id = (AnimationId) m_animations.size();
+        m_animationIds.insert(name, id);
+        m_animations.emplace_back();
+    }
+
+    m_animations[id] = animation;
+    m_animations[id].setId(id);
 }
 
 void Assets::addSound(const std::string & name, const std::string & path)
@@ -30,30 +67,117 @@ void Assets::addFont(const std::string & name, const std::string & path)
     bool result = font.loadFromFile(path);
     assert(result && "Failed to load font");
 
-    m_fonts[name] = font;
+    FontId id = m_fontIds.find(name);
+    if (id == NameTable::NONE)
+    {
+        id = (FontId) m_fonts.size();
+        m_fontIds.insert(name, id);
+        m_fonts.emplace_back(new sf::Font());
+    }
+    *m_fonts[id] = font;
+}
+
+bool Assets::hasTexture(const std::string & name) const
+{
+    return m_textureIds.find(name) != NameTable::NONE;
+}
+
+TextureId Assets::getTextureId(const std::string & name) const
+{
+    const TextureId id = m_textureIds.find(name);
+    assert(id != NameTable::NONE && "Key is wrong or texture does not exist.");
+
+    return id;
+}
+
+const sf::Texture & Assets::getTexture(TextureId id) const
+{
+    assert(id < m_textures.size() && "Texture id is wrong.");
+
+    return *m_textures[id];
+}
+
+sf::Texture & Assets::getTexture(TextureId id)
+{
+    assert(id < m_textures.size() && "Texture id is wrong.");
+
+    return *m_textures[id];
 }
 
 const sf::Texture & Assets::getTexture(const std::string & name) const
 {
-    assert(m_textures.find(name) != m_textures.end() && "Key is wrong or texture does not exist.");
+    return *m_textures[getTextureId(name)];
+}
 
-    return m_textures.at(name);
+sf::Texture & Assets::getTexture(const std::string & name)
+{
+    return *m_textures[getTextureId(name)];
+}
+
+bool Assets::hasAnimation(const std::string & name) const
+{
+    return m_animationIds.find(name) != NameTable::NONE;
+}
+
+/**
+ * Returns the id of an animation. Look ids up once, when loading, and use them in game logic.
+ */
+AnimationId Assets::getAnimationId(const std::string & name) const
+{
+    const AnimationId id = m_animationIds.find(name);
+    assert(id != NameTable::NONE && "Key is wrong or animation does not exist.");
+
+    return id;
+}
+
+const Animation & Assets::getAnimation(AnimationId id) const
+{
+    assert(id < m_animations.size() && "Animation id is wrong.");
+
+    return m_animations[id];
 }
 
 const Animation & Assets::getAnimation(const std::string & name) const
 {
-    assert(m_animations.find(name) != m_animations.end() && "Key is wrong or animation does not exist.");
+    return m_animations[getAnimationId(name)];
+}
+
+SoundId Assets::getSoundId(const std::string & name) const
+{
+    const SoundId id = m_soundIds.find(name);
+    assert(id != NameTable::NONE && "Key is wrong or sound does not exist.");
 
-    return m_animations.at(name);
+    return id;
+}
+
+const sf::Sound & Assets::getSound(SoundId id) const
+{
+    assert(id < m_sounds.size() && "Sound id is wrong.");
+
+    return m_sounds[id];
 }
 
 const sf::Sound & Assets::getSound(const std::string & name) const
 {
+    return m_sounds[getSoundId(name)];
 }
 
-const sf::Font & Assets::getFont(const std::string & name) const
+FontId Assets::getFontId(const std::string & name) const
 {
-    assert(m_fonts.find(name) != m_fonts.end() && "Key is wrong or font does not exist.");
+    const FontId id = m_fontIds.find(name);
+    assert(id != NameTable::NONE && "Key is wrong or font does not exist.");
+
+    return id;
+}
 
-    return m_fonts.at(name);
+const sf::Font & Assets::getFont(FontId id) const
+{
+    assert(id < m_fonts.size() && "Font id is wrong.");
+
+    return *m_fonts[id];
+}
+
+const sf::Font & Assets::getFont(const std::string & name) const
+{
+    return *m_fonts[getFontId(name)];
 }
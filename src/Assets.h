@@ -2,27 +2,60 @@
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
-#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include "Animation.h"
+#include "NameTable.h"
 
+typedef uint16_t TextureId;
+typedef uint16_t SoundId;
+typedef uint16_t FontId;
+
+/**
+ * Assets are stored by id (a handle that stays valid for as long as Assets exists), and names
+ * are mapped to ids with a hash table. Look ids up once, when loading, and use them in game logic;
+ * getting an asset by id is an array index.
+ *
+ * Textures and fonts are kept behind pointers, as sprites and texts point at them: adding an asset
+ * never moves the ones already added.
+ */
 class Assets
 {
 private:
-    std::map<std::string, sf::Texture> m_textures;
-    std::map<std::string, Animation> m_animations;
-    std::map<std::string, sf::Sound> m_sounds;
-    std::map<std::string, sf::Font> m_fonts;
+    std::vector<std::unique_ptr<sf::Texture>> m_textures;   // by id
+    NameTable                                 m_textureIds; // name -> id
+    std::vector<Animation>                    m_animations;
+    NameTable                                 m_animationIds;
+    std::vector<sf::Sound>                    m_sounds;
+    NameTable                                 m_soundIds;
+    std::vector<std::unique_ptr<sf::Font>>    m_fonts;
+    NameTable                                 m_fontIds;
+
+    sf::Texture & textureSlot(const std::string & name);
 public:
     Assets();
 
     void addTexture(const std::string & name, const std::string & path);
+    void addTexture(const std::string & name, const sf::Image & image);
     void addAnimation(const std::string & name, const Animation & animation);
     void addSound(const std::string & name, const std::string & path);
     void addFont(const std::string & name, const std::string & path);
 
+    bool hasTexture(const std::string & name) const;
+    TextureId getTextureId(const std::string & name) const;
+    const sf::Texture & getTexture(TextureId id) const;
+    sf::Texture & getTexture(TextureId id);
     const sf::Texture & getTexture(const std::string & name) const;
+    sf::Texture & getTexture(const std::string & name);
+    bool hasAnimation(const std::string & name) const;
+    AnimationId getAnimationId(const std::string & name) const;
+    const Animation & getAnimation(AnimationId id) const;
     const Animation & getAnimation(const std::string & name) const;
+    SoundId getSoundId(const std::string & name) const;
+    const sf::Sound & getSound(SoundId id) const;
     const sf::Sound & getSound(const std::string & name) const;
+    FontId getFontId(const std::string & name) const;
+    const sf::Font & getFont(FontId id) const;
     const sf::Font & getFont(const std::string & name) const;
-};
\ No newline at end of file
+};
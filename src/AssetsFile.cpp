@@ -0,0 +1,98 @@
+#include "AssetsFile.h"
+#include <fstream>
+#include <iostream>
+
+/**
+ * Makes the animation from the frames of its strip, or of its sheet.
+ */
+Animation AssetsFile::AnimationEntry::create(const sf::Texture & t) const
+{
+    if (columns == 0)
+    {
+        return Animation(name, t, frameCount, speed, 1, 1, ox, oy);
+    }
+    return Animation(name, t, area, columns, rows, frameCount, speed, 1, 1, ox, oy);
+}
+
+bool AssetsFile::AnimationEntry::operator == (const AnimationEntry & rhs) const
+{
+    return name == rhs.name && texture == rhs.texture && area == rhs.area && columns == rhs.columns && rows == rhs.rows
+        && frameCount == rhs.frameCount && speed == rhs.speed && ox == rhs.ox && oy == rhs.oy;
+}
+
+AssetsFile::AssetsFile()
+{
+}
+
+/**
+ * Reads the textures, fonts, and animations (strip and sheet) of an assets file.
+ *
+ * Returns false if the file can't be opened, or has an unsupported asset type. Reading stops at
+ * an unsupported type, and the assets listed before it are kept.
+ */
+bool AssetsFile::loadFromFile(const std::string & path)
+{
+    m_textures.clear();
+    m_fonts.clear();
+    m_animations.clear();
+
+    std::ifstream assetsFile (path);
+
+    if (!assetsFile.is_open())
+    {
+        std::cout << "Error: could not open assets file.\n";
+        return false;
+    }
+
+    std::string type;
+    while (assetsFile >> type)
+    {
+        if (type == "Texture")
+        {
+            FileEntry entry;
+            assetsFile >> entry.name >> entry.path;
+            m_textures.push_back(entry);
+        }
+        else if (type == "Animation")
+        {
+            AnimationEntry entry;
+            assetsFile >> entry.name >> entry.texture >> entry.frameCount >> entry.speed >> entry.ox >> entry.oy;
+            m_animations.push_back(entry);
+        }
+        else if (type == "SheetAnimation")
+        {
+            AnimationEntry entry;
+            assetsFile >> entry.name >> entry.texture >> entry.area.left >> entry.area.top >> entry.area.width >> entry.area.height
+                       >> entry.columns >> entry.rows >> entry.frameCount >> entry.speed >> entry.ox >> entry.oy;
+            m_animations.push_back(entry);
+        }
+        else if (type == "Font")
+        {
+            FileEntry entry;
+            assetsFile >> entry.name >> entry.path;
+            m_fonts.push_back(entry);
+        }
+        else
+        {
+            std::cout << "Error: " << type << " is not a supported asset type.\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const std::vector<AssetsFile::FileEntry> & AssetsFile::getTextures() const
+{
+    return m_textures;
+}
+
+const std::vector<AssetsFile::FileEntry> & AssetsFile::getFonts() const
+{
+    return m_fonts;
+}
+
+const std::vector<AssetsFile::AnimationEntry> & AssetsFile::getAnimations() const
+{
+    return m_animations;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Animation.h"
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * The assets listed in an assets file (see LevelSpecification.txt), in the order they are listed.
+ *
+ * AssetLoader loads them, and AssetReloader compares them with what was loaded before.
+ */
+class AssetsFile
+{
+public:
+    struct FileEntry
+    {
+        std::string name;
+        std::string path;
+    };
+
+    struct AnimationEntry
+    {
+        std::string name;
+        std::string texture;
+        sf::IntRect area;        // sheet animations only
+        int         columns = 0; // 0: frames side by side over the whole texture
+        int         rows = 1;
+        int         frameCount = 0;
+        int         speed = 0;
+        float       ox = -1;
+        float       oy = -1;
+
+        Animation create(const sf::Texture & t) const;
+        bool operator == (const AnimationEntry & rhs) const;
+    };
+private:
+    std::vector<FileEntry>      m_textures;
+    std::vector<FileEntry>      m_fonts;
+    std::vector<AnimationEntry> m_animations;
+public:
+    AssetsFile();
+
+    bool loadFromFile(const std::string & path);
+
+    const std::vector<FileEntry> & getTextures() const;
+    const std::vector<FileEntry> & getFonts() const;
+    const std::vector<AnimationEntry> & getAnimations() const;
+};
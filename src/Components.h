@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 #include "Vec2.h"
 
 #include "Animation.h"
@@ -68,6 +69,14 @@ public:
         : size(s), halfSize(s.x / 2, s.y / 2) {}
 };
 
+class CTile : public Component
+{
+public:
+    uint8_t flags = 0; // TileFlags, see TileMap.h
+    CTile() {}
+    CTile(uint8_t flags) : flags(flags) {}
+};
+
 class CAnimation : public Component
 {
 public:
@@ -0,0 +1,130 @@
+#include "DebugGrid.h"
+#include <cmath>
+#include <cassert>
+
+DebugGrid::DebugGrid()
+{
+}
+
+/**
+ * Should be called once before rendering.
+ */
+void DebugGrid::init(const sf::Font & font, unsigned characterSize, const Vec2 & cellSize)
+{
+    m_font = &font;
+    m_characterSize = characterSize;
+    m_cellSize = cellSize;
+    m_isBuilt = false;
+
+    // Labels only use these characters
+    const std::string characters = "0123456789(),-";
+    for (char c : characters)
+    {
+        m_glyphs[(int) c] = font.getGlyph(c, characterSize, false);
+    }
+}
+
+/**
+ * Appends the quads of a label, with the top left of the label at (x, y).
+ * 
+ * Mirrors how sf::Text lays out a single line of text.
+ */
+void DebugGrid::appendLabel(const std::string & text, float x, float y)
+{
+    const float padding = 1.f;
+    const float baseline = y + m_characterSize;
+    char previous = 0;
+
+    for (char c : text)
+    {
+        const sf::Glyph & glyph = m_glyphs[(int) c];
+
+        x += m_font->getKerning(previous, c, m_characterSize);
+        previous = c;
+
+        const float left   = x + glyph.bounds.left - padding;
+        const float top    = baseline + glyph.bounds.top - padding;
+        const float right  = x + glyph.bounds.left + glyph.bounds.width + padding;
+        const float bottom = baseline + glyph.bounds.top + glyph.bounds.height + padding;
+
+        const float u1 = glyph.textureRect.left - padding;
+        const float v1 = glyph.textureRect.top - padding;
+        const float u2 = glyph.textureRect.left + glyph.textureRect.width + padding;
+        const float v2 = glyph.textureRect.top + glyph.textureRect.height + padding;
+
+        m_labels.append(sf::Vertex(sf::Vector2f(left, top), sf::Color::White, sf::Vector2f(u1, v1)));
+        m_labels.append(sf::Vertex(sf::Vector2f(right, top), sf::Color::White, sf::Vector2f(u2, v1)));
+        m_labels.append(sf::Vertex(sf::Vector2f(right, bottom), sf::Color::White, sf::Vector2f(u2, v2)));
+        m_labels.append(sf::Vertex(sf::Vector2f(left, bottom), sf::Color::White, sf::Vector2f(u1, v2)));
+
+        x += glyph.advance;
+    }
+}
+
+/**
+ * Rebuilds the lines and labels for the given columns.
+ */
+void DebugGrid::rebuild(int startColumn, int endColumn, const Vec2 & windowSize)
+{
+    m_lines.clear();
+    m_labels.clear();
+
+    const float heightWindow = windowSize.y;
+    const float leftEdge = m_cellSize.x * startColumn;
+    const float rightEdge = m_cellSize.x * (endColumn + 1);
+    const int horizontalLines = ceil(heightWindow / m_cellSize.y);
+
+    // Vertical lines
+    for (int i = startColumn; i < endColumn; i++)
+    {
+        const float x = m_cellSize.x * (i + 1);
+        m_lines.append(sf::Vertex(sf::Vector2f(x, 0), sf::Color::White));
+        m_lines.append(sf::Vertex(sf::Vector2f(x, heightWindow), sf::Color::White));
+    }
+
+    // Horizontal lines
+    for (int i = 0; i < horizontalLines; i++)
+    {
+        const float y = heightWindow - m_cellSize.y * (i + 1);
+        m_lines.append(sf::Vertex(sf::Vector2f(leftEdge, y), sf::Color::White));
+        m_lines.append(sf::Vertex(sf::Vector2f(rightEdge, y), sf::Color::White));
+    }
+
+    // Grid coordinates
+    for (int gx = startColumn; gx < endColumn; gx++)
+    {
+        for (int gy = 0; gy < horizontalLines; gy++)
+        {
+            const std::string label = "(" + std::to_string(gx) + "," + std::to_string(gy) + ")";
+            appendLabel(label, m_cellSize.x * gx, heightWindow - m_cellSize.y * (gy + 1));
+        }
+    }
+
+    m_startColumn = startColumn;
+    m_endColumn = endColumn;
+    m_windowSize = windowSize;
+    m_isBuilt = true;
+}
+
+/**
+ * Renders the grid as seen from the camera.
+ */
+void DebugGrid::render(sf::RenderTarget & target, const Vec2 & cameraPosition, const Vec2 & windowSize)
+{
+    assert(m_font != nullptr && "DebugGrid::init() must be called before rendering.");
+
+    const int startColumn = floor(cameraPosition.x / m_cellSize.x);
+    const int endColumn = startColumn + ceil(windowSize.x / m_cellSize.x) + 1;
+
+    if (!m_isBuilt || startColumn != m_startColumn || endColumn != m_endColumn || !(windowSize == m_windowSize))
+    {
+        rebuild(startColumn, endColumn, windowSize);
+    }
+
+    sf::RenderStates states;
+    states.transform.translate(-floor(cameraPosition.x), 0);
+    target.draw(m_lines, states);
+
+    states.texture = &m_font->getTexture(m_characterSize);
+    target.draw(m_labels, states);
+}
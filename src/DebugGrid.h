@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Vec2.h"
+#include <SFML/Graphics.hpp>
+#include <string>
+
+/**
+ * Renders the debugging grid (grid lines and cell coordinates) in two draw calls.
+ * 
+ * Lines and labels are built in world coordinates, and only rebuilt when the range
+ * of visible columns changes. Labels are made of quads using glyphs looked up once
+ * from the font, instead of laying out an sf::Text per cell.
+ */
+class DebugGrid
+{
+private:
+    const sf::Font * m_font = nullptr;
+    unsigned         m_characterSize = 12;
+    Vec2             m_cellSize = { 64.f, 64.f };
+    Vec2             m_windowSize = { 0.f, 0.f };
+    sf::Glyph        m_glyphs[128];  // glyph cache, ASCII only
+    sf::VertexArray  m_lines { sf::Lines };
+    sf::VertexArray  m_labels { sf::Quads };
+    int              m_startColumn = 0;
+    int              m_endColumn = 0;
+    bool             m_isBuilt = false;
+
+    void rebuild(int startColumn, int endColumn, const Vec2 & windowSize);
+    void appendLabel(const std::string & text, float x, float y);
+public:
+    DebugGrid();
+
+    void init(const sf::Font & font, unsigned characterSize, const Vec2 & cellSize);
+    void render(sf::RenderTarget & target, const Vec2 & cameraPosition, const Vec2 & windowSize);
+};
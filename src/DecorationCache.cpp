@@ -0,0 +1,195 @@
+#include "DecorationCache.h"
+#include <cmath>
+#include <iostream>
+
+DecorationCache::DecorationCache()
+{
+}
+
+/**
+ * Sets the parallax factor used for decorations with the given animation.
+ */
+void DecorationCache::setParallax(const std::string & animationName, float factor)
+{
+    m_parallax[animationName] = factor;
+    reset();
+}
+
+float DecorationCache::getParallax(const std::string & animationName) const
+{
+    auto it = m_parallax.find(animationName);
+    return it == m_parallax.end() ? 1.f : it->second;
+}
+
+/**
+ * Drops all rendered strips. They get rendered again when they are next visible.
+ */
+void DecorationCache::reset()
+{
+    for (auto & layer : m_layers)
+    {
+        for (auto & strip : layer.second.strips)
+        {
+            m_freeStrips.push_back(std::move(strip.second));
+        }
+    }
+
+    m_layers.clear();
+    m_isBuilt = false;
+}
+
+/**
+ * Buckets the current decorations by layer and strip. Rendered strips whose decorations changed
+ * since the last build are recycled, the others are kept.
+ */
+void DecorationCache::build(EntityManager & entityManager, const Vec2 & stripSize)
+{
+    if (!(stripSize == m_stripSize))
+    {
+        reset();
+        m_freeStrips.clear();
+        m_stripSize = stripSize;
+    }
+
+    std::map<float, std::map<int, EntityVec>> buckets;
+    for (auto & e : entityManager.getEntities("Decoration"))
+    {
+        const Animation & animation = e->getComponent<CAnimation>().animation;
+        const float x = e->getComponent<CTransform>().pos.x;
+        const float halfWidth = animation.getSize().x / 2;
+        std::map<int, EntityVec> & layer = buckets[getParallax(animation.getName())];
+
+        const int firstStrip = (int) std::floor((x - halfWidth) / m_stripSize.x);
+        const int lastStrip = (int) std::floor((x + halfWidth) / m_stripSize.x);
+        for (int i = firstStrip; i <= lastStrip; i++)
+        {
+            const float stripLeft = i * m_stripSize.x;
+            if (x + halfWidth > stripLeft && x - halfWidth < stripLeft + m_stripSize.x)
+            {
+                layer[i].push_back(e);
+            }
+        }
+    }
+
+    static const EntityVec NO_DECORATIONS;
+    const auto decorationsAt = [](const std::map<int, EntityVec> & strips, int index) -> const EntityVec &
+    {
+        auto it = strips.find(index);
+        return it == strips.end() ? NO_DECORATIONS : it->second;
+    };
+
+    for (auto it = m_layers.begin(); it != m_layers.end(); )
+    {
+        auto bucket = buckets.find(it->first);
+        Layer & layer = it->second;
+
+        for (auto strip = layer.strips.begin(); strip != layer.strips.end(); )
+        {
+            const bool isChanged = bucket == buckets.end() || decorationsAt(bucket->second, strip->first) != decorationsAt(layer.decorations, strip->first);
+            if (isChanged)
+            {
+                m_freeStrips.push_back(std::move(strip->second));
+                strip = layer.strips.erase(strip);
+            }
+            else
+            {
+                strip++;
+            }
+        }
+
+        it = bucket == buckets.end() ? m_layers.erase(it) : std::next(it);
+    }
+
+    for (auto & bucket : buckets)
+    {
+        m_layers[bucket.first].decorations.swap(bucket.second);
+    }
+
+    m_revision = entityManager.getRevision("Decoration");
+    m_isBuilt = true;
+}
+
+/**
+ * Renders the decorations that overlap the strip into the strip.
+ */
+void DecorationCache::renderStrip(sf::RenderTexture & strip, int index, const EntityVec & decorations)
+{
+    const float stripLeft = index * m_stripSize.x;
+
+    strip.clear(sf::Color::Transparent);
+
+    for (auto & e : decorations)
+    {
+        const CTransform & cTransform = e->getComponent<CTransform>();
+        sf::Sprite & sprite = e->getComponent<CAnimation>().animation.getSprite();
+        sprite.setPosition(sf::Vector2f(cTransform.pos.x - stripLeft, cTransform.pos.y));
+        sprite.setScale(sf::Vector2f(cTransform.scale.x, cTransform.scale.y));
+        sprite.setRotation(cTransform.angle);
+        strip.draw(sprite);
+    }
+
+    strip.display();
+}
+
+/**
+ * Draws the visible strips of every layer.
+ */
+void DecorationCache::render(sf::RenderTarget & target, EntityManager & entityManager, const Vec2 & cameraPosition, const Vec2 & cameraSize)
+{
+    if (!m_isBuilt || m_revision != entityManager.getRevision("Decoration") || !(cameraSize == m_stripSize))
+    {
+        build(entityManager, cameraSize);
+    }
+
+    for (auto & p : m_layers)
+    {
+        const float parallax = p.first;
+        Layer & layer = p.second;
+
+        const float left = cameraPosition.x * parallax;
+        const int firstStrip = (int) std::floor(left / m_stripSize.x);
+        const int lastStrip = (int) std::floor((left + cameraSize.x) / m_stripSize.x);
+
+        // Recycle strips the camera has left behind
+        while (!layer.strips.empty() && layer.strips.begin()->first < firstStrip)
+        {
+            m_freeStrips.push_back(std::move(layer.strips.begin()->second));
+            layer.strips.erase(layer.strips.begin());
+        }
+
+        for (int i = firstStrip; i <= lastStrip; i++)
+        {
+            auto decorations = layer.decorations.find(i);
+            if (decorations == layer.decorations.end())
+            {
+                continue; // nothing to draw
+            }
+
+            StripPtr & strip = layer.strips[i];
+            if (!strip)
+            {
+                if (!m_freeStrips.empty())
+                {
+                    strip = std::move(m_freeStrips.back());
+                    m_freeStrips.pop_back();
+                }
+                else
+                {
+                    strip = StripPtr(new sf::RenderTexture());
+                    if (!strip->create(m_stripSize.x, m_stripSize.y))
+                    {
+                        std::cout << "Error: could not create decoration strip texture.\n";
+                        layer.strips.erase(i);
+                        continue;
+                    }
+                }
+
+                renderStrip(*strip, i, decorations->second);
+            }
+
+            sf::Sprite sprite(strip->getTexture());
+            sprite.setPosition(sf::Vector2f(i * m_stripSize.x - left, 0));
+            target.draw(sprite);
+        }
+    }
+}
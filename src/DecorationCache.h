@@ -0,0 +1,53 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "Vec2.h"
+#include <SFML/Graphics.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Draws decorations from cached, pre-rendered strips instead of one sprite per decoration.
+ * 
+ * The level is split into strips the size of the camera. A strip is rendered once, the first
+ * time it becomes visible, and after that only the (at most two) visible strips of each layer
+ * are drawn. Strips left behind by the camera are recycled, since the camera never scrolls back.
+ * 
+ * Decorations are grouped into layers by parallax factor (default 1). A layer with factor f
+ * scrolls f times as fast as the camera, and layers are drawn from lowest to highest factor.
+ * 
+ * Decorations are assumed to be static (never move, and single frame animations). They are
+ * bucketed by layer and strip when the tag's list changes, so rendering a strip only draws the
+ * decorations that overlap it. When decorations are added or removed (e.g. level streaming),
+ * only the strips whose decorations changed are rendered again.
+ */
+class DecorationCache
+{
+private:
+    typedef std::unique_ptr<sf::RenderTexture> StripPtr;
+
+    struct Layer
+    {
+        std::map<int, EntityVec> decorations; // strip index -> decorations overlapping the strip
+        std::map<int, StripPtr>  strips;      // strip index -> rendered strip
+    };
+
+    std::map<std::string, float> m_parallax; // animation name -> parallax factor
+    std::map<float, Layer>       m_layers;   // parallax factor -> layer
+    std::vector<StripPtr>        m_freeStrips;
+    Vec2   m_stripSize = { 0.f, 0.f };
+    size_t m_revision = 0;
+    bool   m_isBuilt = false;
+
+    float getParallax(const std::string & animationName) const;
+    void build(EntityManager & entityManager, const Vec2 & stripSize);
+    void renderStrip(sf::RenderTexture & strip, int index, const EntityVec & decorations);
+public:
+    DecorationCache();
+
+    void setParallax(const std::string & animationName, float factor);
+    void reset();
+    void render(sf::RenderTarget & target, EntityManager & entityManager, const Vec2 & cameraPosition, const Vec2 & cameraSize);
+};
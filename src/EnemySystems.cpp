@@ -0,0 +1,182 @@
+#include "EnemySystems.h"
+#include "Physics.h"
+#include "PhysicsConstants.h"
+
+// Number of enemies handed to a worker at a time
+static const size_t ENEMY_CHUNK_SIZE = 16;
+
+/**
+ * Runs the function on every enemy, in parallel chunks if there is a job system.
+ */
+template <typename F>
+static void forEachEnemy(EntityVec & enemies, JobSystem * jobs, F function)
+{
+    if (jobs == nullptr)
+    {
+        for (auto & enemy : enemies)
+        {
+            function(*enemy);
+        }
+        return;
+    }
+
+    jobs->parallelFor(enemies.size(), ENEMY_CHUNK_SIZE, [&enemies, &function](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            function(*enemies[i]);
+        }
+    });
+}
+
+/**
+ * Enemy state: activation, and koopas waking up from their shell.
+ */
+void EnemySystems::updateState(Entity & enemy, float playerX, const Animation & koopaWalk)
+{
+    if (enemy.hasComponent<CLifeSpan>())
+    {
+        enemy.getComponent<CLifeSpan>().lifespan -= 1;
+    }
+
+    // Goombas are activated when player comes within a certain range
+    if (enemy.getComponent<CEnemy>().activation_x <= playerX)
+    {
+        enemy.getComponent<CEnemy>().isActive = true;
+    }
+
+    if (enemy.getComponent<CEnemy>().type == EnemyType::KOOPA)
+    {
+        if (enemy.hasComponent<CLifeSpan>() && enemy.getComponent<CLifeSpan>().lifespan == 0) // Koopa woke up (out of shell)
+        {
+            const Vec2 KOOPA_BB = Vec2(64,92);
+            const Vec2 EMPTY_SHELL_BB = Vec2(64,64);
+            enemy.removeComponent<CLifeSpan>();
+            enemy.getComponent<CAnimation>().animation = koopaWalk;
+            enemy.getComponent<CTransform>().velocity.x = enemy.getComponent<CTransform>().scale.x < 0 ? ENEMY_KINEMATICS::KOOPA_SPEED : -ENEMY_KINEMATICS::KOOPA_SPEED;
+            enemy.addComponent<CBoundingBox>(KOOPA_BB);
+            enemy.getComponent<CTransform>().pos.y -= KOOPA_BB.y - EMPTY_SHELL_BB.y;
+        }
+    }
+}
+
+/**
+ * Enemy movement.
+ */
+void EnemySystems::move(Entity & enemy)
+{
+    // Inactive Goombas can't move
+    if (!enemy.getComponent<CEnemy>().isActive)
+    {
+        return;
+    }
+
+    CTransform& enemyCT = enemy.getComponent<CTransform>();
+    enemyCT.velocity.y += enemyCT.acc_y;
+    enemyCT.prevPos = enemyCT.pos;
+    enemyCT.pos += enemyCT.velocity;
+}
+
+/**
+ * Resolves a collision between an enemy and a static block, if they overlap.
+ */
+static void resolveTileCollision(CTransform & enemyCT, const CBoundingBox & enemyBB, const Vec2 & blockPos, const Vec2 & blockPrevPos, const Vec2 & blockHalfSize)
+{
+    Vec2 overlap = Physics::GetOverLap(enemyCT.pos, blockPos, enemyBB.halfSize, blockHalfSize);
+    Vec2 prevOverlap = Physics::GetOverLap(enemyCT.prevPos, blockPrevPos, enemyBB.halfSize, blockHalfSize);
+    if (Physics::IsCollision(overlap))
+    {
+        CollisionDirection locationBlockWasHit = Physics::GetCollisionDirection(prevOverlap, enemyCT.prevPos, blockPos);
+
+        if (locationBlockWasHit == CollisionDirection::TOP)
+        {
+            // Push enemy up
+            enemyCT.pos.y -= overlap.y;
+            enemyCT.velocity.y = 0;
+        }
+        else if (locationBlockWasHit == CollisionDirection::RIGHT)
+        {
+            // push enemy right
+            enemyCT.pos.x += overlap.x;
+            enemyCT.velocity.x *= -1;
+        }
+        else if (locationBlockWasHit == CollisionDirection::LEFT)
+        {
+            // push enemy left
+            enemyCT.pos.x -= overlap.x;
+            enemyCT.velocity.x *= -1;
+        }
+    }
+}
+
+/**
+ * Enemy-Tile collisions (detection & resolution).
+ */
+void EnemySystems::collideWithTiles(Entity & enemy, const EntityVec & tiles)
+{
+    if (!enemy.getComponent<CEnemy>().isActive)
+    {
+        return;
+    }
+
+    CTransform& enemyCT = enemy.getComponent<CTransform>();
+    const CBoundingBox& enemyBB = enemy.getComponent<CBoundingBox>();
+    for (auto & block : tiles)
+    {
+        // Same as Physics::GetOverlap() and Physics::GetPreviousOverlap(), without copying shared pointers
+        const CTransform& blockCT = block->getComponent<CTransform>();
+        resolveTileCollision(enemyCT, enemyBB, blockCT.pos, blockCT.prevPos, block->getComponent<CBoundingBox>().halfSize);
+    }
+}
+
+/**
+ * Enemy-Tile collisions (detection & resolution), against the solid cells of a tile map
+ * that the enemy overlaps.
+ */
+void EnemySystems::collideWithTileMap(Entity & enemy, const TileMap & tileMap)
+{
+    if (!enemy.getComponent<CEnemy>().isActive)
+    {
+        return;
+    }
+
+    CTransform& enemyCT = enemy.getComponent<CTransform>();
+    const CBoundingBox& enemyBB = enemy.getComponent<CBoundingBox>();
+
+    int firstX, lastX, firstY, lastY;
+    tileMap.getCellRange(enemyCT.pos, enemyBB.halfSize, firstX, lastX, firstY, lastY);
+
+    for (int gx = firstX; gx <= lastX; gx++)
+    {
+        for (int gy = firstY; gy <= lastY; gy++)
+        {
+            if (!(tileMap.getType(tileMap.getTile(gx, gy)).flags & TILE_SOLID))
+            {
+                continue;
+            }
+
+            const Vec2 cellPos = tileMap.cellCenter(gx, gy);
+            resolveTileCollision(enemyCT, enemyBB, cellPos, cellPos, tileMap.cellHalfSize());
+        }
+    }
+}
+
+void EnemySystems::updateStateAll(EntityVec & enemies, float playerX, const Animation & koopaWalk, JobSystem * jobs)
+{
+    forEachEnemy(enemies, jobs, [playerX, &koopaWalk](Entity & enemy) { updateState(enemy, playerX, koopaWalk); });
+}
+
+void EnemySystems::moveAll(EntityVec & enemies, JobSystem * jobs)
+{
+    forEachEnemy(enemies, jobs, [](Entity & enemy) { move(enemy); });
+}
+
+void EnemySystems::collideWithTilesAll(EntityVec & enemies, const EntityVec & tiles, JobSystem * jobs)
+{
+    forEachEnemy(enemies, jobs, [&tiles](Entity & enemy) { collideWithTiles(enemy, tiles); });
+}
+
+void EnemySystems::collideWithTileMapAll(EntityVec & enemies, const TileMap & tileMap, JobSystem * jobs)
+{
+    forEachEnemy(enemies, jobs, [&tileMap](Entity & enemy) { collideWithTileMap(enemy, tileMap); });
+}
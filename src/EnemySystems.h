@@ -0,0 +1,31 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "JobSystem.h"
+#include "Animation.h"
+#include "TileMap.h"
+
+/**
+ * The per-enemy parts of the enemy systems.
+ * 
+ * Each of these only reads and writes the enemy it is given (tiles and the player are
+ * only read), so enemies can be updated in any order, or in parallel, with the exact
+ * same results. Interactions between enemies, and between enemies and the player,
+ * are not handled here.
+ * 
+ * The *All() functions run a phase over a list of enemies, in parallel chunks if given
+ * a job system, or serially if not.
+ */
+class EnemySystems
+{
+public:
+    static void updateState(Entity & enemy, float playerX, const Animation & koopaWalk);
+    static void move(Entity & enemy);
+    static void collideWithTiles(Entity & enemy, const EntityVec & tiles);
+    static void collideWithTileMap(Entity & enemy, const TileMap & tileMap);
+
+    static void updateStateAll(EntityVec & enemies, float playerX, const Animation & koopaWalk, JobSystem * jobs);
+    static void moveAll(EntityVec & enemies, JobSystem * jobs);
+    static void collideWithTilesAll(EntityVec & enemies, const EntityVec & tiles, JobSystem * jobs);
+    static void collideWithTileMapAll(EntityVec & enemies, const TileMap & tileMap, JobSystem * jobs);
+};
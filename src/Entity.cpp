@@ -1,5 +1,9 @@
 #include "Entity.h"
 
+#ifdef SYSTEM_ACCESS_CHECKS
+thread_local AccessMask t_declaredAccess = ~AccessMask(0); // everything, outside of scheduled systems
+#endif
+
 Entity::Entity(const size_t & id, const std::string & tag)
     : m_id(id)
     , m_tag(tag)
@@ -4,6 +4,9 @@
 
 #include <tuple>
 #include <string>
+#include <cstdint>
+#include <type_traits>
+#include <cassert>
 
 class EntityManager;
 
@@ -15,9 +18,30 @@ typedef std::tuple<
     CAnimation, 
     CGravity,
     CState,
-    CEnemy
+    CEnemy,
+    CTile
 > ComponentTuple;
 
+// Index of type T in a std::tuple type list
+template <typename T, typename Tuple>
+struct TypeIndex;
+
+template <typename T, typename... Ts>
+struct TypeIndex<T, std::tuple<T, Ts...>> : std::integral_constant<size_t, 0> {};
+
+template <typename T, typename U, typename... Ts>
+struct TypeIndex<T, std::tuple<U, Ts...>> : std::integral_constant<size_t, 1 + TypeIndex<T, std::tuple<Ts...>>::value> {};
+
+// One bit per component (by its index in ComponentTuple), see SystemScheduler
+typedef uint32_t AccessMask;
+
+#ifdef SYSTEM_ACCESS_CHECKS
+extern thread_local AccessMask t_declaredAccess; // what the system running on this thread declared
+#define CHECK_COMPONENT_ACCESS(T) assert((t_declaredAccess & (AccessMask(1) << TypeIndex<T, ComponentTuple>::value)) && "System accessed a component it did not declare")
+#else
+#define CHECK_COMPONENT_ACCESS(T)
+#endif
+
 class Entity
 {
 private:
@@ -26,6 +50,7 @@ private:
     bool m_active = true;
     std::string m_tag = "default";
     size_t m_id = 0;
+    size_t m_tagIndex = 0; // position in the entity manager's list for the tag
     ComponentTuple m_components;
 
     Entity(const size_t & id, const std::string & tag);
@@ -54,12 +79,14 @@ public:
     template<typename T>
     T & getComponent()
     {
+        CHECK_COMPONENT_ACCESS(T);
         return std::get<T>(m_components);
     }
 
     template<typename T>
     const T & getComponent() const
     {
+        CHECK_COMPONENT_ACCESS(T);
         return std::get<T>(m_components);
     }
 
@@ -1,4 +1,5 @@
 #include "EntityManager.h"
+#include <algorithm>
 
 EntityManager::EntityManager()
 {
@@ -12,11 +13,37 @@ void EntityManager::update()
     // add entities on wait list
     for (auto e : m_toAdd)
     {
+        EntityVec & tagged = m_entityMap[e->tag()];
+        e->m_tagIndex = tagged.size();
+        tagged.push_back(e);
         m_entities.push_back(e);
-        m_entityMap[e->tag()].push_back(e);
+        m_revisions[e->tag()]++;
     }
     m_toAdd.clear();
 
+    // move entities between tag lists (swap with the last entity of the old list, and pop)
+    for (auto & m : m_toMove)
+    {
+        const std::shared_ptr<Entity> & e = m.first;
+        EntityVec & from = m_entityMap[e->tag()];
+        if (e->tag() == m.second || e->m_tagIndex >= from.size() || from[e->m_tagIndex] != e)
+        {
+            continue;
+        }
+
+        from[e->m_tagIndex] = from.back();
+        from[e->m_tagIndex]->m_tagIndex = e->m_tagIndex;
+        from.pop_back();
+        m_revisions[e->tag()]++;
+
+        EntityVec & to = m_entityMap[m.second];
+        e->m_tag = m.second;
+        e->m_tagIndex = to.size();
+        to.push_back(e);
+        m_revisions[e->tag()]++;
+    }
+    m_toMove.clear();
+
     // Remove dead entities from entity list
     EntityVec::iterator it = std::remove_if(m_entities.begin(), m_entities.end(), [](const std::shared_ptr<Entity> e){ return !e->isActive(); });
     m_entities.erase(it, m_entities.end());
@@ -25,7 +52,16 @@ void EntityManager::update()
     for (auto& p : m_entityMap)
     {
         EntityVec::iterator it = std::remove_if(p.second.begin(), p.second.end(), [](const std::shared_ptr<Entity> e){ return !e->isActive(); });
-        p.second.erase(it, p.second.end());
+        if (it != p.second.end())
+        {
+            p.second.erase(it, p.second.end());
+            m_revisions[p.first]++;
+
+            for (size_t i = 0; i < p.second.size(); i++)
+            {
+                p.second[i]->m_tagIndex = i;
+            }
+        }
     }
 }
 
@@ -38,6 +74,18 @@ std::shared_ptr<Entity> EntityManager::addEntity(const std::string& tag)
     return e;
 }
 
+/**
+ * Moves an entity to the list of another tag, keeping the entity and its components.
+ * 
+ * Like adding and removing, the move is done by the next update(), so lists can be safely
+ * iterated over in the meantime. Moving takes constant time, but does not keep the order
+ * of the old tag's list.
+ */
+void EntityManager::move(const std::shared_ptr<Entity>& entity, const std::string& newTag)
+{
+    m_toMove.emplace_back(entity, newTag);
+}
+
 EntityVec& EntityManager::getEntities()
 {
     return m_entities;
@@ -51,4 +99,82 @@ EntityVec& EntityManager::getEntities(const std::string& tag)
 size_t EntityManager::getTotalEntitiesCreated()
 {
     return m_totalEntities;
+}
+
+/**
+ * Returns the revision of the given tag's entity list.
+ * 
+ * The revision changes every time entities are added to, or removed from the list.
+ * It can be used to know when something cached from the list is out of date.
+ */
+size_t EntityManager::getRevision(const std::string& tag)
+{
+    return m_revisions[tag];
+}
+
+/**
+ * Every tag's list of entities.
+ */
+const EntityMap& EntityManager::getEntityMap() const
+{
+    return m_entityMap;
+}
+
+/**
+ * Entities added since the last update().
+ */
+const EntityVec& EntityManager::getPendingEntities() const
+{
+    return m_toAdd;
+}
+
+/**
+ * Moves requested since the last update().
+ */
+const MoveList& EntityManager::getPendingMoves() const
+{
+    return m_toMove;
+}
+
+/**
+ * Removes every entity, including pending ones, and sets the number of entities created
+ * so far (new entities get ids after it). Revisions keep increasing, so caches get rebuilt.
+ */
+void EntityManager::clear(size_t totalEntities)
+{
+    m_entities.clear();
+    m_toAdd.clear();
+    m_toMove.clear();
+    m_entityMap.clear();
+    for (auto & p : m_revisions)
+    {
+        p.second++;
+    }
+    m_totalEntities = totalEntities;
+}
+
+/**
+ * Recreates an entity with the given id. It is added to the end of its tag's list right
+ * away, or, if pending, by the next update(), like a new entity.
+ */
+std::shared_ptr<Entity> EntityManager::restoreEntity(size_t id, const std::string& tag, bool isActive, bool isPending)
+{
+    auto e = std::shared_ptr<Entity>(new Entity(id, tag));
+    e->m_active = isActive;
+
+    if (isPending)
+    {
+        m_toAdd.push_back(e);
+        return e;
+    }
+
+    // The entity list is in order of creation
+    EntityVec::iterator it = std::upper_bound(m_entities.begin(), m_entities.end(), id, [](size_t id, const std::shared_ptr<Entity> & other){ return id < other->id(); });
+    m_entities.insert(it, e);
+
+    EntityVec & tagged = m_entityMap[tag];
+    e->m_tagIndex = tagged.size();
+    tagged.push_back(e);
+    m_revisions[tag]++;
+    return e;
 }
\ No newline at end of file
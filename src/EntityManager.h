@@ -2,23 +2,39 @@
 
 #include <vector>
 #include <memory>
+#include <map>
+#include <string>
+#include <utility>
 #include "Entity.h"
 
 typedef std::vector<std::shared_ptr<Entity>> EntityVec;
 typedef std::map<std::string, EntityVec> EntityMap;
+typedef std::map<std::string, size_t> RevisionMap;
+typedef std::vector<std::pair<std::shared_ptr<Entity>, std::string>> MoveList;
 
 class EntityManager
 {
     EntityVec m_entities;
     EntityVec m_toAdd;
+    MoveList  m_toMove;
     EntityMap m_entityMap;
+    RevisionMap m_revisions;
     size_t    m_totalEntities = 0;
 
 public:
     EntityManager();
     void update();
     std::shared_ptr<Entity> addEntity(const std::string& tag);
+    void move(const std::shared_ptr<Entity>& entity, const std::string& newTag);
     EntityVec& getEntities();
     EntityVec& getEntities(const std::string& tag);
     size_t getTotalEntitiesCreated();
+    size_t getRevision(const std::string& tag);
+
+    // Save states (see RewindBuffer)
+    const EntityMap& getEntityMap() const;
+    const EntityVec& getPendingEntities() const;
+    const MoveList& getPendingMoves() const;
+    void clear(size_t totalEntities);
+    std::shared_ptr<Entity> restoreEntity(size_t id, const std::string& tag, bool isActive, bool isPending);
 };
\ No newline at end of file
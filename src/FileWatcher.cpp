@@ -0,0 +1,141 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0)
+    {
+        std::cout << "Error: could not start inotify, file changes are found by modification time.\n";
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+        close(m_inotify);
+    }
+#endif
+}
+
+long long FileWatcher::modifiedTime(const std::string & path)
+{
+    std::error_code error;
+    const auto time = std::filesystem::last_write_time(path, error);
+    return error ? 0 : (long long) time.time_since_epoch().count();
+}
+
+/**
+ * Starts watching a file. The file doesn't have to exist yet.
+ */
+void FileWatcher::watch(const std::string & path)
+{
+    for (const WatchedFile & file : m_files)
+    {
+        if (file.path == path)
+        {
+            return;
+        }
+    }
+
+    const size_t slash = path.find_last_of('/');
+    WatchedFile file;
+    file.path = path;
+    file.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+    file.name = slash == std::string::npos ? path : path.substr(slash + 1);
+    file.modified = modifiedTime(path);
+    m_files.push_back(file);
+
+#ifdef __linux__
+    if (m_inotify >= 0 && m_directories.find(file.directory) == m_directories.end())
+    {
+        const int descriptor = inotify_add_watch(m_inotify, file.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (descriptor < 0)
+        {
+            std::cout << "Error: could not watch " << file.directory << "\n";
+        }
+        m_directories[file.directory] = descriptor;
+    }
+#endif
+}
+
+/**
+ * Stops watching every file.
+ */
+void FileWatcher::clear()
+{
+#ifdef __linux__
+    for (auto & directory : m_directories)
+    {
+        if (directory.second >= 0)
+        {
+            inotify_rm_watch(m_inotify, directory.second);
+        }
+    }
+#endif
+    m_directories.clear();
+    m_files.clear();
+}
+
+/**
+ * Appends the paths of watched files that changed since the last poll to changed.
+ * Returns true if any did.
+ */
+bool FileWatcher::poll(std::vector<std::string> & changed)
+{
+    const size_t before = changed.size();
+    const auto add = [&changed, before](const std::string & path)
+    {
+        if (std::find(changed.begin() + before, changed.end(), path) == changed.end())
+        {
+            changed.push_back(path);
+        }
+    };
+
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for (char * p = buffer; p < buffer + length; p += sizeof(inotify_event) + ((inotify_event *) p)->len)
+            {
+                const inotify_event * event = (const inotify_event *) p;
+                for (const WatchedFile & file : m_files)
+                {
+                    const bool isOverflow = (event->mask & IN_Q_OVERFLOW) != 0;
+                    const bool isFile = event->len > 0 && m_directories[file.directory] == event->wd && file.name == event->name;
+                    if (isOverflow || isFile)
+                    {
+                        add(file.path);
+                    }
+                }
+            }
+        }
+        return changed.size() > before;
+    }
+#endif
+
+    for (WatchedFile & file : m_files)
+    {
+        const long long modified = modifiedTime(file.path);
+        if (modified != file.modified)
+        {
+            file.modified = modified;
+            add(file.path);
+        }
+    }
+    return changed.size() > before;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Reports which of a set of files have changed since they were last checked.
+ *
+ * On Linux, the directories of the files are watched with inotify, so checking costs one
+ * non-blocking read. Files are reported when they are closed after writing, or moved or renamed
+ * into place (how most editors save). Elsewhere, modification times are compared on every check.
+ */
+class FileWatcher
+{
+private:
+    struct WatchedFile
+    {
+        std::string path;
+        std::string directory;
+        std::string name;
+        long long   modified = 0; // without inotify
+    };
+
+    int                        m_inotify = -1;
+    std::map<std::string, int> m_directories; // directory -> inotify watch descriptor
+    std::vector<WatchedFile>   m_files;
+
+    static long long modifiedTime(const std::string & path);
+public:
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher & operator=(const FileWatcher &) = delete;
+
+    void watch(const std::string & path);
+    void clear();
+    bool poll(std::vector<std::string> & changed);
+};
@@ -0,0 +1,119 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+FramePacer::FramePacer()
+{
+}
+
+void FramePacer::setInterval(sf::Int64 microseconds)
+{
+    m_interval = microseconds;
+}
+
+/**
+ * Sets how long to busy-wait at the end of a wait, instead of sleeping. 0 only sleeps.
+ */
+void FramePacer::setSpin(sf::Int64 microseconds)
+{
+    m_spin = std::max<sf::Int64>(0, microseconds);
+}
+
+/**
+ * Microseconds since the pacer was made.
+ */
+sf::Int64 FramePacer::now() const
+{
+    return m_clock.getElapsedTime().asMicroseconds();
+}
+
+/**
+ * Sleeps until shortly before the time, and busy-waits the rest.
+ */
+void FramePacer::waitUntil(sf::Int64 time) const
+{
+    const sf::Int64 endSleep = time - m_spin;
+    const sf::Int64 current = now();
+    if (endSleep > current)
+    {
+        sf::sleep(sf::microseconds(endSleep - current));
+    }
+    while (now() < time)
+    {
+    }
+}
+
+/**
+ * Waits until lead microseconds before the next frame is due.
+ */
+void FramePacer::beginFrame(sf::Int64 lead)
+{
+    if (m_frame == 0)
+    {
+        m_nextFrame = now() + m_interval;
+    }
+
+    const sf::Int64 begin = m_nextFrame - lead;
+    if (now() > begin + m_interval / 4)
+    {
+        m_lateFrames++;
+    }
+    waitUntil(begin);
+}
+
+/**
+ * Records the end of the frame, and when it was presented, and schedules the next frame.
+ */
+void FramePacer::endFrame(bool isPresented)
+{
+    const sf::Int64 end = now();
+    m_frame++;
+    m_framesSinceReport++;
+
+    if (isPresented)
+    {
+        if (m_lastPresent >= 0)
+        {
+            const sf::Int64 interval = end - m_lastPresent;
+            const sf::Int64 expected = (sf::Int64) (m_frame - m_lastPresentFrame) * m_interval;
+            m_jitters.push_back(std::abs(interval - expected));
+            m_presentIntervals += interval;
+        }
+        m_lastPresent = end;
+        m_lastPresentFrame = m_frame;
+        m_presentedFrames++;
+    }
+
+    m_nextFrame += m_interval;
+    if (m_nextFrame < end)
+    {
+        m_nextFrame = end + m_interval; // fell behind, don't try to catch up
+    }
+
+    if (m_framesSinceReport == REPORT_FRAMES)
+    {
+        report();
+    }
+}
+
+void FramePacer::report()
+{
+    std::cout << "Frame pacing: presented " << m_presentedFrames << "/" << m_framesSinceReport << " late " << m_lateFrames;
+
+    if (!m_jitters.empty())
+    {
+        std::sort(m_jitters.begin(), m_jitters.end());
+        const auto percentile = [this](size_t p) { return m_jitters[(m_jitters.size() - 1) * p / 100] / 1000.0; };
+
+        std::cout << " interval (ms) " << m_presentIntervals / 1000.0 / m_jitters.size()
+                  << " jitter (ms) p50 " << percentile(50) << " p99 " << percentile(99) << " max " << m_jitters.back() / 1000.0;
+    }
+    std::cout << "\n";
+
+    m_jitters.clear();
+    m_presentIntervals = 0;
+    m_presentedFrames = 0;
+    m_lateFrames = 0;
+    m_framesSinceReport = 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include <vector>
+
+/**
+ * Keeps frames on a fixed schedule, and measures how well they keep to it.
+ *
+ * Frames are due at fixed intervals of a monotonic clock. beginFrame() waits until the next frame
+ * is due (or a given lead time before it): it sleeps for most of the wait, and busy-waits through
+ * the end, since sleeping can oversleep by a millisecond or more. A frame that starts late moves
+ * the schedule instead of being caught up with.
+ *
+ * endFrame() records when the frame was presented. Jitter is how far the time between two
+ * presented frames is from the number of intervals between them, so frames that skip rendering
+ * don't count as jitter. Statistics are printed every REPORT_FRAMES frames.
+ */
+class FramePacer
+{
+private:
+    sf::Clock              m_clock;
+    sf::Int64              m_interval = 1000000 / 60; // microseconds
+    sf::Int64              m_spin = 1000;             // microseconds
+    sf::Int64              m_nextFrame = 0;           // when the next frame is due
+    size_t                 m_frame = 0;
+
+    // Statistics since the last report
+    sf::Int64              m_lastPresent = -1;
+    size_t                 m_lastPresentFrame = 0;
+    std::vector<sf::Int64> m_jitters;   // microseconds
+    sf::Int64              m_presentIntervals = 0;
+    size_t                 m_presentedFrames = 0;
+    size_t                 m_lateFrames = 0;
+    size_t                 m_framesSinceReport = 0;
+
+    void report();
+public:
+    static const size_t REPORT_FRAMES = 300;
+
+    FramePacer();
+
+    void setInterval(sf::Int64 microseconds);
+    void setSpin(sf::Int64 microseconds);
+
+    sf::Int64 now() const;
+    void waitUntil(sf::Int64 time) const;
+
+    void beginFrame(sf::Int64 lead = 0);
+    void endFrame(bool isPresented);
+};
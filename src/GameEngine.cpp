@@ -1,14 +1,19 @@
 #include "GameEngine.h"
 #include "Scene_Play.h"
+#include "Scene_Menu.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <ctime>
+#include <thread>
 
 clock_t deltaTime = 0;
 unsigned int frames = 0;
 double  frameRate = 30;
 double  averageFrameTimeMilliseconds = 33.333;
 
+const std::string ASSETS_PATH = "bin/texts/assets.txt";
+
 
 double clockToMilliseconds(clock_t ticks){
     // units/(units/time) => time (seconds) * 1000 = milliseconds
@@ -28,87 +33,141 @@ void GameEngine::init(const std::string & assetSpecFilePath) // load in all asse
     m_window.setKeyRepeatEnabled(false);
     m_window.setFramerateLimit(60);
 
-    std::ifstream assetsFile ("bin/texts/assets.txt");
-        
-    if (!assetsFile.is_open())
-    {
-        std::cout << "Error: could not open assets file.\n";
-    }
-    else
-    {
-        while (!assetsFile.eof())
-        {
-            std::string type;
-            assetsFile >> type;
-
-            if (type == "Texture")
-            {
-                std::string name;
-                std::string path;
+    m_settings.loadFromFile("bin/texts/settings.txt");
+    m_jobs.reset(new JobSystem(m_settings.getInt("WorkerThreads", JobSystem::defaultWorkerCount())));
+    m_inputLatency.setReportInterval(m_settings.getInt("InputLatency", 0));
 
-                assetsFile >> name >> path;
+    m_levelPath = assetSpecFilePath;
 
-                m_assets.addTexture(name, path);
-            }
-            else if (type == "Animation")
-            {
-                std::string name;
-                std::string textureName;
-                int frameCount;
-                int speed;
-                float ox;
-                float oy;
-
-                assetsFile >> name >> textureName >> frameCount >> speed >> ox >> oy;
+    // Decode images on the job system, and show the loading scene until assets are loaded
+    const bool isAsync = m_settings.getBool("AsyncAssetLoading", false);
+    // Textures are only loaded again by the scene's render system, so the pipeline keeps them all
+    const float textureBudget = m_settings.getFloat("TextureBudget", 0);
+    if (textureBudget > 0 && !m_settings.getBool("Pipeline", false))
+    {
+        m_textureResidency.reset(new TextureResidency(m_assets, m_jobs.get(), (size_t) (textureBudget * 1024 * 1024)));
+    }
 
-                m_assets.addAnimation(name, Animation(name, m_assets.getTexture(textureName), frameCount, speed, 1, 1, ox, oy));
-            }
-            else if (type == "Font")
-            {
-                std::string name;
-                std::string path;
+    m_assetLoader.reset(new AssetLoader(m_assets, isAsync ? m_jobs.get() : nullptr, m_textureResidency.get()));
+    m_assetLoader->start(ASSETS_PATH);
 
-                assetsFile >> name >> path;
+    if (m_settings.getBool("HotReload", false))
+    {
+        m_assetReloader.reset(new AssetReloader());
+        m_assetReloader->start(ASSETS_PATH);
+    }
 
-                m_assets.addFont(name, path);
-            }
-            else
-            {
-                std::cout << "Error: " << type << "is not a supported asset type.\n";
-            }
-        }
+    if (isAsync)
+    {
+        changeScene("Scene_Menu", std::make_shared<Scene_Menu>(this), true);
+        return;
     }
 
-    changeScene("Scene_Play", std::make_shared<Scene_Play>(this, assetSpecFilePath), true);
+    m_assetLoader->update();
+    m_assetLoader.reset();
+    changeScene("Scene_Play", std::make_shared<Scene_Play>(this, m_levelPath), true);
 }
 
+/**
+ * Finishes loading assets, a piece at a time, and starts the game once they are all loaded.
+ */
 void GameEngine::update()
 {
+    if (m_assetLoader && m_assetLoader->update())
+    {
+        m_assetLoader.reset();
+        changeScene("Scene_Play", std::make_shared<Scene_Play>(this, m_levelPath), true);
+    }
+}
+
+/**
+ * Fraction of assets loaded, from 0 to 1.
+ */
+float GameEngine::loadingProgress() const
+{
+    return m_assetLoader ? m_assetLoader->progress() : 1.f;
 }
 
 void GameEngine::sUserInput() // get user input, and pass it to scene as action if scene has it registered
 {
+    m_inputLatency.beginPoll();
+
     sf::Event e;
     while (m_window.pollEvent(e))
     {
-        const ActionMap & actions = m_sceneMap[m_currentScene]->getActionMap();
-        if (e.type == sf::Event::KeyPressed)
+        if (e.type == sf::Event::Closed)
         {
-            if (actions.count(e.key.code) == 1)
-            {
-                m_sceneMap[m_currentScene]->sDoAction(Action(actions.at(e.key.code), "START"));
-            }
+            m_window.close();
         }
-        else if (e.type == sf::Event::KeyReleased)
+        else if (e.type == sf::Event::KeyPressed || e.type == sf::Event::KeyReleased)
         {
-            if (actions.count(e.key.code) == 1)
+            const ActionId action = m_sceneMap.at(m_currentScene)->getAction(e.key.code);
+            if (action != ActionId::NONE)
             {
-                m_sceneMap[m_currentScene]->sDoAction(Action(actions.at(e.key.code), "END"));
+                sendAction(Action(action, e.type == sf::Event::KeyPressed ? ActionType::START : ActionType::END));
             }
         }
     }
 }
 
+/**
+ * Patches textures and animations that changed on disk into the assets, and the current scene.
+ */
+void GameEngine::sHotReload()
+{
+    if (!m_assetReloader)
+    {
+        return;
+    }
+
+    std::vector<AnimationId> changedAnimations;
+    if (m_assetReloader->update(m_assets, m_textureResidency.get(), changedAnimations))
+    {
+        m_sceneMap.at(m_currentScene)->onAssetsChanged(changedAnimations);
+    }
+}
+
+/**
+ * Passes the action to the current scene.
+ * 
+ * When the simulation runs on its own thread, the action is queued, and the
+ * simulation thread passes it on at the start of its next frame.
+ */
+void GameEngine::sendAction(const Action & action)
+{
+    m_sentActions++;
+
+    if (m_isPipelined)
+    {
+        std::lock_guard<std::mutex> lock(m_pendingActionsMutex);
+        m_inputLatency.onEvent();
+        m_pendingActions.push_back(action);
+    }
+    else
+    {
+        m_inputLatency.onEvent();
+        m_sceneMap.at(m_currentScene)->sDoAction(action);
+    }
+}
+
+/**
+ * Passes the queued actions to the current scene. Called by the simulation thread.
+ */
+void GameEngine::applyPendingActions()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_pendingActionsMutex);
+        m_appliedActions.swap(m_pendingActions);
+        m_inputLatency.onApplied(m_sceneMap.at(m_currentScene)->currentFrame());
+    }
+
+    for (const Action & action : m_appliedActions)
+    {
+        m_sceneMap.at(m_currentScene)->sDoAction(action);
+    }
+    m_appliedActions.clear();
+}
+
 std::shared_ptr<Scene> GameEngine::currentScene()
 {
 }
@@ -133,11 +192,33 @@ void GameEngine::quit() // closes the game
 
 void GameEngine::run() // main game loop
 {
+    while (m_window.isOpen() && m_assetLoader)
+    {
+        sUserInput();
+        m_sceneMap.at(m_currentScene)->update();
+        update();
+    }
+
+    if (m_settings.getBool("Pipeline", false))
+    {
+        runPipelined();
+        return;
+    }
+
+    if (m_settings.getBool("FramePacing", false) || m_settings.getBool("LowLatency", false))
+    {
+        runPaced();
+        return;
+    }
+
     while (m_window.isOpen())
     {
         clock_t beginFrame = clock();
         sUserInput();
+        sHotReload();
+        m_inputLatency.onApplied(m_sceneMap[m_currentScene]->currentFrame());
         m_sceneMap[m_currentScene]->update();
+        m_inputLatency.onPresented(m_sceneMap[m_currentScene]->currentFrame());
         m_sceneMap[m_currentScene]->sRender();
         clock_t endFrame = clock();
 
@@ -156,6 +237,206 @@ void GameEngine::run() // main game loop
     }
 }
 
+/**
+ * Main game loop, with simulation and rendering on separate threads.
+ * 
+ * The simulation thread steps the scene at 60 frames per second, and publishes a render
+ * snapshot of every frame. The main thread handles input, and draws the latest snapshot
+ * while the simulation works on the next frame. Snapshots are handed over with a triple
+ * buffer, so neither thread waits on the other.
+ */
+void GameEngine::runPipelined()
+{
+    m_isPipelined = true;
+    std::atomic<bool> isSimulating { true };
+    std::atomic<double> simulationMilliseconds { 0 };
+
+    std::thread simulation([this, &isSimulating, &simulationMilliseconds]()
+    {
+        const sf::Time frameTime = sf::seconds(1.f / 60.f);
+        sf::Clock clock;
+        sf::Time nextFrame = clock.getElapsedTime();
+
+        while (isSimulating)
+        {
+            const sf::Time beginStep = clock.getElapsedTime();
+
+            applyPendingActions();
+            const std::shared_ptr<Scene> & scene = m_sceneMap.at(m_currentScene);
+            scene->step();
+            scene->snapshot(m_snapshots.back());
+            m_snapshots.publish();
+
+            simulationMilliseconds = (clock.getElapsedTime() - beginStep).asMicroseconds() / 1000.0;
+
+            // Keep simulation at a fixed rate
+            nextFrame += frameTime;
+            const sf::Time now = clock.getElapsedTime();
+            if (nextFrame > now)
+            {
+                sf::sleep(nextFrame - now);
+            }
+            else
+            {
+                nextFrame = now; // fell behind, don't try to catch up
+            }
+        }
+    });
+
+    sf::Clock clock;
+    size_t renderedFrames = 0;
+    double renderMilliseconds = 0;
+
+    while (m_window.isOpen())
+    {
+        const sf::Time beginFrame = clock.getElapsedTime();
+
+        sUserInput();
+        m_snapshots.update();
+        renderSnapshot(m_snapshots.front());
+
+        // Note: sleep in display() is not taken into account
+        renderMilliseconds += (clock.getElapsedTime() - beginFrame).asMicroseconds() / 1000.0;
+        renderedFrames++;
+        m_window.display();
+        m_inputLatency.onPresented(m_snapshots.front().frame);
+
+        if (renderedFrames == 60)
+        {
+            std::cout << "MSPF (render): " << renderMilliseconds / renderedFrames << " MSPF (simulation): " << simulationMilliseconds << "\n";
+            renderedFrames = 0;
+            renderMilliseconds = 0;
+        }
+    }
+
+    isSimulating = false;
+    simulation.join();
+    m_isPipelined = false;
+}
+
+/**
+ * Main game loop, with frames kept at 60 per second by the frame pacer (instead of the window's
+ * frame rate limit, that sleeps in display()). Each frame polls input, steps, and renders once.
+ * 
+ * With LowLatency, frames start as late as they can while still being presented on time: the
+ * pacer waits until the expected work time before the frame is due, so input is polled just
+ * before it is used, instead of before a sleep.
+ * 
+ * With LowPower N, frames that would look the same as the last rendered one, and had no input,
+ * are only rendered every Nth frame. The simulation still steps every frame.
+ */
+void GameEngine::runPaced()
+{
+    m_window.setFramerateLimit(0);
+    m_framePacer.setSpin(m_settings.getInt("FramePacingSpin", 1000));
+
+    const bool isLowLatency = m_settings.getBool("LowLatency", false);
+    const size_t lowPowerFrames = std::max(0, m_settings.getInt("LowPower", 0));
+    const sf::Int64 headroom = 500; // for frames that take longer than expected
+
+    sf::Int64 workTime = 0; // expected time to poll, step and render a frame
+    size_t framesSinceRender = 0;
+    size_t frameCount = 0;
+    double workMilliseconds = 0;
+
+    while (m_window.isOpen())
+    {
+        m_framePacer.beginFrame(isLowLatency ? workTime + headroom : 0);
+
+        const sf::Int64 beginFrame = m_framePacer.now();
+        const std::shared_ptr<Scene> & scene = m_sceneMap.at(m_currentScene);
+        const size_t sentActions = m_sentActions;
+        sUserInput();
+        sHotReload();
+        m_inputLatency.onApplied(scene->currentFrame());
+        scene->step();
+
+        bool isRendered = true;
+        if (lowPowerFrames > 0)
+        {
+            scene->snapshot(m_nextSnapshot);
+            isRendered = m_sentActions != sentActions
+                || framesSinceRender + 1 >= lowPowerFrames
+                || !isSameImage(m_nextSnapshot, m_renderedSnapshot);
+        }
+
+        if (isRendered)
+        {
+            scene->sRender();
+            m_inputLatency.onPresented(scene->currentFrame());
+            std::swap(m_nextSnapshot, m_renderedSnapshot);
+            framesSinceRender = 0;
+        }
+        else
+        {
+            framesSinceRender++;
+        }
+
+        // Expect the slowest recent frame: jump up right away, and decay slowly
+        const sf::Int64 frameWork = m_framePacer.now() - beginFrame;
+        workTime = frameWork > workTime ? frameWork : workTime + (frameWork - workTime) / 16;
+        m_framePacer.endFrame(isRendered);
+
+        workMilliseconds += frameWork / 1000.0;
+        frameCount++;
+        if (frameCount == 60)
+        {
+            std::cout << "MSPF (work): " << workMilliseconds / frameCount << " expected (ms): " << workTime / 1000.0 << "\n";
+            frameCount = 0;
+            workMilliseconds = 0;
+        }
+    }
+}
+
+/**
+ * Whether two snapshots draw the same image.
+ */
+bool GameEngine::isSameImage(const RenderSnapshot & a, const RenderSnapshot & b)
+{
+    if (a.sprites.size() != b.sprites.size() || !(a.clearColor == b.clearColor))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.sprites.size(); i++)
+    {
+        const SpriteInstance & sa = a.sprites[i];
+        const SpriteInstance & sb = b.sprites[i];
+        const bool isSame = sa.texture == sb.texture && sa.textureRect == sb.textureRect
+            && sa.origin.x == sb.origin.x && sa.origin.y == sb.origin.y
+            && sa.position == sb.position && sa.scale == sb.scale
+            && sa.angle == sb.angle && sa.layer == sb.layer;
+
+        if (!isSame)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Draws a render snapshot to the window (without displaying it).
+ */
+void GameEngine::renderSnapshot(const RenderSnapshot & snapshot)
+{
+    m_window.clear(snapshot.clearColor);
+    m_snapshotBatch.clear();
+
+    for (const SpriteInstance & sprite : snapshot.sprites)
+    {
+        sf::Transform transform;
+        transform.translate(sprite.position.x, sprite.position.y);
+        transform.rotate(sprite.angle);
+        transform.scale(sprite.scale.x, sprite.scale.y);
+        transform.translate(-sprite.origin.x, -sprite.origin.y);
+
+        m_snapshotBatch.draw(sprite.layer, sprite.texture, sprite.textureRect, transform);
+    }
+
+    m_snapshotBatch.render(m_window);
+}
+
 sf::RenderWindow & GameEngine::window()
 {
     return m_window;
@@ -166,6 +447,24 @@ const Assets & GameEngine::assets() const
     return m_assets;
 }
 
+const Settings & GameEngine::settings() const
+{
+    return m_settings;
+}
+
+JobSystem & GameEngine::jobs()
+{
+    return *m_jobs;
+}
+
+/**
+ * Texture residency, or null if every texture stays loaded.
+ */
+TextureResidency * GameEngine::textureResidency()
+{
+    return m_textureResidency.get();
+}
+
 bool GameEngine::isRunning()
 {
 }
\ No newline at end of file
@@ -2,10 +2,23 @@
 
 #include "Scene.h"
 #include "Assets.h"
+#include "AssetLoader.h"
+#include "AssetReloader.h"
+#include "TextureResidency.h"
+#include "Settings.h"
+#include "JobSystem.h"
+#include "SpriteBatch.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
+#include "Action.h"
+#include "InputLatency.h"
+#include "FramePacer.h"
 #include <SFML/Graphics.hpp>
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 class Scene;
 
@@ -16,15 +29,45 @@ class GameEngine
 protected:
     sf::RenderWindow m_window;
     Assets m_assets;
+    Settings m_settings;
+    std::unique_ptr<JobSystem> m_jobs;
+    std::unique_ptr<AssetLoader> m_assetLoader; // set while assets are loading
+    std::unique_ptr<AssetReloader> m_assetReloader; // set when hot reload is on
+    std::unique_ptr<TextureResidency> m_textureResidency; // set when textures have a memory budget
+    std::string m_levelPath;
     std::string m_currentScene;
     SceneMap m_sceneMap;
     size_t m_simulationSpeed = 1;
     bool m_running = true;
 
+    // Pipelined mode (simulation and rendering on separate threads)
+    bool m_isPipelined = false;
+    TripleBuffer<RenderSnapshot> m_snapshots;
+    SpriteBatch m_snapshotBatch;
+    std::mutex m_pendingActionsMutex;
+    std::vector<Action> m_pendingActions; // input for the simulation thread
+    std::vector<Action> m_appliedActions;
+
+    InputLatency m_inputLatency;
+    size_t m_sentActions = 0;
+
+    // Paced mode (frame pacer instead of the window's frame rate limit)
+    FramePacer m_framePacer;
+    RenderSnapshot m_nextSnapshot;     // low power mode: the frame just stepped
+    RenderSnapshot m_renderedSnapshot; // low power mode: the last frame rendered
+
     void init(const std::string & assetSpecFilePath); // load in all assets, create window, frame limit, set menu scene
     void update();
 
     void sUserInput(); // get user input, and pass it to scene as action if scene has it registered
+    void sHotReload();
+    void sendAction(const Action & action);
+    void applyPendingActions();
+
+    void runPipelined();
+    void runPaced();
+    static bool isSameImage(const RenderSnapshot & a, const RenderSnapshot & b);
+    void renderSnapshot(const RenderSnapshot & snapshot);
 
     std::shared_ptr<Scene> currentScene();
 public:
@@ -38,5 +81,9 @@ public:
 
     sf::RenderWindow & window();
     const Assets & assets() const;
+    const Settings & settings() const;
+    JobSystem & jobs();
+    TextureResidency * textureResidency();
+    float loadingProgress() const;
     bool isRunning();
 };
\ No newline at end of file
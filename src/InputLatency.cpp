@@ -0,0 +1,123 @@
+#include "InputLatency.h"
+#include <algorithm>
+#include <iostream>
+
+InputLatency::InputLatency()
+{
+}
+
+/**
+ * Sets how many samples are collected between reports. 0 disables measuring.
+ */
+void InputLatency::setReportInterval(size_t samples)
+{
+    m_reportInterval = samples;
+}
+
+bool InputLatency::isEnabled() const
+{
+    return m_reportInterval > 0;
+}
+
+/**
+ * Called before polling events. Events polled now arrived some time after the previous poll.
+ */
+void InputLatency::beginPoll()
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_previousPoll = m_currentPoll;
+    m_currentPoll = m_clock.getElapsedTime().asMicroseconds();
+}
+
+void InputLatency::onEvent()
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Event event;
+    event.arrival = m_clock.getElapsedTime().asMicroseconds();
+    event.previousPoll = m_previousPoll;
+    m_events.push_back(event);
+}
+
+/**
+ * Called before stepping a frame, once the events that arrived so far have been passed to the scene.
+ */
+void InputLatency::onApplied(size_t frame)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Event & event : m_events)
+    {
+        if (event.frame == NOT_APPLIED)
+        {
+            event.frame = frame;
+        }
+    }
+}
+
+/**
+ * Called once a frame is displayed. Events applied to a frame before it are turned into samples.
+ */
+void InputLatency::onPresented(size_t frame)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const sf::Int64 now = m_clock.getElapsedTime().asMicroseconds();
+
+    size_t waiting = 0;
+    for (const Event & event : m_events)
+    {
+        if (event.frame != NOT_APPLIED && event.frame < frame)
+        {
+            m_latencies.push_back((now - event.arrival) / 1000.f);
+            m_upperBounds.push_back((now - event.previousPoll) / 1000.f);
+        }
+        else
+        {
+            m_events[waiting++] = event;
+        }
+    }
+    m_events.resize(waiting);
+
+    if (m_latencies.size() >= m_reportInterval)
+    {
+        report();
+    }
+}
+
+void InputLatency::printPercentiles(const char * label, std::vector<float> & samples)
+{
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](size_t p) { return samples[(samples.size() - 1) * p / 100]; };
+
+    std::cout << label << " p50 " << percentile(50) << " p90 " << percentile(90)
+              << " p99 " << percentile(99) << " max " << samples.back();
+}
+
+void InputLatency::report()
+{
+    std::cout << "Input latency (ms, " << m_latencies.size() << " events):";
+    printPercentiles("", m_latencies);
+    printPercentiles(", since previous poll:", m_upperBounds);
+    std::cout << "\n";
+
+    m_latencies.clear();
+    m_upperBounds.clear();
+}
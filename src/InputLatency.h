@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include <mutex>
+#include <vector>
+
+/**
+ * Measures input latency: the time from a key event arriving, to the first frame showing its effect.
+ *
+ * Events are timestamped when they are polled, tagged with the frame they are applied to, and
+ * become samples once a frame at least that new is presented (display() returned). Events wait
+ * in the OS queue between polls, which can't be seen, so the time since the previous poll is
+ * also kept as an upper bound. Percentiles of both are printed every N samples.
+ *
+ * Thread safe, so events can arrive on the main thread and be applied on the simulation thread.
+ */
+class InputLatency
+{
+private:
+    static const size_t NOT_APPLIED = (size_t) -1;
+
+    struct Event
+    {
+        sf::Int64 arrival = 0;      // microseconds
+        sf::Int64 previousPoll = 0; // microseconds, the event arrived after this
+        size_t    frame = NOT_APPLIED;
+    };
+
+    std::mutex              m_mutex;
+    sf::Clock               m_clock;
+    size_t                  m_reportInterval = 0; // samples, 0 when disabled
+    sf::Int64               m_previousPoll = 0;
+    sf::Int64               m_currentPoll = 0;
+    std::vector<Event>      m_events;      // waiting to be presented
+    std::vector<float>      m_latencies;   // milliseconds
+    std::vector<float>      m_upperBounds; // milliseconds
+
+    static void printPercentiles(const char * label, std::vector<float> & samples);
+    void report();
+public:
+    InputLatency();
+
+    void setReportInterval(size_t samples);
+    bool isEnabled() const;
+
+    void beginPoll();                 // events are about to be polled
+    void onEvent();                   // an event with an action arrived
+    void onApplied(size_t frame);     // events that arrived so far are applied to the frame being stepped
+    void onPresented(size_t frame);   // the frame (and every one before it) is on screen
+};
@@ -0,0 +1,181 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem::JobSystem(size_t workerCount)
+{
+    for (size_t i = 0; i < workerCount + 1; i++)
+    {
+        m_queues.emplace_back(new JobQueue());
+    }
+
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (auto & worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * One worker per core, minus the thread that hands out the work.
+ */
+size_t JobSystem::defaultWorkerCount()
+{
+    const size_t cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+size_t JobSystem::workerCount() const
+{
+    return m_workers.size();
+}
+
+void JobSystem::push(size_t queueIndex, Job job)
+{
+    JobQueue & queue = *m_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+    m_queuedJobs++;
+}
+
+/**
+ * Runs one job, taken from the back of the thread's own queue, or else stolen
+ * from the front of another queue. Returns false if there was nothing to run.
+ */
+bool JobSystem::tryRunJob(size_t queueIndex)
+{
+    Job job;
+
+    for (size_t i = 0; i < m_queues.size() && !job; i++)
+    {
+        JobQueue & queue = *m_queues[(queueIndex + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.jobs.empty())
+        {
+            continue;
+        }
+
+        if (i == 0) // own queue
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        }
+        else // steal
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+        m_queuedJobs--;
+    }
+
+    if (!job)
+    {
+        return false;
+    }
+
+    job();
+    return true;
+}
+
+void JobSystem::workerLoop(size_t index)
+{
+    while (true)
+    {
+        if (tryRunJob(index))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait(lock, [this]() { return m_stop || m_queuedJobs > 0; });
+        if (m_stop)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * Queues a job to run on a worker, and returns without waiting for it.
+ * 
+ * Without workers, the job is run right away on the calling thread.
+ */
+void JobSystem::submit(Job job)
+{
+    if (m_workers.empty())
+    {
+        job();
+        return;
+    }
+
+    push(m_nextQueue++ % m_workers.size(), std::move(job));
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+    }
+    m_wake.notify_one();
+}
+
+/**
+ * Calls job(begin, end) for consecutive chunks of [0, count), in parallel,
+ * and returns once every chunk is done.
+ * 
+ * Chunks are dealt out round-robin to the queues, and the calling thread
+ * helps run them while it waits.
+ */
+void JobSystem::parallelFor(size_t count, size_t chunkSize, const RangeJob & job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    if (m_workers.empty() || count <= chunkSize)
+    {
+        job(0, count);
+        return;
+    }
+
+    const size_t callerQueue = m_queues.size() - 1;
+    const size_t chunks = (count + chunkSize - 1) / chunkSize;
+    std::atomic<size_t> remaining { chunks };
+
+    for (size_t i = 0; i < chunks; i++)
+    {
+        const size_t begin = i * chunkSize;
+        const size_t end = std::min(begin + chunkSize, count);
+        push(i % m_queues.size(), [&job, &remaining, begin, end]()
+        {
+            job(begin, end);
+            remaining--;
+        });
+    }
+
+    {
+        // Lock so that a worker can't miss the wake up between checking for jobs and waiting
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+    }
+    m_wake.notify_all();
+
+    while (remaining > 0)
+    {
+        if (!tryRunJob(callerQueue))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed pool of worker threads with work stealing.
+ * 
+ * Every worker (and the thread calling parallelFor()) has its own job queue. Threads run jobs
+ * from their own queue first, and steal from the other queues when theirs is empty.
+ * 
+ * With 0 workers, everything runs on the calling thread.
+ */
+class JobSystem
+{
+public:
+    typedef std::function<void()> Job;
+    typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+private:
+    struct JobQueue
+    {
+        std::mutex      mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::thread>               m_workers;
+    std::vector<std::unique_ptr<JobQueue>> m_queues;      // last queue belongs to the calling thread
+    std::mutex                             m_wakeMutex;
+    std::condition_variable                m_wake;
+    std::atomic<size_t>                    m_queuedJobs { 0 };
+    std::atomic<size_t>                    m_nextQueue { 0 };
+    bool                                   m_stop = false;
+
+    void push(size_t queueIndex, Job job);
+    bool tryRunJob(size_t queueIndex);
+    void workerLoop(size_t index);
+public:
+    JobSystem(size_t workerCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem & operator=(const JobSystem &) = delete;
+
+    void submit(Job job);
+    void parallelFor(size_t count, size_t chunkSize, const RangeJob & job);
+    size_t workerCount() const;
+
+    static size_t defaultWorkerCount();
+};
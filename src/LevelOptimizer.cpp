@@ -0,0 +1,81 @@
+#include "LevelOptimizer.h"
+#include "TileMap.h"
+#include <algorithm>
+#include <map>
+#include <utility>
+
+typedef std::pair<int, int> Cell;
+
+LevelOptimizerStats LevelOptimizer::optimize(EntitySpecVec & specs, TileFlagsFunction getTileFlags)
+{
+    LevelOptimizerStats stats;
+
+    // Plain solid tiles, by cell
+    std::map<Cell, size_t> plainTiles;
+    for (size_t i = 0; i < specs.size(); i++)
+    {
+        if (specs[i].type != "Tile")
+        {
+            continue;
+        }
+
+        stats.collidersBefore++;
+        if (getTileFlags(specs[i].animation) == TILE_SOLID)
+        {
+            plainTiles[Cell((int) specs[i].gx, (int) specs[i].gy)] = i;
+        }
+    }
+
+    auto isWall = [&plainTiles](int gx, int gy)
+    {
+        return gy < 0 || plainTiles.find(Cell(gx, gy)) != plainTiles.end();
+    };
+
+    // Unreachable tiles
+    std::vector<size_t> reachable;
+    for (auto & p : plainTiles)
+    {
+        const int gx = p.first.first;
+        const int gy = p.first.second;
+
+        if (isWall(gx - 1, gy) && isWall(gx + 1, gy) && isWall(gx, gy - 1) && isWall(gx, gy + 1))
+        {
+            specs[p.second].type = "RenderTile";
+            stats.renderOnlyTiles++;
+        }
+        else
+        {
+            reachable.push_back(p.second);
+        }
+    }
+
+    // Merge horizontal runs, row by row
+    std::sort(reachable.begin(), reachable.end(), [&specs](size_t a, size_t b)
+    {
+        return specs[a].gy != specs[b].gy ? specs[a].gy < specs[b].gy : specs[a].gx < specs[b].gx;
+    });
+
+    EntitySpecVec colliders;
+    for (size_t i = 0; i < reachable.size(); i++)
+    {
+        EntitySpec & tile = specs[reachable[i]];
+        tile.type = "RenderTile";
+
+        if (!colliders.empty() && colliders.back().gy == tile.gy && colliders.back().gx + colliders.back().width == tile.gx)
+        {
+            colliders.back().width++;
+        }
+        else
+        {
+            EntitySpec collider;
+            collider.type = "Collider";
+            collider.gx = tile.gx;
+            collider.gy = tile.gy;
+            colliders.push_back(collider);
+        }
+    }
+
+    stats.collidersAfter = stats.collidersBefore - plainTiles.size() + colliders.size();
+    specs.insert(specs.end(), colliders.begin(), colliders.end());
+    return stats;
+}
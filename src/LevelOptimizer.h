@@ -0,0 +1,32 @@
+#pragma once
+
+#include "LevelStream.h"
+#include <cstdint>
+#include <string>
+
+typedef uint8_t (*TileFlagsFunction)(const std::string & animation);
+
+struct LevelOptimizerStats
+{
+    size_t collidersBefore = 0;
+    size_t collidersAfter = 0;
+    size_t renderOnlyTiles = 0;
+};
+
+/**
+ * Load time pass over the entities of a level, that cuts down the number of tile colliders.
+ * 
+ * Only plain solid tiles (no other tile flags) are changed, special tiles are left as they are.
+ * - A plain tile surrounded by plain tiles on all 4 sides can never be hit, so it becomes
+ *   a RenderTile (drawn, but without collisions).
+ * - Every horizontal run of the remaining plain tiles becomes RenderTiles, plus a single
+ *   Collider as wide as the run.
+ * 
+ * Cells below the bottom of the level count as solid, since nothing can come from there.
+ * Cells outside of the given entities count as empty, so a level can be optimized a chunk at a time.
+ */
+class LevelOptimizer
+{
+public:
+    static LevelOptimizerStats optimize(EntitySpecVec & specs, TileFlagsFunction getTileFlags);
+};
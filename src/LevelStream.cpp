@@ -0,0 +1,288 @@
+#include "LevelStream.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool EntitySpec::operator == (const EntitySpec & rhs) const
+{
+    return type == rhs.type && animation == rhs.animation && gx == rhs.gx && gy == rhs.gy
+        && activationDistance == rhs.activationDistance && width == rhs.width;
+}
+
+LevelStream::LevelStream()
+{
+}
+
+/**
+ * Waits for chunks still being parsed, since the parse jobs write into this object.
+ */
+LevelStream::~LevelStream()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_parsed.wait(lock, [this]() { return m_pendingJobs == 0; });
+}
+
+/**
+ * Reads the next entry of a level specification file, and appends its entities to specs.
+ * Ranges are expanded into one entity per cell.
+ * 
+ * Returns false at the end of the file, or on an unsupported entry.
+ */
+bool LevelStream::readEntry(std::istream & levelSpec, EntitySpecVec & specs)
+{
+    std::string type;
+    if (!(levelSpec >> type))
+    {
+        return false;
+    }
+
+    if (type == "Tile" || type == "Decoration")
+    {
+        EntitySpec spec;
+        spec.type = type;
+        levelSpec >> spec.animation >> spec.gx >> spec.gy;
+        specs.push_back(spec);
+    }
+    else if (type == "TileRangeHorizontal" || type == "DecorationRangeHorizontal" || type == "TileRangeVertical" || type == "DecorationRangeVertical")
+    {
+        EntitySpec spec;
+        spec.type = (type == "TileRangeHorizontal" || type == "TileRangeVertical") ? "Tile" : "Decoration";
+        levelSpec >> spec.animation >> spec.gx >> spec.gy;
+
+        // Range Horizontal
+        if (type == "TileRangeHorizontal" || type == "DecorationRangeHorizontal")
+        {
+            int width;
+            levelSpec >> width;
+
+            const int gx = spec.gx;
+            for (int i = 0; i < width; i++)
+            {
+                spec.gx = gx + i;
+                specs.push_back(spec);
+            }
+        }
+        // Range Vertical
+        else
+        {
+            int height;
+            levelSpec >> height;
+
+            const int gy = spec.gy;
+            for (int i = 0; i < height; i++)
+            {
+                spec.gy = gy + i;
+                specs.push_back(spec);
+            }
+        }
+    }
+    else if (type == "Goomba" || type == "Koopa")
+    {
+        EntitySpec spec;
+        spec.type = type;
+        levelSpec >> spec.gx >> spec.gy >> spec.activationDistance;
+        specs.push_back(spec);
+    }
+    else
+    {
+        std::cout << "Error: " << type << " is not or not yet a supported entity type.\n";
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Indexes the level specification file by chunks of chunkColumns columns.
+ * 
+ * Chunks are parsed on jobs, or on the calling thread when jobs is null. Opening again (e.g.
+ * after the file changed) drops the chunks parsed from the old file.
+ */
+bool LevelStream::open(const std::string & path, int chunkColumns, JobSystem * jobs)
+{
+    std::ifstream levelSpec (path);
+
+    if (!levelSpec.is_open())
+    {
+        std::cout << "Error: level specification file could not be open.\n";
+        return false;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_parsed.wait(lock, [this]() { return m_pendingJobs == 0; });
+        m_requested.clear();
+        m_ready.clear();
+    }
+
+    m_path = path;
+    m_jobs = jobs;
+    m_chunkColumns = chunkColumns > 0 ? chunkColumns : 1;
+    m_chunkLines.clear();
+
+    std::string line;
+    std::streamoff offset = levelSpec.tellg();
+    while (std::getline(levelSpec, line))
+    {
+        std::istringstream entry (line);
+        EntitySpecVec specs;
+        while (readEntry(entry, specs)) {}
+
+        // Add the line to every chunk it has entities in (ranges can span chunks)
+        int lastChunk = -1;
+        for (auto & spec : specs)
+        {
+            const int chunk = chunkOf(spec.gx);
+            if (chunk == lastChunk)
+            {
+                continue;
+            }
+
+            if (chunk >= (int) m_chunkLines.size())
+            {
+                m_chunkLines.resize(chunk + 1);
+            }
+            if (m_chunkLines[chunk].empty() || m_chunkLines[chunk].back() != offset)
+            {
+                m_chunkLines[chunk].push_back(offset);
+            }
+            lastChunk = chunk;
+        }
+
+        offset = levelSpec.tellg();
+    }
+
+    m_isOpen = true;
+    return true;
+}
+
+bool LevelStream::isOpen() const
+{
+    return m_isOpen;
+}
+
+int LevelStream::chunkColumns() const
+{
+    return m_chunkColumns;
+}
+
+int LevelStream::chunkCount() const
+{
+    return m_chunkLines.size();
+}
+
+int LevelStream::chunkOf(float gx) const
+{
+    return chunkOf(gx, m_chunkColumns);
+}
+
+/**
+ * Chunk of a grid column, when chunks are chunkColumns wide. Columns left of the level are in chunk 0.
+ */
+int LevelStream::chunkOf(float gx, int chunkColumns)
+{
+    const int chunk = (int) std::floor(gx / chunkColumns);
+    return chunk < 0 ? 0 : chunk;
+}
+
+/**
+ * Reads the entities of a chunk from the file.
+ */
+EntitySpecVec LevelStream::parseChunk(int chunk) const
+{
+    EntitySpecVec specs;
+    std::ifstream levelSpec (m_path);
+
+    for (std::streamoff offset : m_chunkLines[chunk])
+    {
+        std::string line;
+        levelSpec.seekg(offset);
+        std::getline(levelSpec, line);
+
+        std::istringstream entry (line);
+        EntitySpecVec lineSpecs;
+        while (readEntry(entry, lineSpecs)) {}
+
+        for (auto & spec : lineSpecs)
+        {
+            if (chunkOf(spec.gx) == chunk)
+            {
+                specs.push_back(spec);
+            }
+        }
+    }
+
+    return specs;
+}
+
+/**
+ * Starts parsing a chunk, unless it is already being parsed or waiting to be taken.
+ */
+void LevelStream::request(int chunk)
+{
+    if (chunk < 0 || chunk >= chunkCount())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_requested.insert(chunk).second)
+        {
+            return;
+        }
+        m_pendingJobs++;
+    }
+
+    auto job = [this, chunk]()
+    {
+        EntitySpecVec specs = parseChunk(chunk);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready[chunk] = std::move(specs);
+        m_pendingJobs--;
+        m_parsed.notify_all();
+    };
+
+    if (m_jobs != nullptr)
+    {
+        m_jobs->submit(job);
+    }
+    else
+    {
+        job();
+    }
+}
+
+/**
+ * Hands over the entities of a requested chunk.
+ * 
+ * Returns false if the chunk was not requested, or is still being parsed and wait is false.
+ * Otherwise, the chunk must be requested again before it can be taken again.
+ */
+bool LevelStream::take(int chunk, EntitySpecVec & specs, bool wait)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_requested.find(chunk) == m_requested.end())
+    {
+        return false;
+    }
+
+    if (wait)
+    {
+        m_parsed.wait(lock, [this, chunk]() { return m_ready.find(chunk) != m_ready.end(); });
+    }
+
+    auto it = m_ready.find(chunk);
+    if (it == m_ready.end())
+    {
+        return false;
+    }
+
+    specs = std::move(it->second);
+    m_ready.erase(it);
+    m_requested.erase(chunk);
+    return true;
+}
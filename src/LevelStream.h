@@ -0,0 +1,71 @@
+#pragma once
+
+#include "JobSystem.h"
+#include <condition_variable>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * One entity of a level specification file, with ranges already expanded.
+ * Positions are in grid coordinates (see LevelSpecification.txt).
+ */
+struct EntitySpec
+{
+    std::string type;      // Tile, Decoration, Goomba, or Koopa (or RenderTile, or Collider, see LevelOptimizer)
+    std::string animation; // Tiles and decorations only
+    float gx = 0;
+    float gy = 0;
+    float activationDistance = 0; // Enemies only
+    int width = 1;                // Colliders only, in grid cells
+
+    bool operator == (const EntitySpec & rhs) const;
+};
+
+typedef std::vector<EntitySpec> EntitySpecVec;
+
+/**
+ * Reads a level specification file one chunk of columns at a time.
+ * 
+ * open() only indexes the file: which lines have entities in which chunk. Chunks are
+ * parsed on the job system after they are requested, and handed over with take().
+ * Only the index, and the chunks requested but not yet taken, are kept in memory,
+ * so the memory used does not grow with the length of the level.
+ */
+class LevelStream
+{
+private:
+    typedef std::vector<std::streamoff> LineOffsets;
+
+    std::string              m_path;
+    JobSystem *              m_jobs = nullptr;
+    int                      m_chunkColumns = 16;
+    std::vector<LineOffsets> m_chunkLines; // chunk -> lines with entities in the chunk
+    bool                     m_isOpen = false;
+
+    std::mutex                   m_mutex;
+    std::condition_variable      m_parsed;
+    std::set<int>                m_requested; // being parsed, or parsed and not yet taken
+    std::map<int, EntitySpecVec> m_ready;
+    size_t                       m_pendingJobs = 0;
+
+    EntitySpecVec parseChunk(int chunk) const;
+public:
+    LevelStream();
+    ~LevelStream();
+
+    static bool readEntry(std::istream & levelSpec, EntitySpecVec & specs);
+
+    bool open(const std::string & path, int chunkColumns, JobSystem * jobs);
+    bool isOpen() const;
+    int chunkColumns() const;
+    int chunkCount() const;
+    int chunkOf(float gx) const;
+    static int chunkOf(float gx, int chunkColumns);
+
+    void request(int chunk);
+    bool take(int chunk, EntitySpecVec & specs, bool wait);
+};
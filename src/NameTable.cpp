@@ -0,0 +1,100 @@
+#include "NameTable.h"
+
+NameTable::NameTable()
+{
+}
+
+/**
+ * FNV-1a hash of the name.
+ */
+uint32_t NameTable::hash(const std::string & name)
+{
+    uint32_t h = 2166136261u;
+    for (char c : name)
+    {
+        h = (h ^ (uint8_t) c) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ * Doubles the number of slots, and inserts every name again.
+ */
+void NameTable::grow()
+{
+    std::vector<Slot> slots(m_slots.empty() ? 16 : m_slots.size() * 2);
+    slots.swap(m_slots);
+    const size_t mask = m_slots.size() - 1;
+
+    for (Slot & slot : slots)
+    {
+        if (slot.index == NONE)
+        {
+            continue;
+        }
+
+        size_t i = slot.hash & mask;
+        while (m_slots[i].index != NONE)
+        {
+            i = (i + 1) & mask;
+        }
+        m_slots[i] = std::move(slot);
+    }
+}
+
+/**
+ * Maps name to index. Inserting a name again replaces its index.
+ */
+void NameTable::insert(const std::string & name, uint16_t index)
+{
+    // Keep at most half of the slots used, so probe sequences stay short
+    if ((m_count + 1) * 2 > m_slots.size())
+    {
+        grow();
+    }
+
+    const uint32_t h = hash(name);
+    const size_t mask = m_slots.size() - 1;
+    size_t i = h & mask;
+    while (m_slots[i].index != NONE)
+    {
+        if (m_slots[i].hash == h && m_slots[i].name == name)
+        {
+            m_slots[i].index = index;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    m_slots[i].name = name;
+    m_slots[i].hash = h;
+    m_slots[i].index = index;
+    m_count++;
+}
+
+/**
+ * Returns the index of name, or NONE if it was not inserted.
+ */
+uint16_t NameTable::find(const std::string & name) const
+{
+    if (m_slots.empty())
+    {
+        return NONE;
+    }
+
+    const uint32_t h = hash(name);
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = h & mask; m_slots[i].index != NONE; i = (i + 1) & mask)
+    {
+        if (m_slots[i].hash == h && m_slots[i].name == name)
+        {
+            return m_slots[i].index;
+        }
+    }
+    return NONE;
+}
+
+size_t NameTable::size() const
+{
+    return m_count;
+}
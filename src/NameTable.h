@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Maps names to small indices, with an open addressing hash table (linear probing).
+ *
+ * Used by Assets for the name lookups done when loading; game logic should keep the
+ * indices (handles) and not look names up every frame.
+ */
+class NameTable
+{
+private:
+    struct Slot
+    {
+        std::string name;
+        uint32_t    hash = 0;
+        uint16_t    index = 65535; // NONE if the slot is free
+    };
+
+    std::vector<Slot> m_slots; // size is a power of two
+    size_t            m_count = 0;
+
+    static uint32_t hash(const std::string & name);
+    void grow();
+public:
+    static const uint16_t NONE = 65535;
+
+    NameTable();
+
+    void insert(const std::string & name, uint16_t index);
+    uint16_t find(const std::string & name) const;
+    size_t size() const;
+};
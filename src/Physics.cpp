@@ -1,6 +1,8 @@
 #include "Physics.h"
 #include "Components.h"
+#include <algorithm>
 #include <cmath>
+#include <iostream>
 
 Vec2 Physics::GetOverLap(Vec2 aPos, Vec2 bPos, Vec2 aHalfSize, Vec2 bHalfSize)
 {
@@ -98,4 +100,158 @@ CollisionDirection Physics::GetCollisionDirection(Vec2 prevOverlap, Vec2 prevPos
             }   
         }
     }
-}
\ No newline at end of file
+}
+// Width of the part of the player that is over/under the block.
+// The overlap alone would favor wide blocks (merged colliders, see LevelOptimizer).
+static float GetHitWidth(const Vec2 & overlap, const Vec2 & playerHalfSize, const BlockHit & block)
+{
+    return std::min(overlap.x, std::min(playerHalfSize.x, block.halfSize.x) * 2);
+}
+
+/**
+ * Player-block collision detection. If the player collides with the block, it is picked as the
+ * hit of its collision direction, unless a better block was already picked for that direction.
+ * 
+ * Basic idea behind player-block collisions is that the player only needs to resolve collisions for at most one block in each collision direction.
+ * For example, if the player collides with 2 blocks and both collisions are from the left, then the player really only needs to do
+ * collisions resolution for one since fixing one should also fix the other.
+ * Mario can collide with at most 2 blocks in collisions where mario came from the left, right, top, or bottom relative to the block.
+ * However, mario can only collide with 1 block diagonally at at time.
+ */
+void Physics::PickBlockHit(const BlockHit & block, const CTransform & playerCT, const Vec2 & playerHalfSize, BlockHit * hits)
+{
+    Vec2 overlap = GetOverLap(playerCT.pos, block.pos, playerHalfSize, block.halfSize);
+    Vec2 prevOverlap = GetOverLap(playerCT.prevPos, block.prevPos, playerHalfSize, block.halfSize);
+
+    // if player collides with block
+    if (!IsCollision(overlap))
+    {
+        return;
+    }
+
+    // Collision direction is the direction which mario came from relative to block.
+    CollisionDirection collisionDir = GetCollisionDirection(prevOverlap, playerCT.prevPos, block.pos);
+    BlockHit & hit = hits[(int) collisionDir];
+
+    // Mario hit the bottom or the top of the block.
+    if (collisionDir == CollisionDirection::BOTTOM || collisionDir == CollisionDirection::TOP)
+    {
+        if (!hit.has || GetHitWidth(overlap, playerHalfSize, block) > GetHitWidth(GetOverLap(playerCT.pos, hit.pos, playerHalfSize, hit.halfSize), playerHalfSize, hit))
+        {
+            hit = block;
+        }
+    }
+    // Mario hit the left or the right side of the block.
+    else if (collisionDir == CollisionDirection::LEFT || collisionDir == CollisionDirection::RIGHT)
+    {
+        if (!hit.has || block.pos.y < hit.pos.y)
+        {
+            hit = block;
+        }
+    }
+    // Mario hit a corner of the block.
+    else if 
+    (
+        collisionDir == CollisionDirection::DIAGONAL_TOP_LEFT ||
+        collisionDir == CollisionDirection::DIAGONAL_TOP_RIGHT ||
+        collisionDir == CollisionDirection::DIAGONAL_BOTTOM_LEFT ||
+        collisionDir == CollisionDirection::DIAGONAL_BOTTOM_RIGHT
+    )
+    {
+        hit = block;
+    }
+    else
+    {
+        std::cout << "Error: unsupported collision direction: (int) " << (int) collisionDir << "\n";
+    }
+}
+
+/**
+ * Player-block collision detection against the solid cells of a tile map that the player overlaps.
+ */
+void Physics::PickTileMapHits(const TileMap & tileMap, const CTransform & playerCT, const Vec2 & playerHalfSize, BlockHit * hits)
+{
+    int firstX, lastX, firstY, lastY;
+    tileMap.getCellRange(playerCT.pos, playerHalfSize, firstX, lastX, firstY, lastY);
+
+    for (int gx = firstX; gx <= lastX; gx++)
+    {
+        for (int gy = firstY; gy <= lastY; gy++)
+        {
+            const TileType & type = tileMap.getType(tileMap.getTile(gx, gy));
+            if (type.flags & TILE_SOLID)
+            {
+                PickBlockHit(BlockHit(gx, gy, tileMap, type.flags), playerCT, playerHalfSize, hits);
+            }
+        }
+    }
+}
+
+/**
+ * Player-block collision resolution, for the blocks picked in each direction.
+ * 
+ * Blocks are resolved from below first, then from the sides, from the top, and at the corners.
+ * onHitFromBelow (if set) is called with the block hit from below, so the caller can change it.
+ * A grounded player that hits no block walked off a ledge.
+ */
+void Physics::ResolveBlockHits(const BlockHit * hits, const Vec2 & playerHalfSize, CTransform & playerCT, CInput & playerCI, CState & playerCS, const std::function<void(const BlockHit &)> & onHitFromBelow)
+{
+    static const CollisionDirection RESOLUTION_ORDER[COLLISION_DIRECTION_COUNT] =
+    {
+        CollisionDirection::BOTTOM, CollisionDirection::LEFT, CollisionDirection::RIGHT, CollisionDirection::TOP,
+        CollisionDirection::DIAGONAL_TOP_LEFT, CollisionDirection::DIAGONAL_TOP_RIGHT,
+        CollisionDirection::DIAGONAL_BOTTOM_LEFT, CollisionDirection::DIAGONAL_BOTTOM_RIGHT
+    };
+
+    bool hasHit = false;
+    for (CollisionDirection direction : RESOLUTION_ORDER)
+    {
+        const BlockHit & hit = hits[(int) direction];
+        if (!hit.has)
+        {
+            continue;
+        }
+        hasHit = true;
+
+        Vec2 overlap = GetOverLap(playerCT.pos, hit.pos, playerHalfSize, hit.halfSize);
+
+        if (direction == CollisionDirection::BOTTOM)
+        {
+            playerCT.pos.y += overlap.y;
+            playerCT.velocity.y = 0;
+
+            if (onHitFromBelow)
+            {
+                onHitFromBelow(hit);
+            }
+        }
+        else if (!IsCollision(overlap))
+        {
+            continue;
+        }
+        else if (direction == CollisionDirection::TOP)
+        {
+            playerCT.pos.y -= overlap.y;
+            playerCT.velocity.y = 0;
+            playerCI.canJump = true;
+            playerCS.isGrounded = true;
+        }
+        // TODO: Pull up mechanic for mario
+        else if (direction == CollisionDirection::LEFT || direction == CollisionDirection::DIAGONAL_TOP_LEFT || direction == CollisionDirection::DIAGONAL_BOTTOM_LEFT)
+        {
+            playerCT.pos.x -= overlap.x;
+        }
+        else // right side
+        {
+            playerCT.pos.x += overlap.x;
+        }
+    }
+
+    // Mario is colliding with NO blocks.
+    if (!hasHit && playerCS.isGrounded)
+    {
+        playerCS.isGrounded = false;
+        playerCS.initialJumpXSpeed = playerCT.velocity.x;
+        playerCI.canJump = false;
+    }
+}
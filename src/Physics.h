@@ -1,6 +1,10 @@
+#pragma once
+
 #include "Vec2.h"
 #include "Entity.h"
+#include "TileMap.h"
 
+#include <functional>
 #include <memory>
 
 enum class CollisionDirection 
@@ -15,6 +19,27 @@ enum class CollisionDirection
     RIGHT
 };
 
+const size_t COLLISION_DIRECTION_COUNT = 8;
+
+// A block the player collided with: a Tile entity, or a solid cell of a tile map
+struct BlockHit
+{
+    std::shared_ptr<Entity> entity; // nullptr for tile map cells
+    int gx = 0;
+    int gy = 0;
+    Vec2 pos;
+    Vec2 prevPos;
+    Vec2 halfSize;
+    uint8_t flags = 0;
+    bool has = false;
+
+    BlockHit() {}
+    BlockHit(const std::shared_ptr<Entity>& e, uint8_t flags)
+        : entity(e), pos(e->getComponent<CTransform>().pos), prevPos(e->getComponent<CTransform>().prevPos), halfSize(e->getComponent<CBoundingBox>().halfSize), flags(flags), has(true) {}
+    BlockHit(int gx, int gy, const TileMap& tileMap, uint8_t flags)
+        : gx(gx), gy(gy), pos(tileMap.cellCenter(gx, gy)), prevPos(pos), halfSize(tileMap.cellHalfSize()), flags(flags), has(true) {}
+};
+
 class Physics
 {
 public:
@@ -23,4 +48,9 @@ public:
     static bool IsCollision(const Vec2 & overlap);
     static CollisionDirection GetCollisionDirection(Vec2 prevOverlap, Vec2 prevPosPlayer, Vec2 prevPosBlock); // The direction from which the player came at the block.
     static Vec2 GetOverLap(Vec2 aPos, Vec2 bPos, Vec2 aHalfSize, Vec2 bHalfSize);
+
+    // Player-block collisions, shared by Scene_Play and AgentBatch. hits has one block per CollisionDirection.
+    static void PickBlockHit(const BlockHit & block, const CTransform & playerCT, const Vec2 & playerHalfSize, BlockHit * hits);
+    static void PickTileMapHits(const TileMap & tileMap, const CTransform & playerCT, const Vec2 & playerHalfSize, BlockHit * hits);
+    static void ResolveBlockHits(const BlockHit * hits, const Vec2 & playerHalfSize, CTransform & playerCT, CInput & playerCI, CState & playerCS, const std::function<void(const BlockHit &)> & onHitFromBelow);
 };
\ No newline at end of file
@@ -0,0 +1,387 @@
+#include "PlayerKinematics.h"
+#include "PhysicsConstants.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// Number of players handed to a worker at a time
+static const size_t PLAYER_CHUNK_SIZE = 64;
+
+static constexpr size_t ACCELERATION_COUNT = (size_t) Acceleration::ZERO + 1;
+
+// Sign of the speed change for each Acceleration (velocity goes right for +1)
+static constexpr std::array<int, ACCELERATION_COUNT> ACCELERATION_SIGN = { 1, -1, 1, -1, 0 };
+
+// Direction the player is speeding up in, for each Acceleration (0 if not speeding up)
+static constexpr std::array<int, ACCELERATION_COUNT> SPEED_UP_DIRECTION = { 1, -1, 0, 0, 0 };
+
+static constexpr bool isSpeedingUp(size_t acceleration)
+{
+    return acceleration == (size_t) Acceleration::ACCELERATING_RIGHT || acceleration == (size_t) Acceleration::ACCELERATING_LEFT;
+}
+
+static constexpr bool isSlowingDown(size_t acceleration)
+{
+    return acceleration == (size_t) Acceleration::DECELERATING_RIGHT || acceleration == (size_t) Acceleration::DECELERATING_LEFT;
+}
+
+/**
+ * Grounded x acceleration, by [acceleration][isRunning][isSkidding].
+ */
+static constexpr std::array<double, ACCELERATION_COUNT * 4> makeGroundedAccelerationTable()
+{
+    std::array<double, ACCELERATION_COUNT * 4> table = {};
+    for (size_t acceleration = 0; acceleration < ACCELERATION_COUNT; acceleration++)
+    {
+        for (size_t isRunning = 0; isRunning < 2; isRunning++)
+        {
+            for (size_t isSkidding = 0; isSkidding < 2; isSkidding++)
+            {
+                double magnitude = 0;
+                if (isSpeedingUp(acceleration))
+                {
+                    magnitude = isRunning ? GROUNDED_HORIZONTAL_KINEMATICS::RUN_ACC : GROUNDED_HORIZONTAL_KINEMATICS::WALK_ACC;
+                }
+                else if (isSlowingDown(acceleration))
+                {
+                    magnitude = isSkidding ? GROUNDED_HORIZONTAL_KINEMATICS::SKID_DEC : GROUNDED_HORIZONTAL_KINEMATICS::RELEASE_DEC;
+                }
+                table[acceleration * 4 + isRunning * 2 + isSkidding] = ACCELERATION_SIGN[acceleration] * magnitude;
+            }
+        }
+    }
+    return table;
+}
+
+/**
+ * Airborne x acceleration, by [acceleration][above current speed threshold][above initial speed threshold].
+ */
+static constexpr std::array<double, ACCELERATION_COUNT * 4> makeAirborneAccelerationTable()
+{
+    std::array<double, ACCELERATION_COUNT * 4> table = {};
+    for (size_t acceleration = 0; acceleration < ACCELERATION_COUNT; acceleration++)
+    {
+        for (size_t isAboveCurrent = 0; isAboveCurrent < 2; isAboveCurrent++)
+        {
+            for (size_t isAboveInitial = 0; isAboveInitial < 2; isAboveInitial++)
+            {
+                double magnitude = 0;
+                if (isSpeedingUp(acceleration))
+                {
+                    magnitude = isAboveCurrent ? AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_CST_ACC : AIRBORNE_HORIZONTAL_KINEMATICS::BELOW_CST_ACC;
+                }
+                else if (isSlowingDown(acceleration))
+                {
+                    magnitude = isAboveCurrent ? AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_CST_DEC
+                              : isAboveInitial ? AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_DEC
+                              : AIRBORNE_HORIZONTAL_KINEMATICS::BELOW_IST_DEC;
+                }
+                table[acceleration * 4 + isAboveCurrent * 2 + isAboveInitial] = ACCELERATION_SIGN[acceleration] * magnitude;
+            }
+        }
+    }
+    return table;
+}
+
+static constexpr std::array<double, ACCELERATION_COUNT * 4> GROUNDED_ACCELERATION = makeGroundedAccelerationTable();
+static constexpr std::array<double, ACCELERATION_COUNT * 4> AIRBORNE_ACCELERATION = makeAirborneAccelerationTable();
+
+// Grounded speed limit when speeding up, by [isRunning]
+static constexpr std::array<double, 2> GROUNDED_SPEED_LIMIT = { GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED, GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED };
+
+// Grounded speed below which slowing down stops the player, by [isSkidding]
+static constexpr std::array<double, 2> STOP_SPEED =
+{
+    GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED,
+    std::max(GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED, GROUNDED_HORIZONTAL_KINEMATICS::SKID_TURNAROUND_SPEED)
+};
+
+// Airborne speed limit, by [initial speed above threshold]
+static constexpr std::array<double, 2> AIRBORNE_SPEED_LIMIT = { AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL, AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL };
+
+// A jump, picked by the x speed at take off
+struct JumpKinematics
+{
+    double initialVelocity;
+    double reducedGravity; // while jump is held, and the player is going up
+    double gravity;
+};
+
+// Jumps, by small, medium, and large x speed at take off
+static constexpr std::array<JumpKinematics, 3> JUMPS =
+{{
+    { AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_S, AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_S, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_S },
+    { AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_M, AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_M, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_M },
+    { AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L, AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_L, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L }
+}};
+
+// Only small and medium jumps switch to normal gravity when jump is released (large jumps keep reduced gravity)
+static const size_t JUMPS_WITH_GRAVITY_SWITCH = 2;
+
+static_assert(AIRBORNE_VERTICAL_KINEMATICS::SMALL_SPEED_THRESHOLD <= AIRBORNE_VERTICAL_KINEMATICS::MEDIUM_SPEED_THRESHOLD, "Jump speed thresholds are out of order");
+
+/**
+ * Index in JUMPS of the jump made at the given x speed.
+ */
+static size_t getJumpIndex(double xSpeed)
+{
+    const double speed = std::abs(xSpeed);
+    return (speed >= AIRBORNE_VERTICAL_KINEMATICS::SMALL_SPEED_THRESHOLD) + (speed > AIRBORNE_VERTICAL_KINEMATICS::MEDIUM_SPEED_THRESHOLD);
+}
+
+/**
+ * Finds whether the player is speeding up or slowing down, and in which direction, from
+ * input and current velocity. Also updates skidding and facing direction.
+ */
+void PlayerKinematics::updateState(const CTransform & cTransform, const CInput & cInput, CState & cState)
+{
+    const bool isAirborne      = !cState.isGrounded;
+    const bool isPressingLeft  = cInput.left;
+    const bool isPressingRight = cInput.right;
+    const bool isStandingStill = cTransform.velocity.x == 0;
+    const bool isMovingRight   = cTransform.velocity.x > 0;
+    const bool isMovingLeft    = cTransform.velocity.x < 0;
+
+    // Decelerating: speed is decreasing (going to zero)
+    // Accelerating: speed is increasing (going away from zero)
+    bool isDeceleratingLeft  = false; 
+    bool isDeceleratingRight = false; 
+    bool isAcceleratingLeft  = false;
+    bool isAcceleratingRight = false;
+    bool isSkidding          = false;
+    Direction newFacingDirection = cState.facingDir;
+
+    if (isAirborne)
+    {
+        const bool isChangingMovementDirection    = (isMovingLeft && (isPressingRight && !isPressingLeft)) || (isMovingRight && (isPressingLeft && !isPressingRight)); // turning only, doesn't include stopping
+        const bool isAboveInitialSpeedThresholdForVel = (cState.initialJumpXSpeed <= -AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL || cState.initialJumpXSpeed >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL);
+        const double maxXSpeed                    = isAboveInitialSpeedThresholdForVel ? AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL : AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL;
+        const bool isBellowMaxSpeed               = (cTransform.velocity.x < maxXSpeed) && (cTransform.velocity.x > -maxXSpeed);
+
+        isDeceleratingLeft  = (isMovingRight && isChangingMovementDirection);
+        isDeceleratingRight = (isMovingLeft && isChangingMovementDirection);
+        isAcceleratingLeft  = (isPressingLeft && !isPressingRight) && (isMovingLeft || isStandingStill) && isBellowMaxSpeed;
+        isAcceleratingRight = isPressingRight && !isPressingLeft && (isStandingStill || isMovingRight) && isBellowMaxSpeed;
+    }
+    else // grounded
+    {
+        const bool isRunning                    = cInput.B;
+        const bool isAtMaxWalkSpeed             = cTransform.velocity.x == GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x == -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
+        const bool isAtMaxRunSpeed              = cTransform.velocity.x == GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED || cTransform.velocity.x == -GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;
+        const bool isWalkingButPastMaxWalkSpeed = (cTransform.velocity.x > GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x < -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED) && !isRunning;
+        const bool isChangingMovementDirection  = (isMovingLeft && (isPressingRight || !isPressingLeft)) || (isMovingRight && (isPressingLeft || !isPressingRight)); // stopping, or turning
+        const bool isSkiddingInPreviousFrame    = cState.isSkidding;
+        
+        isDeceleratingLeft  = (isMovingRight && (isChangingMovementDirection || isWalkingButPastMaxWalkSpeed));
+        isDeceleratingRight = (isMovingLeft && (isChangingMovementDirection || isWalkingButPastMaxWalkSpeed));
+        isAcceleratingLeft  = (isPressingLeft && !isPressingRight) && (isMovingLeft || isStandingStill) && (!isAtMaxWalkSpeed || isRunning) && !isAtMaxRunSpeed && !isWalkingButPastMaxWalkSpeed;
+        isAcceleratingRight = isPressingRight && !isPressingLeft && (isStandingStill || isMovingRight) && (!isAtMaxWalkSpeed || isRunning) && !isAtMaxRunSpeed && !isWalkingButPastMaxWalkSpeed;
+        isSkidding          = ((isMovingRight && isPressingLeft && !isPressingRight) || (isMovingLeft && isPressingRight && !isPressingLeft)) || ((isDeceleratingLeft || isDeceleratingRight) && isSkiddingInPreviousFrame);
+
+        if (isSkidding)
+        {
+            if (isDeceleratingLeft)
+            {
+                newFacingDirection = Direction::LEFT;
+            }
+            else // decelerating right
+            {
+                newFacingDirection = Direction::RIGHT;
+            }
+        }
+        else if (cTransform.velocity.x < 0)
+        {
+            newFacingDirection = Direction::LEFT;
+        }
+        else if (cTransform.velocity.x > 0)
+        {
+            newFacingDirection = Direction::RIGHT;
+        }
+    }
+
+    if (isDeceleratingLeft)
+    {
+        cState.acceleration = Acceleration::DECELERATING_LEFT;
+    }
+    else if (isDeceleratingRight)
+    {
+        cState.acceleration = Acceleration::DECELERATING_RIGHT;
+    }
+    else if (isAcceleratingLeft)
+    {
+        cState.acceleration = Acceleration::ACCELERATING_LEFT;
+    }
+    else if (isAcceleratingRight)
+    {
+        cState.acceleration = Acceleration::ACCELERATING_RIGHT;
+    }
+    else
+    {
+        cState.acceleration = Acceleration::ZERO;
+    }
+
+    cState.isSkidding = isSkidding;
+    cState.facingDir = newFacingDirection;
+}
+
+/**
+ * Grounded movement: x velocity from acceleration and speed limits, and jumping.
+ */
+void PlayerKinematics::moveGrounded(CTransform & cTransform, CInput & cInput, CState & cState)
+{
+    const size_t acceleration = (size_t) cState.acceleration;
+    const bool isRunning      = cInput.B;
+    const bool isSkidding     = cState.isSkidding;
+
+    // Step 1: Figure out X acceleration for current frame
+    cTransform.acc_x = GROUNDED_ACCELERATION[acceleration * 4 + isRunning * 2 + isSkidding];
+
+    // Step 2: Use X acceleration to calculate X velocity
+    cTransform.velocity.x += cTransform.acc_x;
+
+    // Step 3: Apply speed limits or exception for X velocity
+    const double speed = std::abs(cTransform.velocity.x);
+    const int direction = SPEED_UP_DIRECTION[acceleration];
+    if (direction != 0)
+    {
+        const double maxSpeed = GROUNDED_SPEED_LIMIT[isRunning];
+        if (speed > maxSpeed)
+        {
+            cTransform.velocity.x = direction * maxSpeed;
+        }
+        else if (speed < GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED)
+        {
+            cTransform.velocity.x = direction * GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED;
+        }
+    }
+    else if (isSlowingDown(acceleration) && speed < STOP_SPEED[isSkidding])
+    {
+        cTransform.velocity.x = 0;
+    }
+
+    // Step 4: Check if player is about to jump
+    const bool isJustStartingJump = cInput.canJump && cInput.A;
+    const JumpKinematics & jump = JUMPS[getJumpIndex(cTransform.velocity.x)];
+    if (isJustStartingJump)
+    {
+        cTransform.acc_y = jump.reducedGravity;
+    }
+
+    // Step 5: Use Y acceleration to calculate Y velocity
+    cTransform.velocity.y += cTransform.acc_y;
+
+    // Step 6: Apply speed limits or exception for Y velocity
+    if (isJustStartingJump)
+    {
+        cTransform.velocity.y = -jump.initialVelocity;
+        cInput.canJump = false;
+        cState.initialJumpXSpeed = cTransform.velocity.x;
+        cState.isGrounded = false;
+    }
+
+    // Step 7: Use velocity to calculate player position
+    cTransform.prevPos = cTransform.pos;
+    cTransform.pos += cTransform.velocity;
+}
+
+/**
+ * Airborne movement: x velocity from acceleration and speed limits, and gravity.
+ */
+void PlayerKinematics::moveAirborne(CTransform & cTransform, const CInput & cInput, const CState & cState)
+{
+    const size_t acceleration = (size_t) cState.acceleration;
+    const bool isAboveCurrentSpeedThresholdForAcc = std::abs(cTransform.velocity.x) >= AIRBORNE_HORIZONTAL_KINEMATICS::CURRENT_SPEED_THRESHOLD_FOR_ACC;
+    const bool isAboveInitialSpeedThresholdForAcc = std::abs(cState.initialJumpXSpeed) >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_ACC;
+    const bool isAboveInitialSpeedThresholdForVel = std::abs(cState.initialJumpXSpeed) >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL;
+
+    // Step 1: Figure out X acceleration for current frame
+    cTransform.acc_x = AIRBORNE_ACCELERATION[acceleration * 4 + isAboveCurrentSpeedThresholdForAcc * 2 + isAboveInitialSpeedThresholdForAcc];
+
+    // Step 2: Use X acceleration to calculate X velocity
+    cTransform.velocity.x += cTransform.acc_x;
+
+    // Step 3: Apply speed limits or exception for X velocity
+    const double maxSpeed = AIRBORNE_SPEED_LIMIT[isAboveInitialSpeedThresholdForVel];
+    if (cTransform.velocity.x > maxSpeed)
+    {
+        cTransform.velocity.x = maxSpeed;
+    }
+    else if (cTransform.velocity.x < -maxSpeed)
+    {
+        cTransform.velocity.x = -maxSpeed;
+    }
+
+    // Step 4: Figure out Y acceleration (normal gravity once jump is released, or the player is falling)
+    if (!cInput.A || cTransform.velocity.y >= 0)
+    {
+        for (size_t i = 0; i < JUMPS_WITH_GRAVITY_SWITCH; i++)
+        {
+            if (cTransform.acc_y == JUMPS[i].reducedGravity)
+            {
+                cTransform.acc_y = JUMPS[i].gravity;
+                break;
+            }
+        }
+    }
+
+    // Step 5: Use Y acceleration to calculate Y velocity
+    cTransform.velocity.y += cTransform.acc_y;
+
+    // Step 6: Apply speed limits or exception for Y velocity
+    if (cTransform.velocity.y > AIRBORNE_VERTICAL_KINEMATICS::MAX_DOWNWARD_SPEED)
+    {
+        cTransform.velocity.y = AIRBORNE_VERTICAL_KINEMATICS::RESET_DOWNWARD_SPEED;
+    }
+
+    // Step 7: Use velocity to calculate player position
+    cTransform.prevPos = cTransform.pos;
+    cTransform.pos += cTransform.velocity;
+}
+
+void PlayerKinematics::move(CTransform & cTransform, CInput & cInput, CState & cState)
+{
+    if (cState.isGrounded)
+    {
+        moveGrounded(cTransform, cInput, cState);
+    }
+    else
+    {
+        moveAirborne(cTransform, cInput, cState);
+    }
+}
+
+/**
+ * One frame of player state and movement, without collisions.
+ */
+void PlayerKinematics::step(Entity & player)
+{
+    CTransform & cTransform = player.getComponent<CTransform>();
+    CInput & cInput = player.getComponent<CInput>();
+    CState & cState = player.getComponent<CState>();
+
+    updateState(cTransform, cInput, cState);
+    move(cTransform, cInput, cState);
+}
+
+/**
+ * Steps every player, in parallel chunks if there is a job system.
+ */
+void PlayerKinematics::stepAll(EntityVec & players, JobSystem * jobs)
+{
+    if (jobs == nullptr)
+    {
+        for (auto & player : players)
+        {
+            step(*player);
+        }
+        return;
+    }
+
+    jobs->parallelFor(players.size(), PLAYER_CHUNK_SIZE, [&players](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            step(*players[i]);
+        }
+    });
+}
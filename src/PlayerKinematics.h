@@ -0,0 +1,27 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "JobSystem.h"
+
+/**
+ * Player movement: state (acceleration, skidding, facing direction), velocity, and position.
+ * 
+ * The speeds, accelerations and thresholds of PhysicsConstants.h are turned into lookup
+ * tables at compile time, indexed by the player's acceleration state and a few threshold
+ * tests, so a step is mostly table reads instead of branch chains. A step only reads and
+ * writes the player it is given, so many players (replays, ghosts, AI agents) can be
+ * stepped in parallel. Collisions are not handled here.
+ * 
+ * The results are identical to the original branching code (see tests/kinematics_tests.cpp).
+ */
+class PlayerKinematics
+{
+public:
+    static void updateState(const CTransform & cTransform, const CInput & cInput, CState & cState);
+    static void moveGrounded(CTransform & cTransform, CInput & cInput, CState & cState);
+    static void moveAirborne(CTransform & cTransform, const CInput & cInput, const CState & cState);
+    static void move(CTransform & cTransform, CInput & cInput, CState & cState);
+    static void step(Entity & player);
+
+    static void stepAll(EntityVec & players, JobSystem * jobs);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Vec2.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+/**
+ * Everything needed to draw one sprite, copied out of the entity that owns it.
+ */
+struct SpriteInstance
+{
+    const sf::Texture * texture = nullptr;
+    sf::IntRect  textureRect;
+    sf::Vector2f origin;
+    Vec2         position;       // relative to the camera
+    Vec2         scale = { 1.f, 1.f };
+    float        angle = 0;
+    int          frameIndex = 0; // animation frame, textureRect already points at it
+    size_t       layer = 0;
+};
+
+/**
+ * Immutable (once published) description of a frame, made by the simulation for the renderer.
+ * 
+ * Only contains plain values, so it can be drawn on another thread while the simulation
+ * works on the next frame.
+ */
+struct RenderSnapshot
+{
+    std::vector<SpriteInstance> sprites; // visible sprites, in drawing order
+    sf::Color clearColor = sf::Color::Black;
+    size_t frame = 0;
+};
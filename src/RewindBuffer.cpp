@@ -0,0 +1,965 @@
+#include "RewindBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+// Tags of entities that never move, and only get destroyed or change animation
+static bool isStaticTag(const std::string & tag)
+{
+    return tag == "Tile" || tag == "RenderTile" || tag == "Decoration";
+}
+
+template <typename T>
+static void write(ByteVec & out, const T & value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be written as bytes");
+    const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Writes a record, prefixed with its length
+static void writeRecord(ByteVec & out, const ByteVec & record)
+{
+    write<uint16_t>(out, (uint16_t) record.size());
+    out.insert(out.end(), record.begin(), record.end());
+}
+
+ByteReader::ByteReader()
+{
+}
+
+ByteReader::ByteReader(const uint8_t * begin, const uint8_t * end)
+    : m_in(begin)
+    , m_end(end)
+{
+}
+
+bool ByteReader::has(size_t size)
+{
+    if (m_isValid && (size_t) (m_end - m_in) >= size)
+    {
+        return true;
+    }
+    m_isValid = false;
+    return false;
+}
+
+/**
+ * Moves past the next size bytes, and returns where they start (nullptr if there aren't enough).
+ */
+const uint8_t * ByteReader::skip(size_t size)
+{
+    if (!has(size))
+    {
+        return nullptr;
+    }
+    const uint8_t * bytes = m_in;
+    m_in += size;
+    return bytes;
+}
+
+/**
+ * Reads a record written by writeRecord(), as a reader of its own bytes.
+ */
+ByteReader ByteReader::readRecord()
+{
+    const uint16_t size = read<uint16_t>();
+    const uint8_t * record = skip(size);
+    ByteReader reader (record, record + size);
+    reader.m_isValid = record != nullptr;
+    return reader;
+}
+
+/**
+ * Reads the number of items that follow. A count that can't fit in the bytes left (items being
+ * at least itemSize bytes) makes the reader invalid, so a bad count doesn't allocate.
+ */
+size_t ByteReader::readCount(size_t itemSize)
+{
+    const size_t count = read<uint32_t>();
+    if (!m_isValid || count > (size_t) (m_end - m_in) / itemSize)
+    {
+        m_isValid = false;
+        return 0;
+    }
+    return count;
+}
+
+void ByteReader::fail()
+{
+    m_isValid = false;
+}
+
+bool ByteReader::isValid() const
+{
+    return m_isValid;
+}
+
+/**
+ * Calls f with a null pointer of each component type, in ComponentTuple order.
+ */
+template <typename F, size_t... I>
+static void forEachComponentType(F && f, std::index_sequence<I...>)
+{
+    (f((typename std::tuple_element<I, ComponentTuple>::type *) nullptr, I), ...);
+}
+
+template <typename F>
+static void forEachComponentType(F && f)
+{
+    forEachComponentType(f, std::make_index_sequence<std::tuple_size<ComponentTuple>::value>());
+}
+
+RewindBuffer::RewindBuffer()
+{
+}
+
+/**
+ * Sets how many frames are kept. Recorded frames are dropped.
+ */
+void RewindBuffer::setCapacity(size_t frames)
+{
+    m_snapshots.clear();
+    m_snapshots.resize(frames);
+    m_first = 0;
+    m_count = 0;
+    resetRecording();
+}
+
+/**
+ * Call when the level is (re)loaded. Static entities are saved again, once they are all added.
+ */
+void RewindBuffer::invalidateBase()
+{
+    m_isBaseValid = false;
+}
+
+/**
+ * Drops every recorded frame, e.g. after the level was changed in a way that can't be rewound.
+ */
+void RewindBuffer::clear()
+{
+    m_first = 0;
+    m_count = 0;
+    resetRecording();
+    invalidateBase();
+}
+
+uint16_t RewindBuffer::getNameId(const std::string & name)
+{
+    auto it = m_nameIds.find(name);
+    if (it != m_nameIds.end())
+    {
+        return it->second;
+    }
+
+    m_names.push_back(name);
+    m_nameIds[name] = (uint16_t) (m_names.size() - 1);
+    return (uint16_t) (m_names.size() - 1);
+}
+
+/**
+ * Record of an entity: tag, active flag, which components it has, and the components.
+ */
+void RewindBuffer::writeEntity(ByteVec & out, const Entity & e)
+{
+    uint16_t mask = 0;
+    forEachComponentType([&](auto * type, size_t index)
+    {
+        typedef typename std::remove_pointer<decltype(type)>::type T;
+        if (e.hasComponent<T>())
+        {
+            mask |= 1 << index;
+        }
+    });
+
+    write<uint16_t>(out, getNameId(e.tag()));
+    write<uint8_t>(out, e.isActive());
+    write<uint16_t>(out, mask);
+
+    forEachComponentType([&](auto * type, size_t index)
+    {
+        typedef typename std::remove_pointer<decltype(type)>::type T;
+        if (!(mask & (1 << index)))
+        {
+            return;
+        }
+
+        if constexpr (std::is_same<T, CAnimation>::value)
+        {
+            const CAnimation & cAnimation = e.getComponent<CAnimation>();
+            write<uint16_t>(out, getNameId(cAnimation.animation.getName()));
+            write<uint8_t>(out, cAnimation.repeat);
+            write<int32_t>(out, cAnimation.animation.getCurrentFrame());
+        }
+        else
+        {
+            write<T>(out, e.getComponent<T>());
+        }
+    });
+}
+
+/**
+ * Checks that a record can be read: it has all its bytes, and its tag and animation exist.
+ */
+bool RewindBuffer::checkEntity(ByteReader in, const std::vector<std::string> & names, const Assets & assets)
+{
+    const uint16_t tag = in.read<uint16_t>();
+    in.read<uint8_t>();
+    const uint16_t mask = in.read<uint16_t>();
+    bool isValid = tag < names.size() && (mask >> std::tuple_size<ComponentTuple>::value) == 0;
+
+    forEachComponentType([&](auto * type, size_t index)
+    {
+        typedef typename std::remove_pointer<decltype(type)>::type T;
+        if (!(mask & (1 << index)))
+        {
+            return;
+        }
+
+        if constexpr (std::is_same<T, CAnimation>::value)
+        {
+            const uint16_t name = in.read<uint16_t>();
+            in.read<uint8_t>();
+            in.read<int32_t>();
+            isValid = isValid && name < names.size() && (names[name].empty() || assets.hasAnimation(names[name]));
+        }
+        else
+        {
+            in.read<T>();
+        }
+    });
+
+    return isValid && in.isValid();
+}
+
+/**
+ * Restores an entity from a record that passed checkEntity().
+ */
+std::shared_ptr<Entity> RewindBuffer::readEntity(ByteReader in, size_t id, bool isPending, const std::vector<std::string> & names, EntityManager & entityManager, const Assets & assets)
+{
+    const std::string & tag = names[in.read<uint16_t>()];
+    const bool isActive = in.read<uint8_t>();
+    const uint16_t mask = in.read<uint16_t>();
+
+    std::shared_ptr<Entity> e = entityManager.restoreEntity(id, tag, isActive, isPending);
+
+    forEachComponentType([&](auto * type, size_t index)
+    {
+        typedef typename std::remove_pointer<decltype(type)>::type T;
+        if (!(mask & (1 << index)))
+        {
+            return;
+        }
+
+        if constexpr (std::is_same<T, CAnimation>::value)
+        {
+            const std::string & name = names[in.read<uint16_t>()];
+            const bool repeat = in.read<uint8_t>();
+            const int32_t frame = in.read<int32_t>();
+
+            CAnimation & cAnimation = name.empty() ? e->addComponent<CAnimation>() : e->addComponent<CAnimation>(assets.getAnimation(name), repeat);
+            cAnimation.repeat = repeat;
+            cAnimation.animation.setCurrentFrame(frame);
+        }
+        else
+        {
+            e->getComponent<T>() = in.read<T>();
+        }
+    });
+
+    return e;
+}
+
+/**
+ * Saves the static entities and tile map cells.
+ */
+std::shared_ptr<RewindBuffer::Base> RewindBuffer::makeBase(const World & world)
+{
+    std::shared_ptr<Base> base = std::make_shared<Base>();
+    base->frame = world.currentFrame;
+
+    for (auto & p : world.entityManager.getEntityMap())
+    {
+        if (!isStaticTag(p.first))
+        {
+            continue;
+        }
+
+        for (auto & e : p.second)
+        {
+            const Animation & animation = e->getComponent<CAnimation>().animation;
+            base->indexes[e->id()] = base->ids.size();
+            base->ids.push_back(e->id());
+            base->animations.push_back(getNameId(animation.getName()));
+            base->animationFrames.push_back(animation.getCurrentFrame());
+            base->records.emplace_back();
+            writeEntity(base->records.back(), *e);
+        }
+    }
+
+    base->columns = world.tileMap.columns();
+    base->rows = world.tileMap.rows();
+    for (int gx = 0; gx < base->columns; gx++)
+    {
+        for (int gy = 0; gy < base->rows; gy++)
+        {
+            base->cells.push_back(world.tileMap.getTile(gx, gy));
+        }
+    }
+
+    return base;
+}
+
+/**
+ * Writes a frame. With a base, only static entities and cells that differ from it are written.
+ * While recording, a keyframe has every entity, and other frames leave out the entities that
+ * are the same as in the previous recorded frame.
+ */
+void RewindBuffer::encode(const World & world, const Base * base, bool isKeyframe, bool isRecording, ByteVec & out)
+{
+    EntityManager & entityManager = world.entityManager;
+
+    out.clear();
+    write<uint64_t>(out, world.currentFrame);
+    write<Vec2>(out, world.cameraPosition);
+    write<uint64_t>(out, entityManager.getTotalEntitiesCreated());
+    write<uint64_t>(out, world.player ? world.player->id() : 0);
+    write<uint8_t>(out, isKeyframe);
+    write<uint8_t>(out, base != nullptr);
+
+    // Tag lists, in order
+    const size_t listCountPosition = out.size();
+    uint16_t listCount = 0;
+    write<uint16_t>(out, listCount);
+
+    for (auto & p : entityManager.getEntityMap())
+    {
+        if (p.second.empty() || (base != nullptr && isStaticTag(p.first)))
+        {
+            continue;
+        }
+
+        listCount++;
+        write<uint16_t>(out, getNameId(p.first));
+        write<uint32_t>(out, (uint32_t) p.second.size());
+
+        for (auto & e : p.second)
+        {
+            write<uint32_t>(out, (uint32_t) e->id());
+            m_record.clear();
+            writeEntity(m_record, *e);
+
+            if (!isRecording)
+            {
+                write<uint8_t>(out, 1);
+                writeRecord(out, m_record);
+                continue;
+            }
+
+            Record & record = m_records[e->id()];
+            const bool isSame = !isKeyframe && record.stamp + 1 == m_stamp && record.bytes == m_record;
+            record.stamp = m_stamp;
+            write<uint8_t>(out, !isSame);
+            if (!isSame)
+            {
+                record.bytes.swap(m_record);
+                writeRecord(out, record.bytes);
+            }
+        }
+    }
+    std::memcpy(out.data() + listCountPosition, &listCount, sizeof(listCount));
+
+    // Static entities that were destroyed, changed, or added since the base
+    if (base != nullptr)
+    {
+        const size_t elapsed = world.currentFrame - base->frame;
+        m_seen.assign(base->ids.size(), false);
+        std::vector<const Entity *> changed;
+
+        for (auto & p : entityManager.getEntityMap())
+        {
+            if (!isStaticTag(p.first))
+            {
+                continue;
+            }
+
+            for (auto & e : p.second)
+            {
+                auto it = base->indexes.find(e->id());
+                if (it == base->indexes.end())
+                {
+                    changed.push_back(e.get());
+                    continue;
+                }
+
+                const size_t index = it->second;
+                const Animation & animation = e->getComponent<CAnimation>().animation;
+                m_seen[index] = true;
+                if (!e->isActive()
+                    || animation.getCurrentFrame() != base->animationFrames[index] + (int) elapsed
+                    || animation.getName() != m_names[base->animations[index]])
+                {
+                    changed.push_back(e.get());
+                }
+            }
+        }
+
+        const size_t removedCountPosition = out.size();
+        uint32_t removedCount = 0;
+        write<uint32_t>(out, removedCount);
+        for (size_t i = 0; i < m_seen.size(); i++)
+        {
+            if (!m_seen[i])
+            {
+                write<uint32_t>(out, (uint32_t) base->ids[i]);
+                removedCount++;
+            }
+        }
+        std::memcpy(out.data() + removedCountPosition, &removedCount, sizeof(removedCount));
+
+        write<uint32_t>(out, (uint32_t) changed.size());
+        for (const Entity * e : changed)
+        {
+            write<uint32_t>(out, (uint32_t) e->id());
+            m_record.clear();
+            writeEntity(m_record, *e);
+            writeRecord(out, m_record);
+        }
+    }
+
+    // Entities and moves waiting for the next EntityManager::update()
+    write<uint32_t>(out, (uint32_t) entityManager.getPendingEntities().size());
+    for (auto & e : entityManager.getPendingEntities())
+    {
+        write<uint32_t>(out, (uint32_t) e->id());
+        m_record.clear();
+        writeEntity(m_record, *e);
+        writeRecord(out, m_record);
+    }
+
+    write<uint32_t>(out, (uint32_t) entityManager.getPendingMoves().size());
+    for (auto & m : entityManager.getPendingMoves())
+    {
+        write<uint32_t>(out, (uint32_t) m.first->id());
+        write<uint16_t>(out, getNameId(m.second));
+    }
+
+    // Tile map
+    write<uint16_t>(out, (uint16_t) world.tileAnimations.size());
+    for (auto & animation : world.tileAnimations)
+    {
+        write<int32_t>(out, animation.getCurrentFrame());
+    }
+
+    const size_t cellCountPosition = out.size();
+    uint32_t cellCount = 0;
+    write<uint32_t>(out, cellCount);
+
+    const int columns = std::max(world.tileMap.columns(), base != nullptr ? base->columns : 0);
+    const int rows = std::max(world.tileMap.rows(), base != nullptr ? base->rows : 0);
+    for (int gx = 0; gx < columns; gx++)
+    {
+        for (int gy = 0; gy < rows; gy++)
+        {
+            const TileId id = world.tileMap.getTile(gx, gy);
+            TileId baseId = TileMap::EMPTY;
+            if (base != nullptr && gx < base->columns && gy < base->rows)
+            {
+                baseId = base->cells[gx * base->rows + gy];
+            }
+
+            if (id != baseId)
+            {
+                write<int32_t>(out, gx);
+                write<int32_t>(out, gy);
+                write<TileId>(out, id);
+                cellCount++;
+            }
+        }
+    }
+    std::memcpy(out.data() + cellCountPosition, &cellCount, sizeof(cellCount));
+}
+
+/**
+ * Restores the last frame of the chain. The chain starts with a keyframe, and has every
+ * recorded frame after it.
+ *
+ * The whole frame is read and checked first. If it is cut short, or refers to a name, entity,
+ * animation or tile type that doesn't exist, false is returned and the world is not changed.
+ */
+bool RewindBuffer::decode(const std::vector<const Snapshot *> & chain, const std::vector<std::string> & names, World & world, const Assets & assets)
+{
+    typedef std::pair<size_t, ByteReader> IdRecord;
+
+    struct List
+    {
+        uint16_t tag;
+        std::vector<IdRecord> entities;
+    };
+
+    struct Cell
+    {
+        int32_t gx;
+        int32_t gy;
+        TileId  id;
+    };
+
+    std::vector<List> lists;
+    std::unordered_map<size_t, ByteReader> records;  // id -> record, in the current frame
+    std::unordered_map<size_t, ByteReader> previous; // id -> record, in the previous frame
+    size_t frame = 0;
+    Vec2 cameraPosition;
+    size_t totalEntities = 0;
+    size_t playerId = 0;
+    bool hasBase = false;
+    ByteReader in;
+
+    // Entities left out of a frame are found in the frame before it
+    for (const Snapshot * snapshot : chain)
+    {
+        in = ByteReader(snapshot->bytes.data(), snapshot->bytes.data() + snapshot->bytes.size());
+        frame = in.read<uint64_t>();
+        cameraPosition = in.read<Vec2>();
+        totalEntities = in.read<uint64_t>();
+        playerId = in.read<uint64_t>();
+        in.read<uint8_t>();
+        hasBase = in.read<uint8_t>();
+
+        previous.swap(records);
+        records.clear();
+        lists.resize(in.read<uint16_t>());
+        for (auto & list : lists)
+        {
+            list.tag = in.read<uint16_t>();
+            list.entities.resize(in.readCount(sizeof(uint32_t) + sizeof(uint8_t)));
+            if (list.tag >= names.size())
+            {
+                in.fail();
+            }
+
+            for (auto & entity : list.entities)
+            {
+                entity.first = in.read<uint32_t>();
+                if (in.read<uint8_t>())
+                {
+                    entity.second = in.readRecord();
+                }
+                else
+                {
+                    auto it = previous.find(entity.first);
+                    if (it == previous.end())
+                    {
+                        in.fail();
+                        break;
+                    }
+                    entity.second = it->second;
+                }
+                records[entity.first] = entity.second;
+            }
+        }
+    }
+
+    // Static entities that were destroyed, changed, or added since the base
+    const Base * base = hasBase ? chain.back()->base.get() : nullptr;
+    std::vector<bool> isRemoved;
+    std::unordered_map<size_t, ByteReader> changed;
+    std::vector<IdRecord> added;
+    if (hasBase && base == nullptr)
+    {
+        in.fail();
+    }
+    if (base != nullptr)
+    {
+        isRemoved.assign(base->ids.size(), false);
+        const size_t removedCount = in.readCount(sizeof(uint32_t));
+        for (size_t i = 0; i < removedCount; i++)
+        {
+            auto it = base->indexes.find(in.read<uint32_t>());
+            if (it == base->indexes.end())
+            {
+                in.fail();
+                break;
+            }
+            isRemoved[it->second] = true;
+        }
+
+        const size_t changedCount = in.readCount(sizeof(uint32_t) + sizeof(uint16_t));
+        for (size_t i = 0; i < changedCount; i++)
+        {
+            const size_t id = in.read<uint32_t>();
+            const ByteReader record = in.readRecord();
+            if (base->indexes.count(id) > 0)
+            {
+                changed[id] = record;
+            }
+            else
+            {
+                added.emplace_back(id, record);
+            }
+        }
+    }
+
+    // Entities and moves waiting for the next EntityManager::update()
+    std::vector<IdRecord> pending (in.readCount(sizeof(uint32_t) + sizeof(uint16_t)));
+    for (auto & p : pending)
+    {
+        p.first = in.read<uint32_t>();
+        p.second = in.readRecord();
+    }
+
+    std::vector<std::pair<size_t, uint16_t>> moves (in.readCount(sizeof(uint32_t) + sizeof(uint16_t)));
+    for (auto & move : moves)
+    {
+        move.first = in.read<uint32_t>();
+        move.second = in.read<uint16_t>();
+        if (move.second >= names.size())
+        {
+            in.fail();
+        }
+    }
+
+    // Tile map
+    std::vector<int32_t> tileAnimationFrames (in.read<uint16_t>());
+    for (auto & tileAnimationFrame : tileAnimationFrames)
+    {
+        tileAnimationFrame = in.read<int32_t>();
+    }
+
+    std::vector<Cell> cells (in.readCount(sizeof(int32_t) * 2 + sizeof(TileId)));
+    for (Cell & cell : cells)
+    {
+        cell.gx = in.read<int32_t>();
+        cell.gy = in.read<int32_t>();
+        cell.id = in.read<TileId>();
+        if (cell.gx < 0 || cell.gy < 0 || cell.id >= world.tileMap.typeCount())
+        {
+            in.fail();
+        }
+    }
+
+    // Every record must be readable, and moved entities must exist
+    std::unordered_set<size_t> ids;
+    const auto check = [&](const IdRecord & p)
+    {
+        ids.insert(p.first);
+        if (!checkEntity(p.second, names, assets))
+        {
+            in.fail();
+        }
+    };
+    for (auto & list : lists)
+    {
+        std::for_each(list.entities.begin(), list.entities.end(), check);
+    }
+    std::for_each(changed.begin(), changed.end(), check);
+    std::for_each(added.begin(), added.end(), check);
+    std::for_each(pending.begin(), pending.end(), check);
+    for (size_t i = 0; base != nullptr && i < base->ids.size(); i++)
+    {
+        if (!isRemoved[i])
+        {
+            ids.insert(base->ids[i]);
+        }
+    }
+    for (auto & move : moves)
+    {
+        if (ids.count(move.first) == 0)
+        {
+            in.fail();
+        }
+    }
+
+    if (!in.isValid())
+    {
+        return false;
+    }
+
+    EntityManager & entityManager = world.entityManager;
+    entityManager.clear(totalEntities);
+    std::unordered_map<size_t, std::shared_ptr<Entity>> entities;
+
+    // Unchanged static entities only had their animations updated since the base
+    for (size_t i = 0; base != nullptr && i < base->ids.size(); i++)
+    {
+        if (isRemoved[i])
+        {
+            continue;
+        }
+
+        const size_t id = base->ids[i];
+        auto it = changed.find(id);
+        const ByteReader record = it != changed.end() ? it->second : ByteReader(base->records[i].data(), base->records[i].data() + base->records[i].size());
+        entities[id] = readEntity(record, id, false, names, entityManager, assets);
+        if (it == changed.end())
+        {
+            entities[id]->getComponent<CAnimation>().animation.setCurrentFrame(base->animationFrames[i] + (int) (frame - base->frame));
+        }
+    }
+
+    for (auto & p : added)
+    {
+        entities[p.first] = readEntity(p.second, p.first, false, names, entityManager, assets);
+    }
+
+    for (auto & list : lists)
+    {
+        for (auto & p : list.entities)
+        {
+            entities[p.first] = readEntity(p.second, p.first, false, names, entityManager, assets);
+        }
+    }
+
+    for (auto & p : pending)
+    {
+        entities[p.first] = readEntity(p.second, p.first, true, names, entityManager, assets);
+    }
+
+    for (auto & move : moves)
+    {
+        entityManager.move(entities.at(move.first), names[move.second]);
+    }
+
+    auto player = entities.find(playerId);
+    if (player != entities.end())
+    {
+        world.player = player->second;
+    }
+    world.cameraPosition = cameraPosition;
+    world.currentFrame = frame;
+
+    for (size_t i = 0; i < tileAnimationFrames.size() && i < world.tileAnimations.size(); i++)
+    {
+        world.tileAnimations[i].setCurrentFrame(tileAnimationFrames[i]);
+    }
+
+    TileMap & tileMap = world.tileMap;
+    tileMap.reset(tileMap.cellHalfSize() * 2, tileMap.worldHeight());
+    if (base != nullptr)
+    {
+        for (int gx = 0; gx < base->columns; gx++)
+        {
+            for (int gy = 0; gy < base->rows; gy++)
+            {
+                tileMap.setTile(gx, gy, base->cells[gx * base->rows + gy]);
+            }
+        }
+    }
+
+    for (const Cell & cell : cells)
+    {
+        tileMap.setTile(cell.gx, cell.gy, cell.id);
+    }
+
+    return true;
+}
+
+void RewindBuffer::resetRecording()
+{
+    m_sinceKeyframe = 0;
+    m_records.clear();
+}
+
+/**
+ * Recorded frame, from the oldest (0).
+ */
+const RewindBuffer::Snapshot & RewindBuffer::at(size_t index) const
+{
+    return m_snapshots[(m_first + index) % m_snapshots.size()];
+}
+
+/**
+ * Records the world's current frame, replacing the oldest one if the buffer is full.
+ * Call once per frame, after the frame's systems ran.
+ */
+void RewindBuffer::record(const World & world)
+{
+    if (m_snapshots.empty())
+    {
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // The base is saved once the level's static entities are all added
+    if (!m_isBaseValid)
+    {
+        const EntityVec & pending = world.entityManager.getPendingEntities();
+        const bool hasPendingStatic = std::any_of(pending.begin(), pending.end(), [](const std::shared_ptr<Entity> & e){ return isStaticTag(e->tag()); });
+        if (!hasPendingStatic)
+        {
+            m_base = makeBase(world);
+            m_isBaseValid = true;
+        }
+    }
+
+    Snapshot * snapshot;
+    if (m_count < m_snapshots.size())
+    {
+        snapshot = &m_snapshots[(m_first + m_count) % m_snapshots.size()];
+        m_count++;
+    }
+    else
+    {
+        snapshot = &m_snapshots[m_first];
+        m_first = (m_first + 1) % m_snapshots.size();
+    }
+
+    const bool isKeyframe = m_sinceKeyframe == 0;
+    m_sinceKeyframe = (m_sinceKeyframe + 1) % KEYFRAME_INTERVAL;
+    if (isKeyframe)
+    {
+        m_records.clear();
+    }
+    m_stamp++;
+
+    snapshot->base = m_isBaseValid ? m_base : nullptr;
+    snapshot->isKeyframe = isKeyframe;
+    encode(world, snapshot->base.get(), isKeyframe, true, snapshot->bytes);
+
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    m_recordMicroseconds += elapsed.count();
+    m_recordedBytes += snapshot->bytes.size();
+    m_recordedFrames++;
+}
+
+/**
+ * Restores the world as it was the given number of frames ago, or as far back as possible.
+ * The frames after it are dropped, and recording continues from it.
+ */
+bool RewindBuffer::rewind(size_t frames, World & world, const Assets & assets)
+{
+    // Frames before the oldest keyframe can't be decoded
+    size_t oldest = 0;
+    while (oldest < m_count && !at(oldest).isKeyframe)
+    {
+        oldest++;
+    }
+    if (oldest == m_count)
+    {
+        return false;
+    }
+
+    const size_t target = frames >= m_count - 1 - oldest ? oldest : m_count - 1 - frames;
+    size_t keyframe = target;
+    while (!at(keyframe).isKeyframe)
+    {
+        keyframe--;
+    }
+
+    std::vector<const Snapshot *> chain;
+    for (size_t i = keyframe; i <= target; i++)
+    {
+        chain.push_back(&at(i));
+    }
+    if (!decode(chain, m_names, world, assets))
+    {
+        std::cout << "Error: could not restore recorded frame " << target << "\n";
+        return false;
+    }
+
+    m_count = target + 1;
+    m_base = at(target).base;
+    m_isBaseValid = m_base != nullptr;
+    resetRecording();
+    return true;
+}
+
+/**
+ * Number of recorded frames.
+ */
+size_t RewindBuffer::frameCount() const
+{
+    return m_count;
+}
+
+/**
+ * Saves the whole world, with the names it uses, so it can be loaded in another run.
+ *
+ * Names are numbered in the order the world uses them, rather than by the recorded frames, so
+ * the same world always saves to the same bytes.
+ */
+ByteVec RewindBuffer::save(const World & world)
+{
+    std::vector<std::string> names;
+    std::map<std::string, uint16_t> nameIds;
+    m_names.swap(names);
+    m_nameIds.swap(nameIds);
+    ByteVec snapshot;
+    encode(world, nullptr, true, false, snapshot);
+    m_names.swap(names);
+    m_nameIds.swap(nameIds);
+
+    ByteVec out;
+    write<uint32_t>(out, SAVE_STATE_VERSION);
+    write<uint32_t>(out, (uint32_t) sizeof(ComponentTuple));
+    write<uint16_t>(out, (uint16_t) names.size());
+    for (auto & name : names)
+    {
+        write<uint16_t>(out, (uint16_t) name.size());
+        out.insert(out.end(), name.begin(), name.end());
+    }
+    out.insert(out.end(), snapshot.begin(), snapshot.end());
+    return out;
+}
+
+/**
+ * Restores a world saved by save(). Recorded frames are dropped.
+ *
+ * Returns false, and leaves the world as it was, if the state is from another version or is damaged.
+ */
+bool RewindBuffer::load(const ByteVec & state, World & world, const Assets & assets)
+{
+    ByteReader in (state.data(), state.data() + state.size());
+    const uint32_t version = in.read<uint32_t>();
+    const uint32_t componentsSize = in.read<uint32_t>();
+    if (!in.isValid() || version != SAVE_STATE_VERSION || componentsSize != sizeof(ComponentTuple))
+    {
+        std::cout << "Error: save state is from another version of the game\n";
+        return false;
+    }
+
+    std::vector<std::string> names (in.read<uint16_t>());
+    for (auto & name : names)
+    {
+        const uint16_t size = in.read<uint16_t>();
+        const uint8_t * bytes = in.skip(size);
+        if (bytes != nullptr)
+        {
+            name.assign((const char *) bytes, size);
+        }
+    }
+
+    const uint8_t * bytes = in.skip(0); // the rest of the state is the frame
+    Snapshot snapshot;
+    if (bytes != nullptr)
+    {
+        snapshot.bytes.assign(bytes, state.data() + state.size());
+    }
+    snapshot.isKeyframe = true;
+    if (!in.isValid() || !decode({ &snapshot }, names, world, assets))
+    {
+        std::cout << "Error: save state is damaged\n";
+        return false;
+    }
+
+    m_first = 0;
+    m_count = 0;
+    invalidateBase();
+    resetRecording();
+    return true;
+}
+
+double RewindBuffer::averageRecordMicroseconds() const
+{
+    return m_recordedFrames == 0 ? 0 : m_recordMicroseconds / m_recordedFrames;
+}
+
+double RewindBuffer::averageRecordBytes() const
+{
+    return m_recordedFrames == 0 ? 0 : (double) m_recordedBytes / m_recordedFrames;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "Assets.h"
+#include "TileMap.h"
+#include "Vec2.h"
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The parts of a scene that are saved and restored
+struct World
+{
+    EntityManager &           entityManager;
+    TileMap &                 tileMap;
+    Vec2 &                    cameraPosition;
+    size_t &                  currentFrame;
+    std::shared_ptr<Entity> & player;
+    std::vector<Animation> &  tileAnimations; // shared by all tiles of a tile map type
+};
+
+typedef std::vector<uint8_t> ByteVec;
+
+/**
+ * Reads plain data from a range of bytes. Reading past the end makes the reader invalid, as does
+ * fail() (e.g. on a bad name or id); after that, reads return zeros and don't move the reader.
+ */
+class ByteReader
+{
+private:
+    const uint8_t * m_in = nullptr;
+    const uint8_t * m_end = nullptr;
+    bool            m_isValid = true;
+
+    bool has(size_t size);
+public:
+    ByteReader();
+    ByteReader(const uint8_t * begin, const uint8_t * end);
+
+    template <typename T>
+    T read()
+    {
+        T value {};
+        if (has(sizeof(T)))
+        {
+            std::memcpy(&value, m_in, sizeof(T));
+            m_in += sizeof(T);
+        }
+        return value;
+    }
+
+    const uint8_t * skip(size_t size);
+    ByteReader readRecord();
+    size_t readCount(size_t itemSize);
+    void fail();
+    bool isValid() const;
+};
+
+/**
+ * Binary save states of the world, and a ring buffer of the last frames for rewinding.
+ *
+ * Every entity is saved with its tag, id, and components (animations by asset name). Tag lists
+ * keep their order, so a restored world plays out exactly like the original one did.
+ *
+ * To keep recording every frame cheap, frames are delta compressed:
+ * - Static entities (tiles and decorations) and tile map cells are saved once per level load,
+ *   in a base. A frame only has the static entities that were destroyed, or changed animation,
+ *   and the cells that changed, since then. Static entities are assumed to never move.
+ * - Other entities are saved in full every KEYFRAME_INTERVAL frames. In between, an entity
+ *   that is the same as in the previous frame is saved as just its id.
+ *
+ * Restoring a frame decodes from the keyframe before it, and drops the frames after it, so
+ * recording continues from there (a new branch).
+ *
+ * Frames are checked before anything is restored. A save state that is cut short, or refers to
+ * names, entities, animations or tile types that don't exist, is not loaded.
+ */
+class RewindBuffer
+{
+private:
+    // Static entities and tile map cells, as the level was loaded
+    struct Base
+    {
+        size_t              frame = 0;
+        std::vector<size_t> ids;      // in tag list order, grouped by tag
+        std::vector<ByteVec> records;
+        std::vector<uint16_t> animations; // name ids
+        std::vector<int>    animationFrames;
+        std::unordered_map<size_t, size_t> indexes; // id -> index in ids
+        int                 columns = 0;
+        int                 rows = 0;
+        std::vector<TileId> cells;    // column by column
+    };
+
+    struct Snapshot
+    {
+        std::shared_ptr<const Base> base;
+        ByteVec bytes;
+        bool    isKeyframe = false;
+    };
+
+    // Last record of an entity, and the recorded frame (stamp) it is from
+    struct Record
+    {
+        ByteVec bytes;
+        size_t  stamp = 0;
+    };
+
+    std::vector<Snapshot>        m_snapshots;         // ring buffer
+    size_t                       m_first = 0;
+    size_t                       m_count = 0;
+    size_t                       m_sinceKeyframe = 0;
+    std::shared_ptr<const Base>  m_base;
+    bool                         m_isBaseValid = false;
+    std::unordered_map<size_t, Record> m_records;     // entity id -> record
+    size_t                       m_stamp = 0;
+    std::vector<bool>            m_seen;              // scratch, base entity -> is still in its list
+    ByteVec                      m_record;            // scratch
+
+    std::vector<std::string>        m_names; // tags and animation names
+    std::map<std::string, uint16_t> m_nameIds;
+
+    // Recording stats
+    double m_recordMicroseconds = 0;
+    size_t m_recordedBytes = 0;
+    size_t m_recordedFrames = 0;
+
+    uint16_t getNameId(const std::string & name);
+    void writeEntity(ByteVec & out, const Entity & e);
+    static bool checkEntity(ByteReader in, const std::vector<std::string> & names, const Assets & assets);
+    static std::shared_ptr<Entity> readEntity(ByteReader in, size_t id, bool isPending, const std::vector<std::string> & names, EntityManager & entityManager, const Assets & assets);
+    std::shared_ptr<Base> makeBase(const World & world);
+    void encode(const World & world, const Base * base, bool isKeyframe, bool isRecording, ByteVec & out);
+    static bool decode(const std::vector<const Snapshot *> & chain, const std::vector<std::string> & names, World & world, const Assets & assets);
+    void resetRecording();
+    const Snapshot & at(size_t index) const;
+public:
+    static constexpr size_t KEYFRAME_INTERVAL = 60;
+    static constexpr uint32_t SAVE_STATE_VERSION = 2; // saved along with sizeof(ComponentTuple)
+
+    RewindBuffer();
+
+    void setCapacity(size_t frames);
+    void invalidateBase();
+    void clear();
+    void record(const World & world);
+    bool rewind(size_t frames, World & world, const Assets & assets);
+    size_t frameCount() const;
+
+    ByteVec save(const World & world);
+    bool load(const ByteVec & state, World & world, const Assets & assets);
+
+    double averageRecordMicroseconds() const;
+    double averageRecordBytes() const;
+};
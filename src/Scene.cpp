@@ -29,17 +29,58 @@ void Scene::sRender()
 {
 }
 
+/**
+ * Advances the scene by one frame, without rendering it.
+ * 
+ * Scenes that can be rendered from a snapshot must override this, by default it just calls update().
+ */
+void Scene::step()
+{
+    update();
+}
+
+/**
+ * Fills the snapshot with what the scene would currently render.
+ * 
+ * By default the snapshot is left empty.
+ */
+void Scene::snapshot(RenderSnapshot & snapshot)
+{
+    snapshot.sprites.clear();
+}
+
 void Scene::doAction(const Action & action)
 {
 }
 
+void Scene::onAssetsChanged(const std::vector<AnimationId> & animations)
+{
+}
+
 void Scene::simulate(const size_t frames) // calls derived scene's update() a count number of times
 {
 }
 
-void Scene::registerAction(int inputKey, const std::string & actionName)
+void Scene::registerAction(int inputKey, ActionId action)
+{
+    if (inputKey < 0)
+    {
+        return;
+    }
+
+    if ((size_t) inputKey >= m_actionMap.size())
+    {
+        m_actionMap.resize(inputKey + 1, ActionId::NONE);
+    }
+    m_actionMap[inputKey] = action;
+}
+
+/**
+ * Returns the action registered for a key, or NONE.
+ */
+ActionId Scene::getAction(int inputKey) const
 {
-    m_actionMap[inputKey] = actionName;
+    return inputKey >= 0 && (size_t) inputKey < m_actionMap.size() ? m_actionMap[inputKey] : ActionId::NONE;
 }
 
 size_t Scene::width() const
@@ -52,6 +93,7 @@ size_t Scene::height() const
 
 size_t Scene::currentFrame() const
 {
+    return m_currentFrame;
 }
 
 bool Scene::hasEnded() const
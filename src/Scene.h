@@ -3,12 +3,14 @@
 #include "GameEngine.h"
 #include "EntityManager.h"
 #include "Action.h"
+#include "RenderSnapshot.h"
 #include <map>
 #include <string>
+#include <vector>
 
 class GameEngine;
 
-typedef std::map<int, std::string> ActionMap;
+typedef std::vector<ActionId> ActionMap; // key code -> action (NONE if the key has no action)
 
 class Scene 
 {
@@ -30,10 +32,14 @@ public:
     virtual void update() = 0;
     virtual void sDoAction(const Action & action) = 0;
     virtual void sRender() = 0;
+    virtual void step();                              // update() without rendering
+    virtual void snapshot(RenderSnapshot & snapshot); // copy what sRender() would draw
 
     virtual void doAction(const Action & action);
+    virtual void onAssetsChanged(const std::vector<AnimationId> & animations); // called after assets are hot reloaded
     void simulate(const size_t frames); // calls derived scene's update() a count number of times
-    void registerAction(int inputKey, const std::string & actionName);
+    void registerAction(int inputKey, ActionId action);
+    ActionId getAction(int inputKey) const;
 
     size_t width() const;
     size_t height() const;
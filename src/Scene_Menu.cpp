@@ -1,11 +1,18 @@
 #include "Scene_Menu.h"
+#include <string>
 
 void Scene_Menu::init()
 {
+    m_title = "Super Mario Bros";
+    m_menuText.setFont(m_game->assets().getFont("Grid"));
+    m_menuText.setCharacterSize(48);
+    m_menuText.setFillColor(sf::Color::White);
 }
 
 void Scene_Menu::update()
 {
+    sRender();
+    m_currentFrame++;
 }
 
 void Scene_Menu::onEnd()
@@ -17,9 +24,26 @@ void Scene_Menu::sDoAction(const Action & action)
 }
 
 Scene_Menu::Scene_Menu(GameEngine * gameEngine)
+    : Scene(gameEngine)
 {
+    init();
 }
 
+/**
+ * Draws the title, and how far asset loading has got.
+ */
 void Scene_Menu::sRender()
 {
+    sf::RenderWindow & window = m_game->window();
+    window.clear(sf::Color::Black);
+
+    m_menuText.setString(m_title);
+    m_menuText.setPosition(64, 64);
+    window.draw(m_menuText);
+
+    m_menuText.setString("Loading " + std::to_string((int) (m_game->loadingProgress() * 100)) + "%");
+    m_menuText.setPosition(64, 160);
+    window.draw(m_menuText);
+
+    window.display();
 }
@@ -1,10 +1,18 @@
 #include "Scene_Play.h"
 #include "Physics.h"
 #include <iostream>
-#include <sstream> 
 #include <cmath>
 #include <fstream>
+#include <algorithm>
+#include <unordered_set>
 #include "PhysicsConstants.h"
+#include "EnemySystems.h"
+#include "PlayerKinematics.h"
+
+const sf::Color SKY_COLOR = sf::Color(97, 126, 248);
+const int STREAM_PREFETCH_CHUNKS = 2; // chunks parsed in the background, ahead of the chunks kept as entities
+const size_t REWIND_FRAMES = 60; // frames rewound per press
+const std::string SAVE_STATE_PATH = "bin/savestate.bin";
 
 /**
  * Reloads the level.
@@ -14,9 +22,79 @@
 void Scene_Play::reloadLevel()
 {
     m_entityManager = EntityManager();
+    resetStaticCaches();
+    m_tileMap.reset(m_gridCellSize, m_cameraSize.y);
+    m_cameraPosition = Vec2(0.f,0.f);
+    m_rewindBuffer.invalidateBase();
     loadLevel();
     spawnPlayer();
-    m_cameraPosition = Vec2(0.f,0.f);
+}
+
+/**
+ * Drops everything cached from tiles and decorations, after they are replaced.
+ */
+void Scene_Play::resetStaticCaches()
+{
+    m_decorationIndex.reset();
+    m_tileIndex.reset();
+    m_renderTileIndex.reset();
+    m_decorationCache.reset();
+}
+
+/**
+ * The state of the scene that is saved and restored by the rewind buffer.
+ */
+World Scene_Play::world()
+{
+    return World { m_entityManager, m_tileMap, m_cameraPosition, m_currentFrame, m_player, m_tileAnimations };
+}
+
+/**
+ * Goes back the given number of frames (or as far as recorded), and plays on from there.
+ */
+void Scene_Play::rewind(size_t frames)
+{
+    const size_t currentFrame = m_currentFrame;
+    World w = world();
+    if (!m_rewindBuffer.rewind(frames, w, m_game->assets()))
+    {
+        return;
+    }
+    resetStaticCaches();
+
+    std::cout << "Rewound " << currentFrame - m_currentFrame << " frames. Recording: "
+              << m_rewindBuffer.averageRecordMicroseconds() << " us and "
+              << m_rewindBuffer.averageRecordBytes() << " bytes per frame\n";
+}
+
+void Scene_Play::saveState()
+{
+    const ByteVec state = m_rewindBuffer.save(world());
+    std::ofstream file (SAVE_STATE_PATH, std::ios::binary);
+    file.write((const char *) state.data(), state.size());
+    if (!file)
+    {
+        std::cout << "Error: could not write " << SAVE_STATE_PATH << "\n";
+        return;
+    }
+    std::cout << "Saved state (" << state.size() << " bytes)\n";
+}
+
+void Scene_Play::loadState()
+{
+    std::ifstream file (SAVE_STATE_PATH, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "Error: could not open " << SAVE_STATE_PATH << "\n";
+        return;
+    }
+
+    const ByteVec state ((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    World w = world();
+    if (m_rewindBuffer.load(state, w, m_game->assets()))
+    {
+        resetStaticCaches();
+    }
 }
 
 /**
@@ -25,27 +103,102 @@ void Scene_Play::reloadLevel()
  */
 void Scene_Play::init()
 {
+    // The camera is the size of the window. The window is never resized.
+    m_cameraSize = Vec2(m_game->window().getSize().x, m_game->window().getSize().y);
+
     // Bind keyboard keys to actions
-    registerAction(sf::Keyboard::G, "TOGGLE_GRID");
-    registerAction(sf::Keyboard::C, "TOGGLE_BOUNDING_BOXES");
-    registerAction(sf::Keyboard::T, "TOGGLE_TEXTURES");
-    registerAction(sf::Keyboard::W, "UP");
-    registerAction(sf::Keyboard::S, "DOWN");
-    registerAction(sf::Keyboard::A, "LEFT");
-    registerAction(sf::Keyboard::D, "RIGHT");
-    registerAction(sf::Keyboard::B, "RUN");
-    registerAction(sf::Keyboard::V, "JUMP");
+    registerAction(sf::Keyboard::G, ActionId::TOGGLE_GRID);
+    registerAction(sf::Keyboard::C, ActionId::TOGGLE_BOUNDING_BOXES);
+    registerAction(sf::Keyboard::T, ActionId::TOGGLE_TEXTURES);
+    registerAction(sf::Keyboard::W, ActionId::UP);
+    registerAction(sf::Keyboard::S, ActionId::DOWN);
+    registerAction(sf::Keyboard::A, ActionId::LEFT);
+    registerAction(sf::Keyboard::D, ActionId::RIGHT);
+    registerAction(sf::Keyboard::B, ActionId::RUN);
+    registerAction(sf::Keyboard::V, ActionId::JUMP);
 
     // Initialize debugging grid
-    m_gridText.setFont(m_game->assets().getFont("Grid"));
-    m_gridText.setCharacterSize(12);
-    m_gridText.setFillColor(sf::Color::White);
+    m_debugGrid.init(m_game->assets().getFont("Grid"), 12, m_gridCellSize);
+
+    // Pick renderer
+    m_useSpriteBatch = m_game->settings().getString("Renderer", "Sprite") == "Batched";
+    m_useDecorationCache = m_game->settings().getBool("DecorationCache", false) && m_game->textureResidency() == nullptr;
+    m_parallelEnemies = m_game->settings().getBool("ParallelEnemies", false);
+    m_streamLevel = m_game->settings().getBool("LevelStreaming", false);
+    m_useTileMap = m_game->settings().getBool("TileMap", false);
+    m_optimizeLevel = m_game->settings().getBool("OptimizeLevel", false) && !m_useTileMap;
+    m_chunkColumns = std::max(1, m_game->settings().getInt("StreamChunkColumns", 16));
+    m_hotReload = m_game->settings().getBool("HotReload", false) && !m_game->settings().getBool("Pipeline", false);
+    if (m_hotReload)
+    {
+        m_levelWatcher.watch(m_levelPath);
+    }
+
+    // Streamed chunks are not saved, so save states need the whole level
+    if (!m_streamLevel)
+    {
+        m_rewindBuffer.setCapacity(std::max(0, m_game->settings().getInt("Rewind", 0)) * 60);
+        registerAction(sf::Keyboard::R, ActionId::REWIND);
+        registerAction(sf::Keyboard::F5, ActionId::SAVE_STATE);
+        registerAction(sf::Keyboard::F9, ActionId::LOAD_STATE);
+    }
+    m_tileMap.reset(m_gridCellSize, m_cameraSize.y);
+    registerSystems();
+
+    // Game logic uses animation ids, not names
+    const Assets & assets = m_game->assets();
+    m_animations.marioStand = assets.getAnimationId("MarioStand");
+    m_animations.marioWalk = assets.getAnimationId("MarioWalk");
+    m_animations.marioRun = assets.getAnimationId("MarioRun");
+    m_animations.marioSkid = assets.getAnimationId("MarioSkid");
+    m_animations.marioAir = assets.getAnimationId("MarioAir");
+    m_animations.goombaWalk = assets.getAnimationId("GoombaWalk");
+    m_animations.goombaDead = assets.getAnimationId("GoombaDead");
+    m_animations.koopaWalk = assets.getAnimationId("KoopaWalk");
+    m_animations.koopaShell = assets.getAnimationId("KoopaShell");
+    m_animations.questionMarkBlockHit = assets.getAnimationId("QuestionMarkBlockHit");
+    m_animations.coinBlink = assets.getAnimationId("CoinBlink");
+    m_animations.brokenBrick = assets.getAnimationId("BrokenBrick");
+    m_questionMarkBlockHitTile = getTileId("QuestionMarkBlockHit");
+
+    // Decorations are streamed by their position, so parallax layers can't be streamed
+    if (!m_streamLevel)
+    {
+        for (auto & p : m_game->settings().getGroup("Parallax."))
+        {
+            m_decorationCache.setParallax(p.first, m_game->settings().getFloat("Parallax." + p.first, 1.0f));
+        }
+    }
 
     // Spawn player, and load the level
     spawnPlayer();
     loadLevel();
 }
 
+/**
+ * Registers the systems run by step(), with the components and state each one reads and writes.
+ * 
+ * Systems run in the order they are registered. SceneState covers the player, camera, tile map,
+ * assets, and the other members of the scene; EntityChanges covers the entity lists (reading
+ * them, and adding, destroying, or moving entities).
+ * 
+ * Collision systems queue what their collisions do (see sCollisionEvents()), and the queue is
+ * applied after each of them, so the next system sees the outcome.
+ */
+void Scene_Play::registerSystems()
+{
+    m_systems.clear();
+    m_systems.add<Reads<EntityChanges, SceneState>, Writes<CTransform, CEnemy, CLifeSpan, CAnimation, CBoundingBox>>("EnemyState", [this]() { sEnemyState(); });
+    m_systems.add<Reads<CTransform, CInput, SceneState>, Writes<CState>>("PlayerState", [this]() { sPlayerState(); });
+    m_systems.add<Reads<CState>, Writes<CTransform, CAnimation, CLifeSpan, EntityChanges, SceneState>>("Animation", [this]() { sAnimation(); });
+    m_systems.add<Reads<CInput, CBoundingBox, CEnemy, SceneState>, Writes<CTransform, CState, EntityChanges>>("Movement", [this]() { sMovement(); });
+    m_systems.add<Reads<CBoundingBox, CEnemy, CLifeSpan, CTile, EntityChanges>, Writes<CTransform, CState, CInput, SceneState>>("PlayerCollision", [this]() { sPlayerCollision(); });
+    m_systems.add<Reads<>, Writes<CTransform, CAnimation, CBoundingBox, CEnemy, CLifeSpan, CTile, EntityChanges, SceneState>>("PlayerCollisionEvents", [this]() { sCollisionEvents(); });
+    m_systems.add<Reads<CAnimation, CBoundingBox, CEnemy, EntityChanges>, Writes<CTransform, SceneState>>("EnemyCollision", [this]() { sEnemyCollision(); });
+    m_systems.add<Reads<>, Writes<CTransform, CAnimation, CBoundingBox, CEnemy, CLifeSpan, EntityChanges, SceneState>>("EnemyCollisionEvents", [this]() { sCollisionEvents(); });
+    m_systems.add<Reads<CTransform>, Writes<SceneState>>("Camera", [this]() { sCamera(); });
+}
+
 /**
  * Transforms the grid coordinate representation of the position of a entity
  * to the cartesian coordinate representation.
@@ -71,9 +224,7 @@ Vec2 Scene_Play::gridToCartesianRepresentation(float gridX, float gridY, std::sh
  */
 Vec2 Scene_Play::gridToCartesianRepresentation(Vec2 gridPos, Vec2 size)
 {
-    const sf::RenderWindow & window = m_game->window();
-    const int heighGrid = window.getSize().y;
-    const int widthGrid = window.getSize().x;
+    const int heighGrid = m_cameraSize.y;
 
     // Bottom left corner of entity in cartesian coordinates (from grid coordinates)
     const Vec2 bottomLeft(m_gridCellSize.x * (gridPos.x), heighGrid - m_gridCellSize.y * (gridPos.y));
@@ -85,14 +236,56 @@ Vec2 Scene_Play::gridToCartesianRepresentation(Vec2 gridPos, Vec2 size)
 }
 
 /**
- * Creates Tile, and Decoration type entities.
+ * Returns the behaviour flags of tiles with the given animation.
  */
-void Scene_Play::createStaticEntity(const std::string& type, const std::string& animation, float gx, float gy)
+uint8_t Scene_Play::getTileFlags(const std::string& animation)
 {
-    if (type != "Tile" && type != "Decoration")
+    if (animation == "Brick")
     {
-        std::cout << "Error: can only create Tile or Decoration type entities!\n";
-        return;
+        return TILE_SOLID | TILE_BREAKABLE;
+    }
+    else if (animation == "QuestionMarkBlink")
+    {
+        return TILE_SOLID | TILE_QUESTION;
+    }
+
+    return TILE_SOLID;
+}
+
+/**
+ * Returns the tile map id of tiles with the given animation, adding the tile type if needed.
+ */
+TileId Scene_Play::getTileId(const std::string& animation)
+{
+    TileId id = m_tileMap.getTypeId(animation);
+
+    if (id == TileMap::EMPTY)
+    {
+        id = m_tileMap.addType(animation, getTileFlags(animation));
+        m_tileAnimations.resize(id + 1);
+        m_tileAnimations[id] = m_game->assets().getAnimation(animation);
+    }
+
+    return id;
+}
+
+/**
+ * Creates Tile, RenderTile (tile without collisions), and Decoration type entities.
+ * 
+ * With the tile map on, tiles are put in the tile map instead, and nullptr is returned.
+ */
+std::shared_ptr<Entity> Scene_Play::createStaticEntity(const std::string& type, const std::string& animation, float gx, float gy)
+{
+    if (type != "Tile" && type != "RenderTile" && type != "Decoration")
+    {
+        std::cout << "Error: can only create Tile, RenderTile, or Decoration type entities!\n";
+        return nullptr;
+    }
+
+    if (type == "Tile" && m_useTileMap)
+    {
+        m_tileMap.setTile((int) gx, (int) gy, getTileId(animation));
+        return nullptr;
     }
 
     // Create entity
@@ -102,28 +295,42 @@ void Scene_Play::createStaticEntity(const std::string& type, const std::string&
     e->addComponent<CAnimation>(m_game->assets().getAnimation(animation), true);
     e->addComponent<CTransform>(gridToCartesianRepresentation(gx,gy,e));
 
-    // Tiles have bounding boxes (i.e collisions)
+    // Tiles have bounding boxes (i.e collisions), and behaviour flags
     if (type == "Tile")
     {
         e->addComponent<CBoundingBox>(Vec2(64,64));
+        e->addComponent<CTile>(getTileFlags(animation));
     }
+
+    return e;
 }
 
 /**
- * Creates Goomba type entities.
+ * Creates Goomba and Koopa type entities.
  */
-void Scene_Play::createEnemyEntity(const std::string& type, float gx, float gy, float activationDistance)
+std::shared_ptr<Entity> Scene_Play::createEnemyEntity(const std::string& type, float gx, float gy, float activationDistance)
 {
+    if (type == "Koopa")
+    {
+        const Vec2 KOOPA_BB = Vec2(64,92);
+        auto koopa = m_entityManager.addEntity("Enemy");
+        koopa->addComponent<CEnemy>(EnemyType::KOOPA, false, (gx - activationDistance) * 64);
+        koopa->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.koopaWalk), true);
+        koopa->addComponent<CTransform>(gridToCartesianRepresentation(Vec2(gx,gy), KOOPA_BB), Vec2(-ENEMY_KINEMATICS::KOOPA_SPEED, 0), Vec2(1,1), 0, 0, ENEMY_KINEMATICS::GRAVITY);
+        koopa->addComponent<CBoundingBox>(KOOPA_BB);
+        return koopa;
+    }
+
     if (type != "Goomba")
     {
         std::cout << "Error: " << type << " creation is not yet supported!\n";
-        return;
+        return nullptr;
     }
 
     auto e = m_entityManager.addEntity("Enemy");
 
     // Add components
-    e->addComponent<CAnimation>(m_game->assets().getAnimation("GoombaWalk"), true);
+    e->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.goombaWalk), true);
     e->addComponent<CBoundingBox>(Vec2(64,64));
     CTransform& goombaCT = e->addComponent<CTransform>(gridToCartesianRepresentation(gx,gy,e));
     CEnemy& goombaCE =  e->addComponent<CEnemy>();
@@ -133,111 +340,175 @@ void Scene_Play::createEnemyEntity(const std::string& type, float gx, float gy,
     goombaCT.acc_y = ENEMY_KINEMATICS::GRAVITY;
     goombaCE.activation_x = (gx - activationDistance) * 64;
     goombaCE.type = EnemyType::GOOMBA;
+
+    return e;
 }
 
+/**
+ * Creates an invisible Tile, width grid cells wide, that is only used for collisions.
+ */
+std::shared_ptr<Entity> Scene_Play::createColliderEntity(float gx, float gy, int width)
+{
+    const Vec2 size (m_gridCellSize.x * width, m_gridCellSize.y);
+
+    auto e = m_entityManager.addEntity("Tile");
+    e->addComponent<CTransform>(gridToCartesianRepresentation(Vec2(gx, gy), size));
+    e->addComponent<CBoundingBox>(size);
+    e->addComponent<CTile>(TILE_SOLID);
+
+    return e;
+}
 
 /**
- * Loads the level.
+ * Creates the entities of a chunk of the level (optimized, if the level optimizer is on).
  * 
- * If level was already loaded, then calling this function reloads the level.
+ * Streamed chunks keep their tiles and decorations, to destroy them once the camera has left them
+ * behind. With hot reload, chunks keep the entries they were made from, and the ids of their entities.
  */
-void Scene_Play::loadLevel()
+void Scene_Play::createChunk(int chunk, const EntitySpecVec& specs)
 {
-    std::ifstream levelSpec (m_levelPath);
-
-    if (!levelSpec.is_open())
+    EntitySpecVec optimized;
+    const EntitySpecVec * created = &specs;
+    if (m_optimizeLevel)
     {
-        std::cout << "Error: level specification file could not be open.\n";
-        return;
+        optimized = specs;
+        LevelOptimizer::optimize(optimized, &Scene_Play::getTileFlags);
+        created = &optimized;
     }
 
-    while (levelSpec)
+    EntityVec * streamed = m_streamLevel ? &m_streamedChunks[chunk] : nullptr;
+    LoadedChunk * loaded = m_hotReload ? &m_loadedChunks[chunk] : nullptr;
+    if (streamed)
     {
-        std::string type;
-        levelSpec >> type;
+        streamed->clear();
+    }
+    if (loaded)
+    {
+        loaded->specs = specs;
+        loaded->ids.clear();
+    }
 
-        if (type == "Tile" || type == "Decoration")
+    for (auto & spec : *created)
+    {
+        auto e = createEntity(spec);
+        if (!e)
         {
-            std::string animationName;
-            float gx;
-            float gy;
-
-            levelSpec >> animationName >> gx >> gy;
-
-            createStaticEntity(type, animationName, gx, gy);
             continue;
         }
-        else if (type == "TileRangeHorizontal" || type == "DecorationRangeHorizontal" || type == "TileRangeVertical" || type == "DecorationRangeVertical")
+
+        if (streamed && e->tag() != "Enemy")
+        {
+            streamed->push_back(e);
+        }
+        if (loaded)
         {
-            // Actual type of range of entities to create
-            const std::string actualType = (type == "TileRangeHorizontal" || type == "TileRangeVertical") ? "Tile" : "Decoration";
-            std::string animationName;
-            float gx;
-            float gy;
+            loaded->ids.push_back(e->id());
+        }
+    }
+}
 
-            levelSpec >> animationName >> gx >> gy;
+/**
+ * Empties the tile map columns of a chunk, when its tiles are destroyed. The cells stay allocated
+ * (a byte each), since the tile map only grows.
+ */
+void Scene_Play::clearChunkTiles(int chunk)
+{
+    if (!m_useTileMap)
+    {
+        return;
+    }
 
-            // Range Horizontal
-            if (type == "TileRangeHorizontal" || type == "DecorationRangeHorizontal")
-            {
-                int width;
-                levelSpec >> width;
+    for (int gx = chunk * m_chunkColumns; gx < (chunk + 1) * m_chunkColumns; gx++)
+    {
+        for (int gy = 0; gy < m_tileMap.rows(); gy++)
+        {
+            m_tileMap.setTile(gx, gy, TileMap::EMPTY);
+        }
+    }
+}
 
-                for (int i = 0; i < width; i++)
-                {
-                    const int currentGx = gx + i;
+/**
+ * Groups level entries by the chunk of columns they are in.
+ */
+std::map<int, EntitySpecVec> Scene_Play::splitIntoChunks(const EntitySpecVec& specs) const
+{
+    std::map<int, EntitySpecVec> chunks;
+    for (auto & spec : specs)
+    {
+        chunks[LevelStream::chunkOf(spec.gx, m_chunkColumns)].push_back(spec);
+    }
+    return chunks;
+}
 
-                    createStaticEntity(actualType, animationName, currentGx, gy);
-                }
-            }
-            // Range Vertical
-            else
-            {
-                int height;
-                levelSpec >> height;
+/**
+ * Creates the entity described by a level specification entry.
+ */
+std::shared_ptr<Entity> Scene_Play::createEntity(const EntitySpec& spec)
+{
+    if (spec.type == "Tile" || spec.type == "RenderTile" || spec.type == "Decoration")
+    {
+        return createStaticEntity(spec.type, spec.animation, spec.gx, spec.gy);
+    }
+    else if (spec.type == "Collider")
+    {
+        return createColliderEntity(spec.gx, spec.gy, spec.width);
+    }
 
-                for (int i = 0; i < height; i++)
-                {
-                    const int currentGy = gy + i;
+    return createEnemyEntity(spec.type, spec.gx, spec.gy, spec.activationDistance);
+}
 
-                    createStaticEntity(actualType, animationName, gx, currentGy);
-                }
-            }
-            continue;
-        }
-        else if (type == "Goomba")
-        {
-            float gx;
-            float gy;
-            float ad;
 
-            levelSpec >> gx >> gy >> ad;
+/**
+ * Loads the level.
+ * 
+ * If level was already loaded, then calling this function reloads the level.
+ */
+void Scene_Play::loadLevel()
+{
+    m_loadedChunks.clear();
 
-            createEnemyEntity(type, gx, gy, ad);
-            continue;
-        }
-        else if (type == "Koopa")
+    if (m_streamLevel)
+    {
+        m_streamedChunks.clear();
+        if (!m_levelStream.isOpen())
         {
-            float gx;
-            float gy;
-            float ad;
+            m_levelStream.open(m_levelPath, m_chunkColumns, &m_game->jobs());
+        }
+        sStreamLevel();
+        return;
+    }
+
+    std::ifstream levelSpec (m_levelPath);
 
-            levelSpec >> gx >> gy >> ad;
+    if (!levelSpec.is_open())
+    {
+        std::cout << "Error: level specification file could not be open.\n";
+        return;
+    }
 
-            const Vec2 KOOPA_BB = Vec2(64,92);
-            auto koopa = m_entityManager.addEntity("Enemy");
-            koopa->addComponent<CEnemy>(EnemyType::KOOPA, false, (gx - ad) * 64);
-            koopa->addComponent<CAnimation>(m_game->assets().getAnimation("KoopaWalk"), true);
-            koopa->addComponent<CTransform>(gridToCartesianRepresentation(Vec2(gx,gy), KOOPA_BB), Vec2(-ENEMY_KINEMATICS::KOOPA_SPEED, 0), Vec2(1,1), 0, 0, ENEMY_KINEMATICS::GRAVITY);
-            koopa->addComponent<CBoundingBox>(KOOPA_BB);
+    EntitySpecVec specs;
+    while (LevelStream::readEntry(levelSpec, specs)) {}
 
-            continue;
-        }
-        else
+    // With hot reload, the level is made a chunk at a time, so that a chunk can be made again on its own
+    if (m_hotReload)
+    {
+        for (auto & chunk : splitIntoChunks(specs))
         {
-            std::cout << "Error: " << type << " is not or not yet a supported entity type.\n";
-            return;
+            createChunk(chunk.first, chunk.second);
         }
+        return;
+    }
+
+    if (m_optimizeLevel)
+    {
+        const LevelOptimizerStats stats = LevelOptimizer::optimize(specs, &Scene_Play::getTileFlags);
+        std::cout << "Level optimizer: " << stats.collidersBefore << " tile colliders reduced to " << stats.collidersAfter
+                  << " (" << stats.renderOnlyTiles << " unreachable tiles made render-only)\n";
+    }
+
+    for (auto & spec : specs)
+    {
+        createEntity(spec);
     }
 }
 
@@ -250,7 +521,7 @@ void Scene_Play::loadLevel()
 void Scene_Play::spawnPlayer()
 {
     auto player = m_entityManager.addEntity("Player");
-    player->addComponent<CAnimation>(m_game->assets().getAnimation("MarioStand"), true);
+    player->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.marioStand), true);
     player->addComponent<CTransform>(gridToCartesianRepresentation(4,7,player));
     player->addComponent<CBoundingBox>(Vec2(56, 64));
     player->addComponent<CInput>();
@@ -281,6 +552,19 @@ Scene_Play::Scene_Play(GameEngine * gameEngine, const std::string & levelPath)
  */
 void Scene_Play::update()
 {
+    step();
+
+    // Render the frame to the screen
+    sRender();
+}
+
+/**
+ * Advances the game by one frame, without rendering it.
+ */
+void Scene_Play::step()
+{
+    sHotReload();
+    sStreamLevel();
     m_entityManager.update();
 
     if (!m_player->isActive())
@@ -288,17 +572,11 @@ void Scene_Play::update()
         reloadLevel();
     }
 
-    // Call systems that calculate state of entities
-    sEnemyState();
-    sPlayerState();
-
-    // Call systems that depend on entity state
-    sAnimation();
-    sMovement();
-    sCollision();
+    // Systems that calculate state of entities, and then those that depend on it (see registerSystems)
+    m_systems.run();
 
-    // Render the frame to the screen
-    sRender();
+    m_currentFrame++;
+    m_rewindBuffer.record(world());
 }
 
 /**
@@ -312,40 +590,40 @@ void Scene_Play::sPlayerAnimation()
     const CState& cState = m_player->getComponent<CState>();
     CTransform& cTransform = m_player->getComponent<CTransform>();
     CAnimation& cAnimation = m_player->getComponent<CAnimation>();
-    std::string nextAnimation = "";
+    AnimationId nextAnimation = Animation::NONE;
 
     // Figure out animation for the current frame
     if (cState.isGrounded) // grounded
     {
         if (cState.acceleration == Acceleration::ZERO && cTransform.velocity.x == 0) // not moving
         {
-            nextAnimation = "MarioStand";
+            nextAnimation = m_animations.marioStand;
         }
         else if (cState.isSkidding) // skidding
         {
-            nextAnimation = "MarioSkid";
+            nextAnimation = m_animations.marioSkid;
         }
         else if (cTransform.velocity.x > GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x < -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED) // running
         {
-            nextAnimation = "MarioRun";
+            nextAnimation = m_animations.marioRun;
         }
         else // walking
         {
-            nextAnimation = "MarioWalk";
+            nextAnimation = m_animations.marioWalk;
         }
     }
     else // airborne
     {
-        nextAnimation = "MarioAir";
+        nextAnimation = m_animations.marioAir;
     }
 
-    const std::string currentAnimation = cAnimation.animation.getName();
+    const AnimationId currentAnimation = cAnimation.animation.getId();
     
     // Only change animations if previous animation is different from this frame's animation
     if (currentAnimation != nextAnimation)
     {
         Animation next = m_game->assets().getAnimation(nextAnimation);
-        if ((nextAnimation == "MarioRun" && currentAnimation == "MarioWalk") || (nextAnimation == "MarioWalk" && currentAnimation == "MarioRun"))
+        if ((nextAnimation == m_animations.marioRun && currentAnimation == m_animations.marioWalk) || (nextAnimation == m_animations.marioWalk && currentAnimation == m_animations.marioRun))
         {
             // For a smooth transition from walking to running, and running to walking
             // (Both use exact same animation texture, but with different animation speeds.)
@@ -375,6 +653,12 @@ void Scene_Play::sAnimation()
         e->getComponent<CAnimation>().animation.update();
     }
 
+    // All tiles of a tile map type share one animation
+    for (auto & animation : m_tileAnimations)
+    {
+        animation.update();
+    }
+
     for (auto e : m_entityManager.getEntities("Enemy"))
     {
         CTransform& eCT = e->getComponent<CTransform>();
@@ -418,1094 +702,1043 @@ void Scene_Play::sAnimation()
  */
 void Scene_Play::sPlayerState()
 {
-    CState& cState = m_player->getComponent<CState>();
-    const CInput& cInput = m_player->getComponent<CInput>();
-    const CTransform& cTransform = m_player->getComponent<CTransform>();
-
-    const bool isAirborne      = !cState.isGrounded;
-    const bool isPressingLeft  = cInput.left;
-    const bool isPressingRight = cInput.right;
-    const bool isStandingStill = cTransform.velocity.x == 0;
-    const bool isMovingRight   = cTransform.velocity.x > 0;
-    const bool isMovingLeft    = cTransform.velocity.x < 0;
-
-    // Decelerating: speed is decreasing (going to zero)
-    // Accelerating: speed is increasing (going away from zero)
-    bool isDeceleratingLeft  = false; 
-    bool isDeceleratingRight = false; 
-    bool isAcceleratingLeft  = false;
-    bool isAcceleratingRight = false;
-    bool isSkidding          = false;
-    Direction newFacingDirection = cState.facingDir;
-
-    if (isAirborne)
-    {
-        const bool isChangingMovementDirection    = (isMovingLeft && (isPressingRight && !isPressingLeft)) || (isMovingRight && (isPressingLeft && !isPressingRight)); // turning only, doesn't include stopping
-        const bool isAboveInitialSpeedThresholdForVel = (cState.initialJumpXSpeed <= -AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL || cState.initialJumpXSpeed >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL);
-        const double maxXSpeed                    = isAboveInitialSpeedThresholdForVel ? AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL : AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL;
-        const bool isBellowMaxSpeed               = (cTransform.velocity.x < maxXSpeed) && (cTransform.velocity.x > -maxXSpeed);
-
-        isDeceleratingLeft  = (isMovingRight && isChangingMovementDirection);
-        isDeceleratingRight = (isMovingLeft && isChangingMovementDirection);
-        isAcceleratingLeft  = (isPressingLeft && !isPressingRight) && (isMovingLeft || isStandingStill) && isBellowMaxSpeed;
-        isAcceleratingRight = isPressingRight && !isPressingLeft && (isStandingStill || isMovingRight) && isBellowMaxSpeed;
-    }
-    else // grounded
-    {
-        const bool isRunning                    = cInput.B;
-        const bool isAtMaxWalkSpeed             = cTransform.velocity.x == GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x == -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
-        const bool isAtMaxRunSpeed              = cTransform.velocity.x == GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED || cTransform.velocity.x == -GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;
-        const bool isWalkingButPastMaxWalkSpeed = (cTransform.velocity.x > GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x < -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED) && !isRunning;
-        const bool isChangingMovementDirection  = (isMovingLeft && (isPressingRight || !isPressingLeft)) || (isMovingRight && (isPressingLeft || !isPressingRight)); // stopping, or turning
-        const bool isSkiddingInPreviousFrame    = cState.isSkidding;
-        
-        isDeceleratingLeft  = (isMovingRight && (isChangingMovementDirection || isWalkingButPastMaxWalkSpeed));
-        isDeceleratingRight = (isMovingLeft && (isChangingMovementDirection || isWalkingButPastMaxWalkSpeed));
-        isAcceleratingLeft  = (isPressingLeft && !isPressingRight) && (isMovingLeft || isStandingStill) && (!isAtMaxWalkSpeed || isRunning) && !isAtMaxRunSpeed && !isWalkingButPastMaxWalkSpeed;
-        isAcceleratingRight = isPressingRight && !isPressingLeft && (isStandingStill || isMovingRight) && (!isAtMaxWalkSpeed || isRunning) && !isAtMaxRunSpeed && !isWalkingButPastMaxWalkSpeed;
-        isSkidding          = ((isMovingRight && isPressingLeft && !isPressingRight) || (isMovingLeft && isPressingRight && !isPressingLeft)) || ((isDeceleratingLeft || isDeceleratingRight) && isSkiddingInPreviousFrame);
-
-        if (isSkidding)
-        {
-            if (isDeceleratingLeft)
-            {
-                newFacingDirection = Direction::LEFT;
-            }
-            else // decelerating right
-            {
-                newFacingDirection = Direction::RIGHT;
-            }
-        }
-        else if (cTransform.velocity.x < 0)
+    PlayerKinematics::updateState(m_player->getComponent<CTransform>(), m_player->getComponent<CInput>(), m_player->getComponent<CState>());
+}
+
+/**
+ * The movement system.
+ */
+void Scene_Play::sMovement()
+{
+    // Handle player movement
+    PlayerKinematics::move(m_player->getComponent<CTransform>(), m_player->getComponent<CInput>(), m_player->getComponent<CState>());
+
+    // Handle enemy movement
+    EnemySystems::moveAll(m_entityManager.getEntities("Enemy"), enemyJobs());
+
+    // Handle animation movement
+    for (auto e : m_entityManager.getEntities("Animation"))
+    {
+        if (!e->hasComponent<CTransform>())
         {
-            newFacingDirection = Direction::LEFT;
+            continue;
         }
-        else if (cTransform.velocity.x > 0)
+
+        CTransform& animationCT = e->getComponent<CTransform>();
+
+        animationCT.velocity.y += animationCT.acc_y;
+
+        if (animationCT.velocity.y > AIRBORNE_VERTICAL_KINEMATICS::MAX_DOWNWARD_SPEED)
         {
-            newFacingDirection = Direction::RIGHT;
+            animationCT.velocity.y = AIRBORNE_VERTICAL_KINEMATICS::MAX_DOWNWARD_SPEED;
         }
-    }
 
-    if (isDeceleratingLeft)
-    {
-        cState.acceleration = Acceleration::DECELERATING_LEFT;
-    }
-    else if (isDeceleratingRight)
-    {
-        cState.acceleration = Acceleration::DECELERATING_RIGHT;
-    }
-    else if (isAcceleratingLeft)
-    {
-        cState.acceleration = Acceleration::ACCELERATING_LEFT;
+        animationCT.pos += animationCT.velocity;
+        animationCT.angle += animationCT.angularVel;
     }
-    else if (isAcceleratingRight)
+
+    // Player fell off the map
+    if (m_player->getComponent<CTransform>().pos.y - 64/2 > m_cameraSize.y)
     {
-        cState.acceleration = Acceleration::ACCELERATING_RIGHT;
+        m_player->destroy();
     }
-    else
+
+    // Player can not move outside of camera
+    if (m_player->getComponent<CTransform>().pos.x - m_player->getComponent<CBoundingBox>().halfSize.x < m_cameraPosition.x)
     {
-        cState.acceleration = Acceleration::ZERO;
+        m_player->getComponent<CTransform>().pos.x = m_player->getComponent<CBoundingBox>().halfSize.x + m_cameraPosition.x;
     }
-
-    cState.isSkidding = isSkidding;
-    cState.facingDir = newFacingDirection;
 }
 
 /**
- * Player airborne movement system.
+ * The enemy state system.
  */
-void Scene_Play::sPlayerAirBorneMovement()
+void Scene_Play::sEnemyState()
 {
-    CTransform& cTransform  = m_player->getComponent<CTransform>();
-    const CInput& cInput    = m_player->getComponent<CInput>();
-    const CState& cState    = m_player->getComponent<CState>();
+    EnemySystems::updateStateAll(m_entityManager.getEntities("Enemy"), m_player->getComponent<CTransform>().pos.x, m_game->assets().getAnimation(m_animations.koopaWalk), enemyJobs());
+}
 
-    const bool isAboveInitialSpeedThresholdForVel = (cState.initialJumpXSpeed <= -AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL || cState.initialJumpXSpeed >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL);
-    const bool isAboveCurrentSpeedThresholdForAcc = (cTransform.velocity.x <= -AIRBORNE_HORIZONTAL_KINEMATICS::CURRENT_SPEED_THRESHOLD_FOR_ACC || cTransform.velocity.x >= AIRBORNE_HORIZONTAL_KINEMATICS::CURRENT_SPEED_THRESHOLD_FOR_ACC);
-    const bool isAboveInitialSpeedThresholdForAcc = (cState.initialJumpXSpeed <= -AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_ACC || cState.initialJumpXSpeed >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_ACC);
+/**
+ * The player collision system.
+ */
+void Scene_Play::sPlayerCollision()
+{
+    BlockHit hits[COLLISION_DIRECTION_COUNT];
+    CTransform & playerCT = m_player->getComponent<CTransform>();
+    const Vec2 playerHalfSize = m_player->getComponent<CBoundingBox>().halfSize;
 
-    // Step 1: Figure out X acceleration for current frame
-    double accelerationX = 0;
-    if (isAboveCurrentSpeedThresholdForAcc)
+    // COLLISION DETECTION for player-block collisions (at most one block in each collision direction)
+    if (m_useTileMap)
     {
-        accelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_CST_ACC;
+        Physics::PickTileMapHits(m_tileMap, playerCT, playerHalfSize, hits);
     }
     else
     {
-        accelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::BELOW_CST_ACC;
-    }
-    double decelerationX = 0;
-    if (isAboveCurrentSpeedThresholdForAcc)
-    {
-        decelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_CST_DEC;
-    }
-    else if (isAboveInitialSpeedThresholdForAcc)
-    {
-        decelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_DEC;
+        for (auto & currentBlock : m_entityManager.getEntities("Tile"))
+        {
+            Physics::PickBlockHit(BlockHit(currentBlock, currentBlock->getComponent<CTile>().flags), playerCT, playerHalfSize, hits);
+        }
     }
-    else
+
+    // Remember picked blocks for the debug overlay
+    for (size_t i = 0; i < COLLISION_DIRECTION_COUNT; i++)
     {
-        decelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::BELOW_IST_DEC;
+        m_playerHitBlocks[i] = hits[i].entity ? hits[i].entity->id() : 0;
     }
 
-    if (cState.acceleration == Acceleration::ACCELERATING_LEFT)
+    // COLLISION RESOLUTION for player-block collisions
+    Physics::ResolveBlockHits(hits, playerHalfSize, playerCT, m_player->getComponent<CInput>(), m_player->getComponent<CState>(), [this](const BlockHit & block)
     {
-        cTransform.acc_x = -accelerationX;
-    }
-    else if (cState.acceleration == Acceleration::ACCELERATING_RIGHT)
+        // Special blocks change when hit
+        if (block.flags & (TILE_QUESTION | TILE_BREAKABLE))
+        {
+            m_collisionEvents.emplace_back(block);
+        }
+    });
+
+    // Player-Goomba CD & CR
+    for (auto enemy : m_entityManager.getEntities("Enemy"))
     {
-        cTransform.acc_x = accelerationX;
-    }
-    else if (cState.acceleration == Acceleration::DECELERATING_LEFT)
-    {
-        cTransform.acc_x = -decelerationX;
-    }
-    else if (cState.acceleration == Acceleration::DECELERATING_RIGHT)
-    {
-        cTransform.acc_x = decelerationX;
-    }
-    else
-    {
-        cTransform.acc_x = 0;
-    }
-
-    // Step 2: Use X acceleration to calculate X velocity
-    cTransform.velocity.x += cTransform.acc_x;
-
-    // Step 3: Apply speed limits or exception for X velocity
-    if (isAboveInitialSpeedThresholdForVel)
-    {
-        if (cTransform.velocity.x > AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL)
-        {
-            cTransform.velocity.x = AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL;
-        }
-        else if (cTransform.velocity.x < -AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL)
-        {
-            cTransform.velocity.x = -AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL;
-        }
-    }
-    else
-    {
-        if (cTransform.velocity.x > AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL)
-        {
-            cTransform.velocity.x = AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL;
-        }
-        else if (cTransform.velocity.x < -AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL)
+        if (!enemy->getComponent<CEnemy>().isActive)
         {
-            cTransform.velocity.x = -AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL;
+            continue;
         }
-    }
-    
-    const bool isPressingJump                         = cInput.A;
-    const bool hadReducedGravity                      = (cTransform.acc_y == AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_S) || (cTransform.acc_y == AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_M);
-    const bool isFalling                              = (cTransform.velocity.y >= 0);
-    const bool isJustStartingNormalGravityPhaseOfJump = hadReducedGravity && (!isPressingJump || isFalling);
 
-    // Step 4: Figure out Y acceleration
-    if (isJustStartingNormalGravityPhaseOfJump)
-    {
-        if (cTransform.acc_y == AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_S)
-        {
-            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_S;
-        }
-        else if (cTransform.acc_y == AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_M)
-        {
-            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_M;
-        }
-        else
+        Vec2 overlap = Physics::GetOverlap(m_player, enemy);
+        if (Physics::IsCollision(overlap))
         {
-            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L;
-        }
-    }
+            CTransform& playerCT = m_player->getComponent<CTransform>();
+            Vec2 prevOverlap = Physics::GetPreviousOverlap(m_player, enemy);
+            bool isStomp = playerCT.velocity.y > 0 && !m_player->getComponent<CState>().isGrounded;
 
-    // Step 5: Use Y acceleration to calculate Y velocity
-    cTransform.velocity.y += cTransform.acc_y;
+            if (isStomp)
+            {
+                playerCT.velocity.y = -ENEMY_KINEMATICS::STOMP_SPEED;
+                playerCT.pos.y -= overlap.y;
+                m_collisionEvents.emplace_back(CollisionEventType::ENEMY_STOMPED, enemy);
 
-    // Step 6: Apply speed limits or exception for Y velocity
-    if (cTransform.velocity.y > AIRBORNE_VERTICAL_KINEMATICS::MAX_DOWNWARD_SPEED)
-    {
-        cTransform.velocity.y = AIRBORNE_VERTICAL_KINEMATICS::RESET_DOWNWARD_SPEED;
+                if (enemy->getComponent<CEnemy>().type == EnemyType::GOOMBA)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                if (enemy->getComponent<CEnemy>().type == EnemyType::KOOPA && enemy->hasComponent<CLifeSpan>()) // koopa in shell and not moving
+                {
+                    // The shell is kicked away from the player
+                    CollisionEvent kick (CollisionEventType::SHELL_KICKED, enemy);
+                    const bool isKickedLeft = enemy->getComponent<CTransform>().pos.x < m_player->getComponent<CTransform>().pos.x;
+                    kick.velocity.x = isKickedLeft ? -ENEMY_KINEMATICS::SHELL_SPEED : ENEMY_KINEMATICS::SHELL_SPEED;
+                    kick.push = isKickedLeft ? -overlap.x : overlap.x;
+                    m_collisionEvents.push_back(kick);
+                    break;
+                }
+                else
+                {
+                    m_collisionEvents.emplace_back(CollisionEventType::PLAYER_KILLED, m_player);
+                    break;
+                }
+            }
+        }
     }
-
-    // Step 7: Use velocity to calculate player position
-    cTransform.prevPos =  cTransform.pos;
-    cTransform.pos += cTransform.velocity;
 }
 
 /**
- * Player grounded movement system.
+ * Returns the job system to update enemies with, or nullptr if enemies are updated serially.
  */
-void Scene_Play::sPlayerGroundedMovement()
+JobSystem * Scene_Play::enemyJobs()
 {
-    CInput& cInput         = m_player->getComponent<CInput>();
-    CTransform& cTransform = m_player->getComponent<CTransform>();
-    CState& cState         = m_player->getComponent<CState>();
-
-    const bool isPressingLeft  = cInput.left;
-    const bool isPressingRight = cInput.right;
-    const bool isRunning       = cInput.B;
-    const bool isWalking       = !cInput.B;
-    const bool isSkidding      = cState.isSkidding;
-    const bool isMovingRight   = cTransform.velocity.x > 0;
-    const bool isMovingLeft    = cTransform.velocity.x < 0;
-
-    // Decelerating: speed is decreasing (going to zero)
-    // Accelerating: speed is increasing (going away from zero)
-    const bool isDeceleratingLeft  = (cState.acceleration == Acceleration::DECELERATING_LEFT);
-    const bool isDeceleratingRight = (cState.acceleration == Acceleration::DECELERATING_RIGHT);
-    const bool isAcceleratingLeft  = (cState.acceleration == Acceleration::ACCELERATING_LEFT);
-    const bool isAcceleratingRight = (cState.acceleration == Acceleration::ACCELERATING_RIGHT);
+    return m_parallelEnemies ? &m_game->jobs() : nullptr;
+}
 
-    // Step 1: Figure out X acceleration for current frame
-    double accelerationX = 0;
-    if (isRunning)
-    {
-        accelerationX = GROUNDED_HORIZONTAL_KINEMATICS::RUN_ACC;
-    }
-    else
-    {
-        accelerationX = GROUNDED_HORIZONTAL_KINEMATICS::WALK_ACC;
-    }
-    double decelerationX = 0;
-    if (isSkidding) 
+/**
+ * The enemy collision system.
+ * 
+ * Enemy-tile collisions are independent per enemy (see EnemySystems), and may run in parallel.
+ * Enemy-enemy collisions couple enemies, and always run serially.
+ */
+void Scene_Play::sEnemyCollision()
+{
+    // Enemy-Tile collisions (detection & resolution)
+    if (m_useTileMap)
     {
-        decelerationX = GROUNDED_HORIZONTAL_KINEMATICS::SKID_DEC;
+        EnemySystems::collideWithTileMapAll(m_entityManager.getEntities("Enemy"), m_tileMap, enemyJobs());
     }
     else
     {
-        decelerationX = GROUNDED_HORIZONTAL_KINEMATICS::RELEASE_DEC;
+        EnemySystems::collideWithTilesAll(m_entityManager.getEntities("Enemy"), m_entityManager.getEntities("Tile"), enemyJobs());
     }
 
-    if (isDeceleratingRight)
-    {
-        cTransform.acc_x = decelerationX;
-    }
-    else if (isDeceleratingLeft)
-    {
-        cTransform.acc_x = -decelerationX;
-    }
-    else if (isAcceleratingRight)
-    {
-        cTransform.acc_x = accelerationX;
-    }
-    else if (isAcceleratingLeft)
+    // Enemy-Enemy collisions (detection, and resolution of enemies bumping into each other)
+    // Kills are queued, so killed enemies are remembered until the queue is applied.
+    EntityVec & enemies = m_entityManager.getEntities("Enemy");
+    std::vector<bool> isKilled (enemies.size(), false);
+    for (size_t i = 0; i < enemies.size(); i++)
     {
-        cTransform.acc_x = -accelerationX;
-    }
-    else
-    {
-        cTransform.acc_x = 0;
-    }
+        const std::shared_ptr<Entity> & enemy1 = enemies[i];
+        if (!enemy1->getComponent<CEnemy>().isActive || !enemy1->isActive() || isKilled[i]) // enemy can't move yet, or was killed
+        {
+            continue;
+        }
 
-    // Step 2: Use X acceleration to calculate X velocity
-    cTransform.velocity.x += cTransform.acc_x;
+        for (size_t j = 0; j < enemies.size(); j++)
+        {
+            const std::shared_ptr<Entity> & enemy2 = enemies[j];
+            if (!enemy2->getComponent<CEnemy>().isActive || enemy1->id() == enemy2->id() || !enemy2->isActive() || isKilled[j]) // enemy can't move yet, was killed, or is same enemy
+            {
+                continue;
+            }
 
-    const bool isPastMaxWalkSpeed      = cTransform.velocity.x > GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x < -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
-    const bool isPastMaxRunSpeed       = cTransform.velocity.x > GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED || cTransform.velocity.x < -GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;
-    const bool isBellowMinWalkSpeed    = cTransform.velocity.x < GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED && cTransform.velocity.x > -GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED;
-    const bool isBellowTurnAroundSpeed = cTransform.velocity.x < GROUNDED_HORIZONTAL_KINEMATICS::SKID_TURNAROUND_SPEED && cTransform.velocity.x > -GROUNDED_HORIZONTAL_KINEMATICS::SKID_TURNAROUND_SPEED;
+            // Note: goombas may have some overlap
+            Vec2 overlap = Physics::GetOverlap(enemy1, enemy2);
+            if (Physics::IsCollision(overlap))
+            {
+                // if enemy1 is MKS and enemy2 is NOT MKS
+                    // what ever it is it gets killed
+                    // continue
+                // if enemy1 is not MKS and enemy2 is MKS
+                    // ?
+                    // 2 options
+                        // kill enemy1 and break
+                // else DO THE FOLLOWING
 
-    // Step 3: Apply speed limits or exception for X velocity
-    // Mario is walking right and past max walk speed
-    if (isPastMaxWalkSpeed && isAcceleratingRight && isWalking)
-    {
-        cTransform.velocity.x = GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
-    }
-    // Mario is walking left and past max walk speed
-    else if (isPastMaxWalkSpeed && isAcceleratingLeft && isWalking)
-    {
-        cTransform.velocity.x = -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
-    }
-    // Mario is running right and past max run speed
-    else if (isPastMaxRunSpeed && isAcceleratingRight && isRunning)
-    {
-        cTransform.velocity.x = GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;   
-    }
-    // Mario is running left and past max run speed
-    else if (isPastMaxRunSpeed && isAcceleratingLeft && isRunning)
-    {
-        cTransform.velocity.x = -GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;   
-    }
-    // Mario is accelerating right and is bellow min x speed
-    else if (isBellowMinWalkSpeed && isAcceleratingRight)
-    {
-        cTransform.velocity.x = GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED;
-    }
-    // Mario is accelerating left and is bellow min x speed
-    else if (isBellowMinWalkSpeed && isAcceleratingLeft)
-    {
-        cTransform.velocity.x = -GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED;
-    }
-    // Mario is decelerating and is bellow min x speed
-    else if ((isBellowMinWalkSpeed || (isBellowTurnAroundSpeed && isSkidding)) && (isDeceleratingLeft || isDeceleratingRight))
-    {
-        cTransform.velocity.x = 0;
-    }
+                // Moving koopa shell (MKS)
+                CTransform& e1CT = enemy1->getComponent<CTransform>();
+                CTransform& e2CT = enemy2->getComponent<CTransform>();
+                const bool isEnemy1MKS = enemy1->getComponent<CEnemy>().type == EnemyType::KOOPA && enemy1->getComponent<CAnimation>().animation.getId() == m_animations.koopaShell && enemy1->getComponent<CTransform>().velocity.x != 0;
+                const bool isEnemy2MKS = enemy2->getComponent<CEnemy>().type == EnemyType::KOOPA && enemy2->getComponent<CAnimation>().animation.getId() == m_animations.koopaShell && enemy2->getComponent<CTransform>().velocity.x != 0;
+
+                if (isEnemy1MKS && !isEnemy2MKS) // enemy1 is MKS and hit and killed enemy2
+                {
+                    // e2 is killed
+                    // turn it into animation
+                        // same place
+                        // same animation
+                        // e1 (MKS) came from right
+                            // throw e2 animation to right
+                            // make it spin clockwise
+                        // else came from left
+                            // throw e2 animation to left
+                            // make it spin counter cc
+                    // remove e2 animation (so it doesn't get rendered)
+                    CollisionEvent kill (CollisionEventType::SHELL_KILL, enemy2);
+                    kill.velocity = Vec2(e1CT.velocity.x * -1, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L);
+                    kill.angularSpeed = e1CT.pos.x < e2CT.pos.x ? -10 : 10; // ccc if MKS came from left, else came from right so cc 
+                    m_collisionEvents.push_back(kill);
+                    isKilled[j] = true;
+                }
+                else if (isEnemy2MKS && !isEnemy1MKS) // enemy2 is MKS and hit and killed enemy1
+                {
+                    CollisionEvent kill (CollisionEventType::SHELL_KILL, enemy1);
+                    kill.velocity = Vec2(e2CT.velocity.x * -1, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L);
+                    kill.angularSpeed = e2CT.pos.x < e1CT.pos.x ? -10 : 10; // ccc if MKS came from left, else came from right so cc 
+                    m_collisionEvents.push_back(kill);
+                    isKilled[i] = true;
+                }
+                else // neither is MKS
+                {
+                    if (e1CT.pos.x <= e2CT.velocity.x)
+                    { 
+                        // Leftmost goomba walks left
+                        e1CT.velocity.x *= (e1CT.velocity.x < 0) ? 1 : -1;
+                        // Rightmost goomba walks right
+                        e2CT.velocity.x *= (e2CT.velocity.x > 0) ? 1 : -1;
 
-    const double xSpeed                  = cTransform.velocity.x;
-    const bool canJump                   = cInput.canJump;
-    const bool isPressingJump            = cInput.A;
-    const bool isAtSmallHorizontalSpeed  = (AIRBORNE_VERTICAL_KINEMATICS::SMALL_SPEED_THRESHOLD > xSpeed) && (-AIRBORNE_VERTICAL_KINEMATICS::SMALL_SPEED_THRESHOLD < xSpeed);
-    const bool isAtMediumHorizontalSpeed = (AIRBORNE_VERTICAL_KINEMATICS::MEDIUM_SPEED_THRESHOLD >= xSpeed) && (-AIRBORNE_VERTICAL_KINEMATICS::MEDIUM_SPEED_THRESHOLD <= xSpeed) && (!isAtSmallHorizontalSpeed);
-    const bool isJustStartingJump        = canJump && isPressingJump;
+                        e1CT.pos.x -= overlap.x/2;
+                        e2CT.pos.x += overlap.x/2;
 
-    // Step 4: Check if player is about to jump
-    if (isJustStartingJump)
-    {
-        if (isAtSmallHorizontalSpeed)
-        {
-            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_S;
-        }
-        else if (isAtMediumHorizontalSpeed)
-        {
-            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_M;
-        }
-        else
-        {
-            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_L;
+                    }
+                    else
+                    {
+                        // Leftmost goomba walks left
+                        e2CT.velocity.x *= (e2CT.velocity.x < 0) ? 1 : -1;
+                        // Rightmost goomba walks right
+                        e1CT.velocity.x *= (e1CT.velocity.x > 0) ? 1 : -1;
+
+                        e1CT.pos.x += overlap.x/2;
+                        e2CT.pos.x -= overlap.x/2;
+                    }
+                }
+            }
         }
     }
+}
 
-    // Step 5: Use Y acceleration to calculate Y velocity
-    cTransform.velocity.y += cTransform.acc_y;
-
-    // Step 6: Apply speed limits or exception for Y velocity
-    if (isJustStartingJump)
+/**
+ * Applies the outcomes of the collisions detected since the last call, in the order they happened.
+ * 
+ * Detection only moves the colliding entities apart. Everything else a collision does (creating,
+ * destroying, and changing entities, and changing the tile map) is queued as an event, and done here.
+ */
+void Scene_Play::sCollisionEvents()
+{
+    for (const CollisionEvent & event : m_collisionEvents)
     {
-        if (isAtSmallHorizontalSpeed)
-        {
-            cTransform.velocity.y = -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_S;
-        }
-        else if (isAtMediumHorizontalSpeed)
-        {
-            cTransform.velocity.y = -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_M;
-        }
-        else
+        const std::shared_ptr<Entity> & e = event.entity;
+
+        switch (event.type)
         {
-            cTransform.velocity.y = -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L;
-        }
+        case CollisionEventType::BLOCK_HIT_FROM_BELOW:
+            hitBlockFromBelow(event.block);
+            break;
 
-        cInput.canJump = false;
-        cState.initialJumpXSpeed = cTransform.velocity.x;
-        cState.isGrounded = false;
+        case CollisionEventType::ENEMY_STOMPED:
+            if (e->getComponent<CEnemy>().type == EnemyType::GOOMBA)
+            {
+                // the goomba becomes a dead goomba animation, at the same location
+                m_entityManager.move(e, "Animation");
+                e->removeComponent<CEnemy>();
+                e->removeComponent<CBoundingBox>();
+                e->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.goombaDead), false);
+                e->addComponent<CTransform>(e->getComponent<CTransform>().pos);
+            }
+            else if (e->hasComponent<CLifeSpan>()) // Koopa is in shell
+            {
+                e->destroy();
+            }
+            else // Koopa
+            {
+                const Vec2 EMPTY_SHELL_BB = Vec2(64,64);
+                e->getComponent<CAnimation>().animation = m_game->assets().getAnimation(m_animations.koopaShell);
+                e->getComponent<CTransform>().velocity.x = 0;
+                e->addComponent<CLifeSpan>(100,0);
+                e->addComponent<CBoundingBox>(EMPTY_SHELL_BB);
+            }
+            break;
+
+        case CollisionEventType::SHELL_KICKED:
+            e->removeComponent<CLifeSpan>();
+            e->getComponent<CTransform>().velocity.x = event.velocity.x;
+            e->getComponent<CTransform>().pos.x += event.push;
+            break;
+
+        case CollisionEventType::SHELL_KILL:
+            // The killed enemy becomes an animation, thrown away from the shell, spinning
+            m_entityManager.move(e, "Animation");
+            e->removeComponent<CEnemy>();
+            e->removeComponent<CBoundingBox>();
+            e->addComponent<CTransform>(e->getComponent<CTransform>().pos, event.velocity, Vec2(1,1), 0, event.angularSpeed, ENEMY_KINEMATICS::GRAVITY);
+            e->addComponent<CLifeSpan>(100, 0);
+            break;
+
+        case CollisionEventType::PLAYER_KILLED:
+            e->destroy();
+            break;
+        }
     }
 
-    // Step 7: Use velocity to calculate player position
-    cTransform.prevPos =  cTransform.pos;
-    cTransform.pos += cTransform.velocity;
+    m_collisionEvents.clear();
 }
 
+
 /**
- * The movement system.
+ * A question block gives a coin, and a brick breaks into pieces.
  */
-void Scene_Play::sMovement()
+void Scene_Play::hitBlockFromBelow(const BlockHit & block)
 {
-    // Handle player movement
-    if (!m_player->getComponent<CState>().isGrounded)
+    if (block.flags & TILE_QUESTION)
     {
-        sPlayerAirBorneMovement();
-    }
-    else
-    {
-        sPlayerGroundedMovement();
-    }
-
-    // Handle enemy movement
-    for (auto e : m_entityManager.getEntities("Enemy"))
-    {
-        // Inactive Goombas can't move
-        if (!e->getComponent<CEnemy>().isActive)
+        if (block.entity)
         {
-            continue;
+            // Stays a Tile, so only its animation and behaviour change
+            block.entity->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.questionMarkBlockHit), true);
+            block.entity->addComponent<CTile>(m_tileMap.getType(m_questionMarkBlockHitTile).flags);
+        }
+        else
+        {
+            m_tileMap.setTile(block.gx, block.gy, m_questionMarkBlockHitTile);
         }
 
-        CTransform& enemyCT = e->getComponent<CTransform>();
-        enemyCT.velocity.y += enemyCT.acc_y;
-        enemyCT.prevPos = enemyCT.pos;
-        enemyCT.pos += enemyCT.velocity;
+        auto coin = m_entityManager.addEntity("Animation");
+        coin->addComponent<CLifeSpan>(50,0);
+        coin->addComponent<CTransform>(Vec2(block.pos.x, block.pos.y - block.halfSize.y * 2 * 1.25));
+        coin->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.coinBlink), true);
     }
-
-    // Handle animation movement
-    for (auto e : m_entityManager.getEntities("Animation"))
+    else if (block.flags & TILE_BREAKABLE)
     {
-        if (!e->hasComponent<CTransform>())
+        if (block.entity)
         {
-            continue;
+            block.entity->destroy();
+        }
+        else
+        {
+            m_tileMap.setTile(block.gx, block.gy, TileMap::EMPTY);
         }
 
-        CTransform& animationCT = e->getComponent<CTransform>();
+        const Vec2 hitBlockPos = block.pos;
+        const Vec2 hitBlockHalfSize = block.halfSize;
 
-        animationCT.velocity.y += animationCT.acc_y;
+        {
+            auto brokenBrickTL = m_entityManager.addEntity("Animation");
+            Vec2 pos (hitBlockPos.x - hitBlockHalfSize.x/2, hitBlockPos.y - hitBlockHalfSize.y/2);
+            Vec2 vel (-GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L * 1.5);
+            Vec2 scale (0.5f, 0.5f);
+            float angle = 45;
+            float angularVel = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L * 4;
+            brokenBrickTL->addComponent<CTransform>(pos, vel, scale, angle, angularVel, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L);
+            brokenBrickTL->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.brokenBrick), false);
+        }
 
-        if (animationCT.velocity.y > AIRBORNE_VERTICAL_KINEMATICS::MAX_DOWNWARD_SPEED)
         {
-            animationCT.velocity.y = AIRBORNE_VERTICAL_KINEMATICS::MAX_DOWNWARD_SPEED;
+            auto brokenBrickTR = m_entityManager.addEntity("Animation");
+            Vec2 pos (hitBlockPos.x + hitBlockHalfSize.x/2, hitBlockPos.y - hitBlockHalfSize.y/2);
+            Vec2 vel (GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L * 1.5);
+            Vec2 scale (0.5f, 0.5f);
+            float angle = -45;
+            float angularVel = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L * 4;
+            brokenBrickTR->addComponent<CTransform>(pos, vel, scale, angle, angularVel, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L);
+            brokenBrickTR->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.brokenBrick), false);
         }
 
-        animationCT.pos += animationCT.velocity;
-        animationCT.angle += animationCT.angularVel;
-    }
+        {
+            auto brokenBrickBL = m_entityManager.addEntity("Animation");
+            Vec2 pos (hitBlockPos.x - hitBlockHalfSize.x/2, hitBlockPos.y + hitBlockHalfSize.y/2);
+            Vec2 vel (-GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED * 1.5, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L);
+            Vec2 scale (0.5f, 0.5f);
+            float angle = 45;
+            float angularVel = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L * 4;
+            brokenBrickBL->addComponent<CTransform>(pos, vel, scale, angle, angularVel, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L);
+            brokenBrickBL->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.brokenBrick), false);
+        }
 
-    // Player fell off the map
-    if (m_player->getComponent<CTransform>().pos.y - 64/2 > m_game->window().getSize().y)
-    {
-        m_player->destroy();
+        {
+            auto brokenBrickBL = m_entityManager.addEntity("Animation");
+            Vec2 pos (hitBlockPos.x + hitBlockHalfSize.x/2, hitBlockPos.y + hitBlockHalfSize.y/2);
+            Vec2 vel (GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED * 1.5, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L);
+            Vec2 scale (0.5f, 0.5f);
+            float angle = -45;
+            float angularVel = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L * 4;
+            brokenBrickBL->addComponent<CTransform>(pos, vel, scale, angle, angularVel, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L);
+            brokenBrickBL->addComponent<CAnimation>(m_game->assets().getAnimation(m_animations.brokenBrick), false);
+        }
     }
+}
 
-    // Player can not move outside of camera
-    if (m_player->getComponent<CTransform>().pos.x - m_player->getComponent<CBoundingBox>().halfSize.x < m_cameraPosition.x)
-    {
-        m_player->getComponent<CTransform>().pos.x = m_player->getComponent<CBoundingBox>().halfSize.x + m_cameraPosition.x;
-    }
+/**
+ * Renders the given entities to the window.
+ * 
+ * If the batched renderer is used, the entities are only queued on the given layer,
+ * and get drawn when the sprite batch is rendered.
+ */
+void Scene_Play::sRenderEntities(EntityVec & entities, RenderLayer layer)
+{
+    sRenderEntities(EntityRange(entities.begin(), entities.end()), layer);
 }
 
 /**
- * The enemy state system.
+ * Renders the given range of entities to the window.
  */
-void Scene_Play::sEnemyState()
+void Scene_Play::sRenderEntities(EntityRange entities, RenderLayer layer)
 {
-    for (auto enemy : m_entityManager.getEntities("Enemy"))
+    sf::RenderWindow & window = m_game->window();
+
+    for (auto it = entities.first; it != entities.second; it++)
     {
-        if (enemy->hasComponent<CLifeSpan>())
+        const std::shared_ptr<Entity> & e = *it;
+
+        if (!e->hasComponent<CAnimation>())
         {
-            enemy->getComponent<CLifeSpan>().lifespan -= 1;
+            continue;
         }
 
-        // Goombas are activated when player comes within a certain range
-        if (enemy->getComponent<CEnemy>().activation_x <= m_player->getComponent<CTransform>().pos.x)
+        if (!isInCamera(e->getComponent<CTransform>().pos, e->getComponent<CAnimation>().animation.getSize()/2)) // Cull entity
         {
-            enemy->getComponent<CEnemy>().isActive = true;
+            continue;
         }
 
-        if (enemy->getComponent<CEnemy>().type == EnemyType::KOOPA)
+        const Vec2 posRelativeToCamera = e->getComponent<CTransform>().pos - m_cameraPosition;
+        const Vec2 scale = e->getComponent<CTransform>().scale;
+        sf::Sprite & sprite = e->getComponent<CAnimation>().animation.getSprite();
+
+        sprite.setPosition(sf::Vector2f(posRelativeToCamera.x,posRelativeToCamera.y));
+        sprite.setScale(sf::Vector2f(scale.x, scale.y));
+        sprite.setRotation(e->getComponent<CTransform>().angle);
+
+        if (m_useSpriteBatch)
         {
-            if (enemy->hasComponent<CLifeSpan>() && enemy->getComponent<CLifeSpan>().lifespan == 0) // Koopa woke up (out of shell)
-            {
-                const Vec2 KOOPA_BB = Vec2(64,92);
-                const Vec2 EMPTY_SHELL_BB = Vec2(64,64);
-                enemy->removeComponent<CLifeSpan>();
-                enemy->getComponent<CAnimation>().animation = m_game->assets().getAnimation("KoopaWalk");
-                enemy->getComponent<CTransform>().velocity.x = enemy->getComponent<CTransform>().scale.x < 0 ? ENEMY_KINEMATICS::KOOPA_SPEED : -ENEMY_KINEMATICS::KOOPA_SPEED;
-                enemy->addComponent<CBoundingBox>(KOOPA_BB);
-                enemy->getComponent<CTransform>().pos.y -= KOOPA_BB.y - EMPTY_SHELL_BB.y;
-            }
+            m_spriteBatch.draw((size_t) layer, sprite);
+        }
+        else
+        {
+            window.draw(sprite);
         }
     }
 }
 
 /**
- * The player collision system.
+ * Renders the visible cells of the tile map.
  */
-void Scene_Play::sPlayerCollision()
+void Scene_Play::sRenderTileMap()
 {
-    // Basic idea behind player-block collisions is that the player only needs to resolve collisions for at most one block in each collision direction.
-    // For example, if the player collides with 2 blocks and both collisions are from the left, then the player really only needs to do
-    // collisions resolution for one since fixing one should also fix the other.
-    // Mario can collide with at most 2 blocks in collisions where mario came from the left, right, top, or bottom relative to the block.
-    // However, mario can only collide with 1 block diagonally at at time.
-
-    std::shared_ptr<Entity> bottomHitBlock = nullptr;
-    std::shared_ptr<Entity> leftHitBlock = nullptr;
-    std::shared_ptr<Entity> rightHitBlock = nullptr;
-    std::shared_ptr<Entity> topHitBlock = nullptr;
-    std::shared_ptr<Entity> topLeftCornerHitBlock = nullptr;
-    std::shared_ptr<Entity> topRightCornerHitBlock = nullptr;
-    std::shared_ptr<Entity> bottomLeftCornerHitBlock = nullptr;
-    std::shared_ptr<Entity> bottomRightCornerHitBlock = nullptr;
-
-    // COLLISION DETECTION for player-block collisions
-    for (auto currentBlock : m_entityManager.getEntities("Tile"))
-    {
-        Vec2 overlap = Physics::GetOverlap(m_player, currentBlock);
-        Vec2 prevOverlap = Physics::GetPreviousOverlap(m_player, currentBlock);
-        // if player collides with block
-        if (Physics::IsCollision(overlap))
-        {
-            // Collision direction is the direction which mario came from relative to block.
-            CollisionDirection collisionDir = Physics::GetCollisionDirection(prevOverlap, m_player->getComponent<CTransform>().prevPos, currentBlock->getComponent<CTransform>().pos);
+    sf::RenderWindow & window = m_game->window();
+    const int firstColumn = std::max((int) std::floor(m_cameraPosition.x / m_gridCellSize.x) - 1, 0);
+    const int lastColumn = std::min((int) std::floor((m_cameraPosition.x + m_cameraSize.x) / m_gridCellSize.x) + 1, m_tileMap.columns() - 1);
 
-            // Mario hit the bottom of the block.
-            if (collisionDir == CollisionDirection::BOTTOM)
-            {
-                if (bottomHitBlock == nullptr || overlap.x > Physics::GetOverlap(m_player, bottomHitBlock).x)
-                {
-                    bottomHitBlock = currentBlock;
-                }
-            }
-            // Mario hit the left side of the block.
-            else if (collisionDir == CollisionDirection::LEFT)
-            {
-                if (leftHitBlock == nullptr || currentBlock->getComponent<CTransform>().pos.y < leftHitBlock->getComponent<CTransform>().pos.y)
-                {
-                    leftHitBlock = currentBlock;
-                }
-            }
-            // Mario hit the right side of the block.
-            else if (collisionDir == CollisionDirection::RIGHT)
-            {
-                if (rightHitBlock == nullptr || currentBlock->getComponent<CTransform>().pos.y < rightHitBlock->getComponent<CTransform>().pos.y)
-                {
-                    rightHitBlock = currentBlock;
-                }
-            }
-            // Mario hit the top of the block.
-            else if (collisionDir == CollisionDirection::TOP)
-            {
-                if (topHitBlock == nullptr || overlap.x > Physics::GetOverlap(m_player, topHitBlock).x)
-                {
-                    topHitBlock = currentBlock;
-                }
-            }
-            // Mario hit the top left corner of the block.
-            else if (collisionDir == CollisionDirection::DIAGONAL_TOP_LEFT)
-            {
-                topLeftCornerHitBlock = currentBlock;
-            }
-            // Mario hit the top right corner of the block.
-            else if (collisionDir == CollisionDirection::DIAGONAL_TOP_RIGHT)
+    for (int gx = firstColumn; gx <= lastColumn; gx++)
+    {
+        for (int gy = 0; gy < m_tileMap.rows(); gy++)
+        {
+            const TileId id = m_tileMap.getTile(gx, gy);
+            if (id == TileMap::EMPTY)
             {
-                topRightCornerHitBlock = currentBlock;
+                continue;
             }
-            // Mario hit the bottom left corner of the block.
-            else if (collisionDir == CollisionDirection::DIAGONAL_BOTTOM_LEFT)
+
+            Animation & animation = m_tileAnimations[id];
+            const Vec2 pos = gridToCartesianRepresentation(Vec2(gx, gy), animation.getSize());
+            if (!isInCamera(pos, animation.getSize()/2)) // Cull tile
             {
-                bottomLeftCornerHitBlock = currentBlock;
+                continue;
             }
-            // Mario hit the bottom right corner of the block.
-            else if (collisionDir == CollisionDirection::DIAGONAL_BOTTOM_RIGHT)
+
+            const Vec2 posRelativeToCamera = pos - m_cameraPosition;
+            sf::Sprite & sprite = animation.getSprite();
+            sprite.setPosition(sf::Vector2f(posRelativeToCamera.x, posRelativeToCamera.y));
+
+            if (m_useSpriteBatch)
             {
-                bottomRightCornerHitBlock = currentBlock;
+                m_spriteBatch.draw((size_t) RenderLayer::TILE, sprite);
             }
             else
             {
-                std::cout << "Error: unsupported collision direction: (int) " << (int) collisionDir << "\n";
+                window.draw(sprite);
             }
         }
     }
+}
 
-    // COLLISION RESOLUTION for player-block collisions
-    if (bottomHitBlock != nullptr)
+/**
+ * Returns true if a box centered at pos overlaps the camera.
+ */
+bool Scene_Play::isInCamera(const Vec2 & pos, const Vec2 & halfSize) const
+{
+    return pos.x + halfSize.x > m_cameraPosition.x
+        && pos.x - halfSize.x < m_cameraPosition.x + m_cameraSize.x
+        && pos.y + halfSize.y > m_cameraPosition.y
+        && pos.y - halfSize.y < m_cameraPosition.y + m_cameraSize.y;
+}
+
+/**
+ * Appends a 1 pixel wide outline, drawn outside of the given box, as 4 quads.
+ */
+static void appendBoxOutline(sf::VertexArray & vertices, float left, float top, float right, float bottom, const sf::Color & color)
+{
+    const float t = 1.f; // outline thickness
+    const float edges[4][4] =
     {
-        Vec2 overlap = Physics::GetOverlap(m_player, bottomHitBlock);
+        { left - t, top - t, right + t, top },        // top
+        { left - t, bottom, right + t, bottom + t },  // bottom
+        { left - t, top, left, bottom },              // left
+        { right, top, right + t, bottom }             // right
+    };
 
-        m_player->getComponent<CTransform>().pos.y += overlap.y;
-        m_player->getComponent<CTransform>().velocity.y = 0;
+    for (const auto & edge : edges)
+    {
+        vertices.append(sf::Vertex(sf::Vector2f(edge[0], edge[1]), color));
+        vertices.append(sf::Vertex(sf::Vector2f(edge[2], edge[1]), color));
+        vertices.append(sf::Vertex(sf::Vector2f(edge[2], edge[3]), color));
+        vertices.append(sf::Vertex(sf::Vector2f(edge[0], edge[3]), color));
+    }
+}
 
-        // Special blocks collision
-        if (bottomHitBlock->getComponent<CAnimation>().animation.getName() == "QuestionMarkBlink")
+/**
+ * Returns the color of an entity's bounding box in the debug overlay.
+ * 
+ * Tiles:   white, or red if it was the bottom hit block, or yellow if it was picked for another collision direction
+ * Enemies: magenta, or gray if not yet active
+ * Player:  green
+ */
+sf::Color Scene_Play::getBoundingBoxColor(const std::shared_ptr<Entity> & e) const
+{
+    if (e->tag() == "Tile")
+    {
+        for (size_t i = 0; i < COLLISION_DIRECTION_COUNT; i++)
         {
-            auto hitQuestionBlock = m_entityManager.addEntity("Tile");
-            hitQuestionBlock->addComponent<CAnimation>(m_game->assets().getAnimation("QuestionMarkBlockHit"), true);
-            hitQuestionBlock->addComponent<CTransform>(bottomHitBlock->getComponent<CTransform>().pos);
-            hitQuestionBlock->addComponent<CBoundingBox>(Vec2(64, 64));
-
-            auto coin = m_entityManager.addEntity("Animation");
-            coin->addComponent<CLifeSpan>(50,0);
-            coin->addComponent<CTransform>(Vec2(bottomHitBlock->getComponent<CTransform>().pos.x, bottomHitBlock->getComponent<CTransform>().pos.y - bottomHitBlock->getComponent<CBoundingBox>().size.y * 1.25));
-            coin->addComponent<CAnimation>(m_game->assets().getAnimation("CoinBlink"), true);
-
-            bottomHitBlock->destroy();
+            if (m_playerHitBlocks[i] == e->id())
+            {
+                return i == (size_t) CollisionDirection::BOTTOM ? sf::Color::Red : sf::Color::Yellow;
+            }
         }
-        else if (bottomHitBlock->getComponent<CAnimation>().animation.getName() == "Brick")
-        {
-            bottomHitBlock->destroy();
+        return sf::Color::White;
+    }
+    else if (e->tag() == "Enemy")
+    {
+        return e->getComponent<CEnemy>().isActive ? sf::Color::Magenta : sf::Color(128, 128, 128);
+    }
+    else if (e->tag() == "Player")
+    {
+        return sf::Color::Green;
+    }
 
-            CTransform& hitBlockCT = bottomHitBlock->getComponent<CTransform>();
-            CBoundingBox hitBlockBB = bottomHitBlock->getComponent<CBoundingBox>();
+    return sf::Color::Cyan;
+}
 
-            {
-                auto brokenBrickTL = m_entityManager.addEntity("Animation");
-                Vec2 pos (hitBlockCT.pos.x - hitBlockBB.halfSize.x/2, hitBlockCT.pos.y - hitBlockBB.halfSize.y/2);
-                Vec2 vel (-GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L * 1.5);
-                Vec2 scale (0.5f, 0.5f);
-                float angle = 45;
-                float angularVel = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L * 4;
-                brokenBrickTL->addComponent<CTransform>(pos, vel, scale, angle, angularVel, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L);
-                brokenBrickTL->addComponent<CAnimation>(m_game->assets().getAnimation("BrokenBrick"), false);
-            }
+/**
+ * Renders bounding boxes for all entities.
+ * 
+ * All visible boxes are drawn with a single draw call, colored by tag and by
+ * the outcome of the last collision pass (see getBoundingBoxColor()).
+ */
+void Scene_Play::sRenderBoundingBoxes()
+{
+    m_boundingBoxVertices.clear();
 
-            {
-                auto brokenBrickTR = m_entityManager.addEntity("Animation");
-                Vec2 pos (hitBlockCT.pos.x + hitBlockBB.halfSize.x/2, hitBlockCT.pos.y - hitBlockBB.halfSize.y/2);
-                Vec2 vel (GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L * 1.5);
-                Vec2 scale (0.5f, 0.5f);
-                float angle = -45;
-                float angularVel = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L * 4;
-                brokenBrickTR->addComponent<CTransform>(pos, vel, scale, angle, angularVel, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L);
-                brokenBrickTR->addComponent<CAnimation>(m_game->assets().getAnimation("BrokenBrick"), false);
-            }
+    // Static tiles come from the index, the few dynamic entities are tested one by one
+    EntityVec & enemies = m_entityManager.getEntities("Enemy");
+    EntityVec & players = m_entityManager.getEntities("Player");
+    const EntityRange ranges[] =
+    {
+        m_tileIndex.query(m_entityManager, m_cameraPosition.x, m_cameraPosition.x + m_cameraSize.x),
+        EntityRange(enemies.begin(), enemies.end()),
+        EntityRange(players.begin(), players.end())
+    };
 
+    for (const EntityRange & range : ranges)
+    {
+        for (auto it = range.first; it != range.second; it++)
+        {
+            const std::shared_ptr<Entity> & e = *it;
+
+            if (!e->hasComponent<CBoundingBox>())
             {
-                auto brokenBrickBL = m_entityManager.addEntity("Animation");
-                Vec2 pos (hitBlockCT.pos.x - hitBlockBB.halfSize.x/2, hitBlockCT.pos.y + hitBlockBB.halfSize.y/2);
-                Vec2 vel (-GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED * 1.5, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L);
-                Vec2 scale (0.5f, 0.5f);
-                float angle = 45;
-                float angularVel = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L * 4;
-                brokenBrickBL->addComponent<CTransform>(pos, vel, scale, angle, angularVel, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L);
-                brokenBrickBL->addComponent<CAnimation>(m_game->assets().getAnimation("BrokenBrick"), false);
+                continue;
             }
 
+            const CBoundingBox & cBoundingBox = e->getComponent<CBoundingBox>();
+            const Vec2 & pos = e->getComponent<CTransform>().pos;
+            if (!isInCamera(pos, cBoundingBox.halfSize)) // Cull entity
             {
-                auto brokenBrickBL = m_entityManager.addEntity("Animation");
-                Vec2 pos (hitBlockCT.pos.x + hitBlockBB.halfSize.x/2, hitBlockCT.pos.y + hitBlockBB.halfSize.y/2);
-                Vec2 vel (GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED * 1.5, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L);
-                Vec2 scale (0.5f, 0.5f);
-                float angle = -45;
-                float angularVel = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L * 4;
-                brokenBrickBL->addComponent<CTransform>(pos, vel, scale, angle, angularVel, AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L);
-                brokenBrickBL->addComponent<CAnimation>(m_game->assets().getAnimation("BrokenBrick"), false);
+                continue;
             }
-        }
-    }
-    if (leftHitBlock != nullptr) 
-    {
-        // TODO: Pull up mechanic for mario
-
-        Vec2 overlap = Physics::GetOverlap(m_player, leftHitBlock);
 
-        if (Physics::IsCollision(overlap))
-        {
-            m_player->getComponent<CTransform>().pos.x -= overlap.x;
+            const Vec2 topLeft = pos - cBoundingBox.halfSize - m_cameraPosition;
+            const Vec2 bottomRight = topLeft + cBoundingBox.size;
+            appendBoxOutline(m_boundingBoxVertices, topLeft.x, topLeft.y, bottomRight.x, bottomRight.y, getBoundingBoxColor(e));
         }
     }
-    if (rightHitBlock != nullptr)
-    {
-        // TODO: Pull up mechanic for mario
 
-        Vec2 overlap = Physics::GetOverlap(m_player, rightHitBlock);
-
-        if (Physics::IsCollision(overlap))
-        {
-            m_player->getComponent<CTransform>().pos.x += overlap.x;
-        }
-    }
-    if (topHitBlock != nullptr)
+    // Solid cells of the tile map
+    if (m_useTileMap)
     {
-        Vec2 overlap = Physics::GetOverlap(m_player, topHitBlock);
+        const int firstColumn = std::max((int) std::floor(m_cameraPosition.x / m_gridCellSize.x), 0);
+        const int lastColumn = std::min((int) std::floor((m_cameraPosition.x + m_cameraSize.x) / m_gridCellSize.x), m_tileMap.columns() - 1);
 
-        if (Physics::IsCollision(overlap))
+        for (int gx = firstColumn; gx <= lastColumn; gx++)
         {
-            m_player->getComponent<CTransform>().pos.y -= overlap.y;
-            m_player->getComponent<CTransform>().velocity.y = 0;
-            m_player->getComponent<CInput>().canJump = true;
-            m_player->getComponent<CState>().isGrounded = true;
+            for (int gy = 0; gy < m_tileMap.rows(); gy++)
+            {
+                if (m_tileMap.getType(m_tileMap.getTile(gx, gy)).flags & TILE_SOLID)
+                {
+                    const Vec2 topLeft = m_tileMap.cellCenter(gx, gy) - m_tileMap.cellHalfSize() - m_cameraPosition;
+                    const Vec2 bottomRight = topLeft + m_gridCellSize;
+                    appendBoxOutline(m_boundingBoxVertices, topLeft.x, topLeft.y, bottomRight.x, bottomRight.y, sf::Color::White);
+                }
+            }
         }
     }
-    if (topLeftCornerHitBlock != nullptr)
-    {
-        Vec2 overlap = Physics::GetOverlap(m_player, topLeftCornerHitBlock);
 
-        if (Physics::IsCollision(overlap))
-        {
-            m_player->getComponent<CTransform>().pos.x -= overlap.x;
-        }
-    }
-    if (topRightCornerHitBlock != nullptr)
-    {
-        Vec2 overlap = Physics::GetOverlap(m_player, topRightCornerHitBlock);
+    m_game->window().draw(m_boundingBoxVertices);
+}
 
-        if (Physics::IsCollision(overlap))
-        {
-            m_player->getComponent<CTransform>().pos.x += overlap.x;
-        }
-    }
-    if (bottomLeftCornerHitBlock != nullptr)
-    {
-        Vec2 overlap = Physics::GetOverlap(m_player, bottomLeftCornerHitBlock);
+/**
+ * Renders debugging grid.
+ */
+void Scene_Play::sRenderDebugGrid()
+{
+    m_debugGrid.render(m_game->window(), m_cameraPosition, m_cameraSize);
+}
 
-        if (Physics::IsCollision(overlap))
-        {
-            m_player->getComponent<CTransform>().pos.x -= overlap.x;
-        }
-    }
-    if (bottomRightCornerHitBlock != nullptr)
+/**
+ * The camera system.
+ * 
+ * The camera follows the player, but never moves backwards.
+ */
+void Scene_Play::sCamera()
+{
+    float newCameraPosX = m_player->getComponent<CTransform>().pos.x - m_cameraSize.x/2;
+    if (newCameraPosX < m_cameraPosition.x)
     {
-        Vec2 overlap = Physics::GetOverlap(m_player, bottomRightCornerHitBlock);
-
-        if (Physics::IsCollision(overlap))
-        {
-            m_player->getComponent<CTransform>().pos.x += overlap.x;
-        }
+        // Camera shouldn't move backwards
+        newCameraPosX = m_cameraPosition.x;
     }
+    m_cameraPosition.x = newCameraPosX;
+}
 
-    // Mario is colliding with NO blocks.
-    if 
-    (
-        bottomHitBlock == nullptr &&
-        leftHitBlock == nullptr &&
-        rightHitBlock == nullptr &&
-        topHitBlock == nullptr &&
-        topLeftCornerHitBlock == nullptr &&
-        topRightCornerHitBlock == nullptr &&
-        bottomLeftCornerHitBlock == nullptr &&
-        bottomRightCornerHitBlock == nullptr &&
-        m_player->getComponent<CState>().isGrounded
-    )
+/**
+ * Level streaming system.
+ * 
+ * Keeps the chunks from one chunk behind the camera, to one camera width ahead of it, as
+ * entities (decoration strips are rendered up to a camera width ahead). The next chunks are
+ * parsed in the background, and chunks left behind are destroyed, along with enemies behind them.
+ */
+void Scene_Play::sStreamLevel()
+{
+    if (!m_streamLevel || !m_levelStream.isOpen())
     {
-        m_player->getComponent<CState>().isGrounded = false;
-        m_player->getComponent<CState>().initialJumpXSpeed = m_player->getComponent<CTransform>().velocity.x;
-        m_player->getComponent<CInput>().canJump = false;
+        return;
     }
 
-    // Player-Goomba CD & CR
-    for (auto enemy : m_entityManager.getEntities("Enemy"))
+    const float chunkWidth = m_levelStream.chunkColumns() * m_gridCellSize.x;
+    const int firstChunk = (int) std::floor(m_cameraPosition.x / chunkWidth) - 1;
+    const int lastChunk = (int) std::floor((m_cameraPosition.x + 2 * m_cameraSize.x) / chunkWidth);
+
+    // Destroy chunks the camera has left behind, and empty their tile map columns
+    while (!m_streamedChunks.empty() && m_streamedChunks.begin()->first < firstChunk)
     {
-        if (!enemy->getComponent<CEnemy>().isActive)
+        for (auto & e : m_streamedChunks.begin()->second)
         {
-            continue;
+            e->destroy();
         }
+        clearChunkTiles(m_streamedChunks.begin()->first);
+        m_loadedChunks.erase(m_streamedChunks.begin()->first);
+        m_streamedChunks.erase(m_streamedChunks.begin());
+    }
 
-        Vec2 overlap = Physics::GetOverlap(m_player, enemy);
-        if (Physics::IsCollision(overlap))
-        {
-            CTransform& playerCT = m_player->getComponent<CTransform>();
-            Vec2 prevOverlap = Physics::GetPreviousOverlap(m_player, enemy);
-            bool isStomp = playerCT.velocity.y > 0 && !m_player->getComponent<CState>().isGrounded;
-
-            if (isStomp)
-            {
-                playerCT.velocity.y = -ENEMY_KINEMATICS::STOMP_SPEED;
-                playerCT.pos.y -= overlap.y;
-
-                if (enemy->getComponent<CEnemy>().type == EnemyType::GOOMBA)
-                {
-                    enemy->destroy();
-                    // create a dead goomba add it to list "Dead Goombas"
-                    // place it a original goombas location
-                    auto stompedGoomba = m_entityManager.addEntity("Animation");
-                    stompedGoomba->addComponent<CAnimation>(m_game->assets().getAnimation("GoombaDead"), false);
-                    stompedGoomba->addComponent<CTransform>(enemy->getComponent<CTransform>().pos);
-                    break;
-                }
-                else // Koopa
-                {
-                    if (enemy->hasComponent<CLifeSpan>()) // Koopa is in shell
-                    {
-                        enemy->destroy();
-                    }
-                    else
-                    {
-                        const Vec2 EMPTY_SHELL_BB = Vec2(64,64);
-                        enemy->getComponent<CAnimation>().animation = m_game->assets().getAnimation("KoopaShell");
-                        enemy->getComponent<CTransform>().velocity.x = 0;
-                        enemy->addComponent<CLifeSpan>(100,0);
-                        enemy->addComponent<CBoundingBox>(EMPTY_SHELL_BB);
-                    }
-                }
-            }
-            else
+    if (firstChunk > 0)
+    {
+        for (auto & enemy : m_entityManager.getEntities("Enemy"))
+        {
+            if (enemy->getComponent<CTransform>().pos.x < firstChunk * chunkWidth)
             {
-                if (enemy->getComponent<CEnemy>().type == EnemyType::KOOPA && enemy->hasComponent<CLifeSpan>()) // koopa in shell and not moving
-                {
-                    enemy->removeComponent<CLifeSpan>();
-                    if (enemy->getComponent<CTransform>().pos.x < m_player->getComponent<CTransform>().pos.x)
-                    {
-                        enemy->getComponent<CTransform>().velocity.x = -ENEMY_KINEMATICS::SHELL_SPEED;
-                        enemy->getComponent<CTransform>().pos.x -= overlap.x;
-                    }
-                    else
-                    {
-                        enemy->getComponent<CTransform>().velocity.x = ENEMY_KINEMATICS::SHELL_SPEED;
-                        enemy->getComponent<CTransform>().pos.x += overlap.x;
-                    }
-                    break;
-                }
-                else
-                {
-                    m_player->destroy();
-                    break;
-                }
+                enemy->destroy();
             }
         }
     }
+
+    // Create the chunks in range (waits for the ones still being parsed)
+    for (int chunk = std::max(firstChunk, 0); chunk <= lastChunk && chunk < m_levelStream.chunkCount(); chunk++)
+    {
+        if (m_streamedChunks.find(chunk) != m_streamedChunks.end())
+        {
+            continue;
+        }
+
+        EntitySpecVec specs;
+        m_levelStream.request(chunk);
+        m_levelStream.take(chunk, specs, true);
+        createChunk(chunk, specs);
+    }
+
+    // Parse the next chunks in the background
+    for (int chunk = lastChunk + 1; chunk <= lastChunk + STREAM_PREFETCH_CHUNKS; chunk++)
+    {
+        m_levelStream.request(chunk);
+    }
 }
 
 /**
- * The enemy collision system.
+ * Level hot reload system.
+ * 
+ * When the level file changes, it is read again, and compared with the entries each chunk was made
+ * from. Chunks that changed are made again: their entities (enemies included) are destroyed, their
+ * tile map columns emptied, and new entities made. Other chunks are left as they are. When streaming,
+ * only the chunks made so far are compared, later chunks are streamed from the new file.
+ * 
+ * Rewind history is dropped, since it has the old level.
  */
-void Scene_Play::sEnemyCollision()
+void Scene_Play::sHotReload()
 {
-    // Enemy-Tile collisions (detection & resolution)
-    for (auto enemy : m_entityManager.getEntities("Enemy"))
+    std::vector<std::string> changedFiles;
+    if (!m_hotReload || !m_levelWatcher.poll(changedFiles))
     {
-        if (!enemy->getComponent<CEnemy>().isActive)
+        return;
+    }
+
+    sf::Clock clock;
+    std::map<int, EntitySpecVec> chunks;
+    if (m_streamLevel)
+    {
+        if (!m_levelStream.open(m_levelPath, m_chunkColumns, &m_game->jobs()))
         {
-            continue;
+            return;
         }
-
-        CTransform& enemyCT = enemy->getComponent<CTransform>(); 
-        for (auto block : m_entityManager.getEntities("Tile"))
+        for (auto & loaded : m_loadedChunks)
+        {
+            m_levelStream.request(loaded.first);
+            m_levelStream.take(loaded.first, chunks[loaded.first], true);
+        }
+    }
+    else
+    {
+        std::ifstream levelSpec (m_levelPath);
+        if (!levelSpec.is_open())
         {
-            CTransform& blockCT = block->getComponent<CTransform>();
+            std::cout << "Error: level specification file could not be open.\n";
+            return;
+        }
 
-            Vec2 overlap = Physics::GetOverlap(enemy, block);
-            Vec2 prevOverlap = Physics::GetPreviousOverlap(enemy, block);
-            if (Physics::IsCollision(overlap))
-            {
-                CollisionDirection locationBlockWasHit = Physics::GetCollisionDirection(prevOverlap, enemyCT.prevPos, blockCT.pos);
+        EntitySpecVec specs;
+        while (LevelStream::readEntry(levelSpec, specs)) {}
+        chunks = splitIntoChunks(specs);
 
-                if (locationBlockWasHit == CollisionDirection::TOP)
-                {
-                    // Push enemy up
-                    enemyCT.pos.y -= overlap.y;
-                    enemyCT.velocity.y = 0;
-                }
-                else if (locationBlockWasHit == CollisionDirection::RIGHT)
-                {
-                    // push enemy right
-                    enemyCT.pos.x += overlap.x;
-                    enemyCT.velocity.x *= -1;
-                }
-                else if (locationBlockWasHit == CollisionDirection::LEFT)
-                {
-                    // push enemy left
-                    enemyCT.pos.x -= overlap.x;
-                    enemyCT.velocity.x *= -1;
-                }
-            }
+        // Chunks that are no longer in the file are emptied
+        for (auto & loaded : m_loadedChunks)
+        {
+            chunks[loaded.first];
         }
     }
 
-    // Enemy-Enemy collisions (detection & resolution)
-    for (auto enemy1 : m_entityManager.getEntities("Enemy"))
+    // Destroy the entities of chunks that changed
+    std::vector<int> changedChunks;
+    std::unordered_set<size_t> destroyedIds;
+    for (auto & chunk : chunks)
     {
-        if (!enemy1->getComponent<CEnemy>().isActive || !enemy1->isActive()) // enemy can't move yet, or was killed
+        auto loaded = m_loadedChunks.find(chunk.first);
+        if (loaded != m_loadedChunks.end() && loaded->second.specs == chunk.second)
         {
             continue;
         }
 
-        for (auto enemy2 : m_entityManager.getEntities("Enemy"))
+        changedChunks.push_back(chunk.first);
+        if (loaded != m_loadedChunks.end())
         {
-            if (!enemy2->getComponent<CEnemy>().isActive || enemy1->id() == enemy2->id() || !enemy2->isActive()) // enemy can't move yet, was killed, or is same enemy
-            {
-                continue;
-            }
-
-            // Note: goombas may have some overlap
-            Vec2 overlap = Physics::GetOverlap(enemy1, enemy2);
-            if (Physics::IsCollision(overlap))
-            {
-                // if enemy1 is MKS and enemy2 is NOT MKS
-                    // what ever it is it gets killed
-                    // continue
-                // if enemy1 is not MKS and enemy2 is MKS
-                    // ?
-                    // 2 options
-                        // kill enemy1 and break
-                // else DO THE FOLLOWING
+            destroyedIds.insert(loaded->second.ids.begin(), loaded->second.ids.end());
+        }
+    }
 
-                // Moving koopa shell (MKS)
-                CTransform& e1CT = enemy1->getComponent<CTransform>();
-                CTransform& e2CT = enemy2->getComponent<CTransform>();
-                const bool isEnemy1MKS = enemy1->getComponent<CEnemy>().type == EnemyType::KOOPA && enemy1->getComponent<CAnimation>().animation.getName() == "KoopaShell" && enemy1->getComponent<CTransform>().velocity.x != 0;
-                const bool isEnemy2MKS = enemy2->getComponent<CEnemy>().type == EnemyType::KOOPA && enemy2->getComponent<CAnimation>().animation.getName() == "KoopaShell" && enemy2->getComponent<CTransform>().velocity.x != 0;
+    if (changedChunks.empty())
+    {
+        return;
+    }
 
-                if (isEnemy1MKS && !isEnemy2MKS) // enemy1 is MKS and hit and killed enemy2
-                {
-                    // e2 is killed
-                    // turn it into animation
-                        // same place
-                        // same animation
-                        // e1 (MKS) came from right
-                            // throw e2 animation to right
-                            // make it spin clockwise
-                        // else came from left
-                            // throw e2 animation to left
-                            // make it spin counter cc
-                    // remove e2 animation (so it doesn't get rendered)
-                    auto e2Animation = m_entityManager.addEntity("Animation");
-                    Vec2 speed = Vec2(e1CT.velocity.x * -1, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L);
-                    float angularSpeed = e1CT.pos.x < e2CT.pos.x ? -10 : 10; // ccc if MKS came from left, else came from right so cc 
-                    e2Animation->addComponent<CTransform>(e2CT.pos, speed, Vec2(1,1), 0, angularSpeed, ENEMY_KINEMATICS::GRAVITY);
-                    e2Animation->addComponent<CAnimation>();
-                    e2Animation->getComponent<CAnimation>().animation = enemy2->getComponent<CAnimation>().animation;
-                    e2Animation->addComponent<CLifeSpan>(100, 0);
-
-                    enemy2->destroy();
-                    enemy2->removeComponent<CAnimation>();
-                }
-                else if (isEnemy2MKS && !isEnemy1MKS) // enemy2 is MKS and hit and killed enemy1
-                {
-                    auto e1Animation = m_entityManager.addEntity("Animation");
-                    Vec2 speed = Vec2(e2CT.velocity.x * -1, -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L);
-                    float angularSpeed = e2CT.pos.x < e1CT.pos.x ? -10 : 10; // ccc if MKS came from left, else came from right so cc 
-                    e1Animation->addComponent<CTransform>(e1CT.pos, speed, Vec2(1,1), 0, angularSpeed, ENEMY_KINEMATICS::GRAVITY);
-                    e1Animation->addComponent<CAnimation>();
-                    e1Animation->getComponent<CAnimation>().animation = enemy1->getComponent<CAnimation>().animation;
-                    e1Animation->addComponent<CLifeSpan>(100, 0);
-
-                    enemy1->destroy();
-                    enemy1->removeComponent<CAnimation>();
-                }
-                else // neither is MKS
-                {
-                    if (e1CT.pos.x <= e2CT.velocity.x)
-                    { 
-                        // Leftmost goomba walks left
-                        e1CT.velocity.x *= (e1CT.velocity.x < 0) ? 1 : -1;
-                        // Rightmost goomba walks right
-                        e2CT.velocity.x *= (e2CT.velocity.x > 0) ? 1 : -1;
+    for (auto & e : m_entityManager.getEntities())
+    {
+        if (destroyedIds.find(e->id()) != destroyedIds.end())
+        {
+            e->destroy();
+        }
+    }
 
-                        e1CT.pos.x -= overlap.x/2;
-                        e2CT.pos.x += overlap.x/2;
+    // Make them again
+    for (int chunk : changedChunks)
+    {
+        clearChunkTiles(chunk);
+        createChunk(chunk, chunks[chunk]);
+    }
 
-                    }
-                    else
-                    {
-                        // Leftmost goomba walks left
-                        e2CT.velocity.x *= (e2CT.velocity.x < 0) ? 1 : -1;
-                        // Rightmost goomba walks right
-                        e1CT.velocity.x *= (e1CT.velocity.x > 0) ? 1 : -1;
+    resetStaticCaches();
+    m_rewindBuffer.clear();
 
-                        e1CT.pos.x += overlap.x/2;
-                        e2CT.pos.x -= overlap.x/2;
-                    }
-                }
-            }
-        }
-    }
+    std::cout << "Hot reload: " << changedChunks.size() << " level chunks (" << destroyedIds.size() << " entities) made again in "
+              << clock.getElapsedTime().asMicroseconds() / 1000.0 << " ms\n";
 }
 
 /**
- * The collision system.
+ * Replaces the hot reloaded animations of entities and tile types, keeping their current frame.
  */
-void Scene_Play::sCollision()
+void Scene_Play::onAssetsChanged(const std::vector<AnimationId>& animations)
 {
-    sPlayerCollision();
-    sEnemyCollision();
+    const Assets & assets = m_game->assets();
+    std::vector<bool> isChanged;
+    for (AnimationId id : animations)
+    {
+        if (id >= isChanged.size())
+        {
+            isChanged.resize(id + 1, false);
+        }
+        isChanged[id] = true;
+    }
+
+    const auto reload = [&assets, &isChanged](Animation & animation)
+    {
+        const AnimationId id = animation.getId();
+        if (id < isChanged.size() && isChanged[id])
+        {
+            const int frame = animation.getCurrentFrame();
+            animation = assets.getAnimation(id);
+            animation.setCurrentFrame(frame);
+        }
+    };
+
+    for (auto & e : m_entityManager.getEntities())
+    {
+        if (e->hasComponent<CAnimation>())
+        {
+            reload(e->getComponent<CAnimation>().animation);
+        }
+    }
+    for (auto & animation : m_tileAnimations)
+    {
+        reload(animation);
+    }
+
+    // The decoration cache has the old images drawn into it
+    resetStaticCaches();
 }
 
 /**
- * Renders the given entities to the window.
+ * Copies the visible entities into a render snapshot.
  */
-void Scene_Play::sRenderEntities(EntityVec & entities)
+void Scene_Play::snapshotEntities(EntityRange entities, RenderLayer layer, RenderSnapshot & snapshot)
 {
-    sf::RenderWindow & window = m_game->window();
-
-    for (auto e : entities)
+    for (auto it = entities.first; it != entities.second; it++)
     {
+        const std::shared_ptr<Entity> & e = *it;
+
         if (!e->hasComponent<CAnimation>())
         {
             continue;
         }
 
-        Vec2 cameraScreenSize = Vec2(m_game->window().getSize().x, m_game->window().getSize().y);
-        Vec2 cameraCenterPos = m_cameraPosition + cameraScreenSize/2; // points to the center of the screen
-
-        const Vec2 overlap = Physics::GetOverLap(cameraCenterPos, e->getComponent<CTransform>().pos, cameraScreenSize/2, e->getComponent<CAnimation>().animation.getSize()/2);
-        if (!Physics::IsCollision(overlap)) // Cull entity
+        const CTransform & cTransform = e->getComponent<CTransform>();
+        Animation & animation = e->getComponent<CAnimation>().animation;
+        if (!isInCamera(cTransform.pos, animation.getSize()/2))
         {
             continue;
         }
 
-        const Vec2 posRelativeToCamera = e->getComponent<CTransform>().pos - m_cameraPosition;
-        const Vec2 scale = e->getComponent<CTransform>().scale;
-        sf::Sprite & sprite = e->getComponent<CAnimation>().animation.getSprite();
-
-        sprite.setPosition(sf::Vector2f(posRelativeToCamera.x,posRelativeToCamera.y));
-        sprite.setScale(sf::Vector2f(scale.x, scale.y));
-        sprite.setRotation(e->getComponent<CTransform>().angle);
-        window.draw(sprite);
+        const sf::Sprite & sprite = animation.getSprite();
+        SpriteInstance instance;
+        instance.texture = sprite.getTexture();
+        instance.textureRect = sprite.getTextureRect();
+        instance.origin = sprite.getOrigin();
+        instance.position = cTransform.pos - m_cameraPosition;
+        instance.scale = cTransform.scale;
+        instance.angle = cTransform.angle;
+        instance.frameIndex = animation.getCurrentAnimationFrameIndex();
+        instance.layer = (size_t) layer;
+        snapshot.sprites.push_back(instance);
     }
 }
 
 /**
- * Renders bounding boxes for all entities.
+ * Copies the visible cells of the tile map into a render snapshot.
  */
-void Scene_Play::sRenderBoundingBoxes()
+void Scene_Play::snapshotTileMap(RenderSnapshot & snapshot)
 {
-    sf::RenderWindow & window = m_game->window();
+    const int firstColumn = std::max((int) std::floor(m_cameraPosition.x / m_gridCellSize.x) - 1, 0);
+    const int lastColumn = std::min((int) std::floor((m_cameraPosition.x + m_cameraSize.x) / m_gridCellSize.x) + 1, m_tileMap.columns() - 1);
 
-    for (auto e : m_entityManager.getEntities())
+    for (int gx = firstColumn; gx <= lastColumn; gx++)
     {
-        // WHAT IF E IS DEAD (INACTIVE)?
-
-        Vec2 cameraScreenSize = Vec2(m_game->window().getSize().x, m_game->window().getSize().y);
-        Vec2 cameraCenterPos = m_cameraPosition + cameraScreenSize/2; // points to the center of the screen
-
-        const Vec2 overlap = Physics::GetOverLap(cameraCenterPos, e->getComponent<CTransform>().pos, cameraScreenSize/2, e->getComponent<CAnimation>().animation.getSize()/2);
-        if (!Physics::IsCollision(overlap)) // Cull entity
+        for (int gy = 0; gy < m_tileMap.rows(); gy++)
         {
-            continue;
-        }
-
-        Vec2 pos = e->getComponent<CTransform>().pos - m_cameraPosition;
-        Vec2 size = e->getComponent<CBoundingBox>().size;
-        sf::RectangleShape bb(sf::Vector2f(size.x,size.y));
+            const TileId id = m_tileMap.getTile(gx, gy);
+            if (id == TileMap::EMPTY)
+            {
+                continue;
+            }
 
-        bb.setPosition(sf::Vector2f(pos.x - size.x/2, pos.y - size.y/2));
-        bb.setFillColor(sf::Color(0,0,0,0));
-        bb.setOutlineColor(sf::Color::White);
-        bb.setOutlineThickness(1.f);
+            Animation & animation = m_tileAnimations[id];
+            const Vec2 pos = gridToCartesianRepresentation(Vec2(gx, gy), animation.getSize());
+            if (!isInCamera(pos, animation.getSize()/2))
+            {
+                continue;
+            }
 
-        window.draw(bb);
+            const sf::Sprite & sprite = animation.getSprite();
+            SpriteInstance instance;
+            instance.texture = sprite.getTexture();
+            instance.textureRect = sprite.getTextureRect();
+            instance.origin = sprite.getOrigin();
+            instance.position = pos - m_cameraPosition;
+            instance.frameIndex = animation.getCurrentAnimationFrameIndex();
+            instance.layer = (size_t) RenderLayer::TILE;
+            snapshot.sprites.push_back(instance);
+        }
     }
 }
 
 /**
- * Renders debugging grid.
+ * Makes a render snapshot of the current frame, for rendering on another thread.
+ * 
+ * Only textures are included, debug overlays are not.
  */
-void Scene_Play::sRenderDebugGrid()
+void Scene_Play::snapshot(RenderSnapshot & snapshot)
 {
-    sf::RenderWindow & window = m_game->window();
-
-    const int heightWindow = window.getSize().y;
-    const int widthWindow = window.getSize().x;
-    const int heightCell = m_gridCellSize.y;
-    const int widthCell = m_gridCellSize.x;
-    const int MAP_WIDTH_BLOCKS = 300;
-
-    const int startingColumn = floor(m_cameraPosition.x/64.f);
-    const int endingColumn = startingColumn + ceil(widthWindow/64.f) + 1; // off by one errors, smh...
-
-    // Draw grid vertical lines
-    const int verticalLines = ceil((float) widthWindow / widthCell);
-    for (int i = startingColumn; i < endingColumn; i++) 
-    {
-        int x = widthCell * (i + 1) - m_cameraPosition.x;
-        sf::VertexArray line(sf::Lines, 2);
-
-        line[0].position = sf::Vector2f(x, 0);
-        line[1].position = sf::Vector2f(x, heightWindow);
-        line[0].color = sf::Color::White;
-        line[1].color = sf::Color::White;
+    const float cameraRight = m_cameraPosition.x + m_cameraSize.x;
+    EntityVec & enemies = m_entityManager.getEntities("Enemy");
+    EntityVec & animations = m_entityManager.getEntities("Animation");
+    EntityVec & players = m_entityManager.getEntities("Player");
+
+    snapshot.sprites.clear();
+    snapshot.clearColor = SKY_COLOR;
+    snapshot.frame = m_currentFrame;
+
+    // Rendering order
+    snapshotEntities(m_decorationIndex.query(m_entityManager, m_cameraPosition.x, cameraRight), RenderLayer::DECORATION, snapshot);
+    if (m_useTileMap)
+    {
+        snapshotTileMap(snapshot);
+    }
+    snapshotEntities(m_renderTileIndex.query(m_entityManager, m_cameraPosition.x, cameraRight), RenderLayer::TILE, snapshot);
+    snapshotEntities(m_tileIndex.query(m_entityManager, m_cameraPosition.x, cameraRight), RenderLayer::TILE, snapshot);
+    snapshotEntities(EntityRange(enemies.begin(), enemies.end()), RenderLayer::ENEMY, snapshot);
+    snapshotEntities(EntityRange(animations.begin(), animations.end()), RenderLayer::ANIMATION, snapshot);
+    snapshotEntities(EntityRange(players.begin(), players.end()), RenderLayer::PLAYER, snapshot);
+}
 
-        window.draw(line);
-    }
+/**
+ * Texture residency system.
+ * 
+ * Marks the textures of everything in the camera as used, which loads the ones that were evicted,
+ * and prefetches the textures of what is up to a camera width ahead of it (with LevelStreaming, the
+ * chunks made ahead of the camera). Then evicts the least recently used textures over the budget.
+ */
+void Scene_Play::sTextureResidency(TextureResidency& textures)
+{
+    textures.beginFrame();
 
-    // Draw grid horizontal lines
-    const int horizontalLines = ceil((float) heightWindow / heightCell);
-    for (int i = 0; i < horizontalLines; i++)
+    const float right = m_cameraPosition.x + m_cameraSize.x;
+    const float ahead = right + m_cameraSize.x;
+    const auto visit = [this, &textures, right, ahead](const sf::Texture * texture, const Vec2 & pos, const Vec2 & size)
     {
-        int y = heightWindow - heightCell * (i + 1);
-        sf::VertexArray line(sf::Lines, 2);
-
-        line[0].position = sf::Vector2f(0, y);
-        line[1].position = sf::Vector2f(widthWindow, y);
-        line[0].color = sf::Color::White;
-        line[1].color = sf::Color::White;
-
-        window.draw(line);
-    }
+        if (pos.x + size.x / 2 < m_cameraPosition.x || pos.x - size.x / 2 > ahead)
+        {
+            return;
+        }
 
-    // Draw grid coordinates
-    for (int gx = startingColumn; gx < endingColumn; gx++)
+        if (pos.x - size.x / 2 <= right)
+        {
+            textures.use(texture);
+        }
+        else
+        {
+            textures.prefetch(texture);
+        }
+    };
+    const auto visitEntities = [&visit](EntityRange entities)
     {
-        for (int gy = 0; gy < horizontalLines; gy++)
+        for (auto it = entities.first; it != entities.second; it++)
         {
-            std::ostringstream oss;
-            oss << "(" << gx << "," << gy << ")";
-            m_gridText.setString(oss.str());
-
-            // relative to top left of window
-            int x = widthCell * gx - m_cameraPosition.x;
-            int y = heightWindow - (heightCell * (gy + 1));
-            m_gridText.setPosition(sf::Vector2f(x, y));
-            
-            window.draw(m_gridText);
+            if ((*it)->hasComponent<CAnimation>())
+            {
+                Animation & animation = (*it)->getComponent<CAnimation>().animation;
+                visit(animation.getSprite().getTexture(), (*it)->getComponent<CTransform>().pos, animation.getSize());
+            }
+        }
+    };
+
+    EntityVec & enemies = m_entityManager.getEntities("Enemy");
+    EntityVec & animations = m_entityManager.getEntities("Animation");
+    EntityVec & players = m_entityManager.getEntities("Player");
+    visitEntities(m_decorationIndex.query(m_entityManager, m_cameraPosition.x, ahead));
+    visitEntities(m_renderTileIndex.query(m_entityManager, m_cameraPosition.x, ahead));
+    visitEntities(m_tileIndex.query(m_entityManager, m_cameraPosition.x, ahead));
+    visitEntities(EntityRange(enemies.begin(), enemies.end()));
+    visitEntities(EntityRange(animations.begin(), animations.end()));
+    visitEntities(EntityRange(players.begin(), players.end()));
+
+    if (m_useTileMap)
+    {
+        const int firstColumn = std::max((int) std::floor(m_cameraPosition.x / m_gridCellSize.x) - 1, 0);
+        const int lastColumn = std::min((int) std::floor(ahead / m_gridCellSize.x) + 1, m_tileMap.columns() - 1);
+        for (int gx = firstColumn; gx <= lastColumn; gx++)
+        {
+            for (int gy = 0; gy < m_tileMap.rows(); gy++)
+            {
+                const TileId id = m_tileMap.getTile(gx, gy);
+                if (!(id == TileMap::EMPTY))
+                {
+                    Animation & animation = m_tileAnimations[id];
+                    visit(animation.getSprite().getTexture(), gridToCartesianRepresentation(Vec2(gx, gy), animation.getSize()), animation.getSize());
+                }
+            }
         }
     }
+
+    textures.trim();
 }
 
 /**
@@ -1514,25 +1747,46 @@ void Scene_Play::sRenderDebugGrid()
 void Scene_Play::sRender()
 {
     sf::RenderWindow & window = m_game->window();
-    window.clear(sf::Color(97, 126, 248)); 
-    
-    // Update camera position
-    float newCameraPosX = m_player->getComponent<CTransform>().pos.x - window.getSize().x/2;
-    if (newCameraPosX < m_cameraPosition.x)
+    window.clear(SKY_COLOR); 
+
+    if (m_game->textureResidency() != nullptr)
     {
-        // Camera shouldn't move backwards
-        newCameraPosX = m_cameraPosition.x;
+        sTextureResidency(*m_game->textureResidency());
     }
-    m_cameraPosition.x = newCameraPosX;
+
+    const float cameraRight = m_cameraPosition.x + m_cameraSize.x;
 
     if (m_drawTextures)
     {
+        if (m_useSpriteBatch)
+        {
+            m_spriteBatch.clear();
+        }
+
         // Rendering order
-        sRenderEntities(m_entityManager.getEntities("Decoration"));
-        sRenderEntities(m_entityManager.getEntities("Tile"));
-        sRenderEntities(m_entityManager.getEntities("Enemy"));
-        sRenderEntities(m_entityManager.getEntities("Animation"));
-        sRenderEntities(m_entityManager.getEntities("Player"));
+        if (m_useDecorationCache)
+        {
+            // Drawn now, so it ends up behind everything queued on the sprite batch
+            m_decorationCache.render(window, m_entityManager, m_cameraPosition, m_cameraSize);
+        }
+        else
+        {
+            sRenderEntities(m_decorationIndex.query(m_entityManager, m_cameraPosition.x, cameraRight), RenderLayer::DECORATION);
+        }
+        if (m_useTileMap)
+        {
+            sRenderTileMap();
+        }
+        sRenderEntities(m_renderTileIndex.query(m_entityManager, m_cameraPosition.x, cameraRight), RenderLayer::TILE);
+        sRenderEntities(m_tileIndex.query(m_entityManager, m_cameraPosition.x, cameraRight), RenderLayer::TILE);
+        sRenderEntities(m_entityManager.getEntities("Enemy"), RenderLayer::ENEMY);
+        sRenderEntities(m_entityManager.getEntities("Animation"), RenderLayer::ANIMATION);
+        sRenderEntities(m_entityManager.getEntities("Player"), RenderLayer::PLAYER);
+
+        if (m_useSpriteBatch)
+        {
+            m_spriteBatch.render(window);
+        }
     }
     if (m_drawCollision)
     {
@@ -1554,60 +1808,75 @@ void Scene_Play::sRender()
  */
 void Scene_Play::sDoAction(const Action & action)
 {
-    // Toggle Actions
-    if (action.type() == "START")
+    const bool isStart = action.type() == ActionType::START;
+    CInput & cInput = m_player->getComponent<CInput>();
+
+    // A dense switch, so actions are dispatched with a jump table
+    switch (action.id())
     {
-        if (action.name() == "TOGGLE_GRID")
+    // Toggle Actions
+    case ActionId::TOGGLE_GRID:
+        if (isStart)
         {
             m_drawGrid = !m_drawGrid;
-            return;
         }
-        else if (action.name() == "TOGGLE_BOUNDING_BOXES")
+        break;
+    case ActionId::TOGGLE_BOUNDING_BOXES:
+        if (isStart)
         {
             m_drawCollision = !m_drawCollision;
-            return;
         }
-
-        else if (action.name() == "TOGGLE_TEXTURES")
+        break;
+    case ActionId::TOGGLE_TEXTURES:
+        if (isStart)
         {
             m_drawTextures = !m_drawTextures;
-            return;
         }
-    }
-
-    bool newState;
-    if (action.type() == "START") // START
-    {
-        newState = true;
-    }
-    else // END
-    {
-        newState = false;
-    }
+        break;
 
-    if (action.name() == "UP")
-    {
-        m_player->getComponent<CInput>().up = newState;
-    }
-    else if (action.name() == "DOWN")
-    {
-        m_player->getComponent<CInput>().down = newState;
-    }
-    else if (action.name() == "LEFT")
-    {
-        m_player->getComponent<CInput>().left = newState;
-    }
-    else if (action.name() == "RIGHT")
-    {
-        m_player->getComponent<CInput>().right = newState;
-    }
-    else if (action.name() == "RUN")
-    {
-        m_player->getComponent<CInput>().B = newState;
-    }
-    else if (action.name() == "JUMP")
-    {
-        m_player->getComponent<CInput>().A = newState;
+    // Save states
+    case ActionId::REWIND:
+        if (isStart)
+        {
+            rewind(REWIND_FRAMES);
+        }
+        break;
+    case ActionId::SAVE_STATE:
+        if (isStart)
+        {
+            saveState();
+        }
+        break;
+    case ActionId::LOAD_STATE:
+        if (isStart)
+        {
+            loadState();
+        }
+        break;
+
+    // Player input, held while the key is down
+    case ActionId::UP:
+        cInput.up = isStart;
+        break;
+    case ActionId::DOWN:
+        cInput.down = isStart;
+        break;
+    case ActionId::LEFT:
+        cInput.left = isStart;
+        break;
+    case ActionId::RIGHT:
+        cInput.right = isStart;
+        break;
+    case ActionId::RUN:
+        cInput.B = isStart;
+        break;
+    case ActionId::JUMP:
+        cInput.A = isStart;
+        break;
+
+    case ActionId::NONE:
+    case ActionId::COUNT:
+        break;
     }
 }
 
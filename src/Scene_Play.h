@@ -4,11 +4,62 @@
 #include "Action.h"
 #include "Entity.h"
 #include "Vec2.h"
+#include "SpriteBatch.h"
+#include "StaticEntityIndex.h"
+#include "DecorationCache.h"
+#include "DebugGrid.h"
+#include "Physics.h"
+#include "JobSystem.h"
+#include "LevelStream.h"
+#include "TileMap.h"
+#include "LevelOptimizer.h"
+#include "SystemScheduler.h"
+#include "RewindBuffer.h"
+#include "FileWatcher.h"
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
+
+// Rendering order, from back to front
+enum class RenderLayer
+{
+    DECORATION, TILE, ENEMY, ANIMATION, PLAYER, COUNT
+};
 
 class Scene_Play : public Scene {
 private:
+    // What a collision does to the world, applied by sCollisionEvents() after detection
+    enum class CollisionEventType
+    {
+        BLOCK_HIT_FROM_BELOW, ENEMY_STOMPED, SHELL_KICKED, SHELL_KILL, PLAYER_KILLED
+    };
+
+    struct CollisionEvent
+    {
+        CollisionEventType type;
+        std::shared_ptr<Entity> entity; // the enemy, or the player
+        BlockHit block;                 // BLOCK_HIT_FROM_BELOW
+        Vec2 velocity;                  // SHELL_KICKED (x only), SHELL_KILL
+        float push = 0;                 // SHELL_KICKED, x distance that moves the shell out of the player
+        float angularSpeed = 0;         // SHELL_KILL
+
+        CollisionEvent(CollisionEventType type, const std::shared_ptr<Entity>& entity)
+            : type(type), entity(entity) {}
+        CollisionEvent(const BlockHit& block)
+            : type(CollisionEventType::BLOCK_HIT_FROM_BELOW), block(block) {}
+    };
+
+    // Ids of the animations used by game logic, looked up once in init()
+    struct AnimationIds
+    {
+        AnimationId marioStand, marioWalk, marioRun, marioSkid, marioAir;
+        AnimationId goombaWalk, goombaDead, koopaWalk, koopaShell;
+        AnimationId questionMarkBlockHit, coinBlink, brokenBrick;
+    };
+    AnimationIds m_animations;
+    TileId m_questionMarkBlockHitTile = TileMap::EMPTY;
+
     std::shared_ptr<Entity> m_player;
     
     // Path to level specification file
@@ -18,53 +69,122 @@ private:
     bool m_drawTextures = true;
     bool m_drawCollision = false;
     bool m_drawGrid = false;
+    bool m_useSpriteBatch = false; // Batched renderer instead of one draw call per entity
+    SpriteBatch m_spriteBatch { (size_t) RenderLayer::COUNT };
+    bool m_useDecorationCache = false; // Draw decorations from pre-rendered strips
+    DecorationCache m_decorationCache;
+    bool m_parallelEnemies = false; // Run the per-enemy phases on the job system
     
     // Grid and camera settings
     const Vec2 m_gridCellSize = { 64.f, 64.f };
-    sf::Text m_gridText;
+    DebugGrid m_debugGrid;
+    sf::VertexArray m_boundingBoxVertices { sf::Quads };
+    size_t m_playerHitBlocks[COLLISION_DIRECTION_COUNT] = {}; // Ids of blocks picked by the last player collision pass, by direction (0 if none)
     Vec2 m_cameraPosition = { 0.f, 0.f }; // Top left corner of the camera
+    Vec2 m_cameraSize = { 0.f, 0.f };
+
+    // Level streaming (chunks of columns are created ahead of the camera, and destroyed behind it)
+    bool m_streamLevel = false;
+    LevelStream m_levelStream;
+    std::map<int, EntityVec> m_streamedChunks; // chunk -> its tiles and decorations
+    int m_chunkColumns = 16;
+
+    // Hot reload (chunks whose entries change in the level file are made again)
+    struct LoadedChunk
+    {
+        EntitySpecVec       specs; // as read from the file
+        std::vector<size_t> ids;   // of the entities made from them, enemies included
+    };
+    bool m_hotReload = false;
+    FileWatcher m_levelWatcher;
+    std::map<int, LoadedChunk> m_loadedChunks;
+
+    // Tile map (static tiles stored per grid cell, instead of as Tile entities)
+    bool m_useTileMap = false;
+    TileMap m_tileMap;
+    std::vector<Animation> m_tileAnimations; // tile id -> animation, shared by all tiles of the type
+
+    // Tiles and decorations never move, so they are culled with sorted indexes
+    StaticEntityIndex m_decorationIndex { "Decoration" };
+    StaticEntityIndex m_tileIndex { "Tile" };
+    StaticEntityIndex m_renderTileIndex { "RenderTile" };
+
+    bool m_optimizeLevel = false; // Run the LevelOptimizer on loaded tiles
+
+    std::vector<CollisionEvent> m_collisionEvents; // queued by collision detection, in the order they happened
+
+    SystemScheduler m_systems;
+
+    // Save states, and rewinding (every frame is recorded, when enabled)
+    RewindBuffer m_rewindBuffer;
 
     // Initialization functions
     void init();
+    void registerSystems();
     void loadLevel();
-    void createStaticEntity(const std::string& type, const std::string& animation, float gx, float gy);
-    void createEnemyEntity(const std::string& type, float gx, float gy, float activationDistance);
+    void createChunk(int chunk, const EntitySpecVec& specs);
+    void clearChunkTiles(int chunk);
+    std::map<int, EntitySpecVec> splitIntoChunks(const EntitySpecVec& specs) const;
+    std::shared_ptr<Entity> createEntity(const EntitySpec& spec);
+    std::shared_ptr<Entity> createStaticEntity(const std::string& type, const std::string& animation, float gx, float gy);
+    std::shared_ptr<Entity> createEnemyEntity(const std::string& type, float gx, float gy, float activationDistance);
+    std::shared_ptr<Entity> createColliderEntity(float gx, float gy, int width);
+    TileId getTileId(const std::string& animation);
+    static uint8_t getTileFlags(const std::string& animation);
     void spawnPlayer();
     void spawnBullet(std::shared_ptr<Entity> entity);
 
     // Utility functions
     Vec2 gridToCartesianRepresentation(float gridX, float gridY, std::shared_ptr<Entity> entity);
     Vec2 gridToCartesianRepresentation(Vec2 gridPos, Vec2 entitySize);
+    bool isInCamera(const Vec2& pos, const Vec2& halfSize) const;
     
     void reloadLevel();
+    void resetStaticCaches();
+    World world();
+    void rewind(size_t frames);
+    void saveState();
+    void loadState();
 
     // Player-related systems
-    void sPlayerAirBorneMovement();
-    void sPlayerGroundedMovement();
     void sPlayerState();
     void sPlayerAnimation();
     void sPlayerCollision();
     
     // Enemy-related systems
     void sEnemyCollision();
+    void sCollisionEvents();
+    void hitBlockFromBelow(const BlockHit& block);
+    JobSystem* enemyJobs();
 
     // Rendering systems
-    void sRenderEntities(EntityVec& entities);
+    void sRenderEntities(EntityVec& entities, RenderLayer layer);
+    void sRenderEntities(EntityRange entities, RenderLayer layer);
+    void sRenderTileMap();
     void sRenderBoundingBoxes();
+    sf::Color getBoundingBoxColor(const std::shared_ptr<Entity>& e) const;
     void sRenderDebugGrid();
 
     // General systems
     void sAnimation();
     void sMovement();
     void sEnemyState();
-    void sCollision();
+    void sCamera();
+    void sStreamLevel();
+    void sHotReload();
     void sRender();
+    void sTextureResidency(TextureResidency& textures);
     void sDebug();
+    void snapshotEntities(EntityRange entities, RenderLayer layer, RenderSnapshot& snapshot);
+    void snapshotTileMap(RenderSnapshot& snapshot);
 
 public:
     Scene_Play(GameEngine* gameEngine, const std::string& levelPath);
 
     void update();
+    void step();
+    void snapshot(RenderSnapshot& snapshot);
     void sDoAction(const Action& action);
+    void onAssetsChanged(const std::vector<AnimationId>& animations);
     void onEnd();
 };
@@ -0,0 +1,138 @@
+#include "Settings.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+Settings::Settings()
+{
+}
+
+/**
+ * Loads settings from the given file.
+ * 
+ * One setting per line, given as a name followed by a value.
+ * Empty lines, and lines starting with # are ignored.
+ */
+void Settings::loadFromFile(const std::string & path)
+{
+    std::ifstream file (path);
+
+    if (!file.is_open())
+    {
+        std::cout << "Error: could not open settings file, using defaults.\n";
+        return;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream iss (line);
+        std::string name;
+        std::string value;
+
+        if (!(iss >> name) || name[0] == '#')
+        {
+            continue;
+        }
+
+        if (!(iss >> value))
+        {
+            std::cout << "Error: setting " << name << " has no value.\n";
+            continue;
+        }
+
+        m_values[name] = value;
+    }
+}
+
+void Settings::set(const std::string & name, const std::string & value)
+{
+    m_values[name] = value;
+}
+
+bool Settings::has(const std::string & name) const
+{
+    return m_values.find(name) != m_values.end();
+}
+
+std::string Settings::getString(const std::string & name, const std::string & defaultValue) const
+{
+    auto it = m_values.find(name);
+    return it == m_values.end() ? defaultValue : it->second;
+}
+
+/**
+ * A value that is not a whole number prints an error, and uses the default value.
+ */
+int Settings::getInt(const std::string & name, int defaultValue) const
+{
+    auto it = m_values.find(name);
+    if (it == m_values.end())
+    {
+        return defaultValue;
+    }
+
+    std::istringstream iss (it->second);
+    int value;
+    if (!(iss >> value) || !(iss >> std::ws).eof())
+    {
+        std::cout << "Error: setting " << name << " is not a whole number, using " << defaultValue << ".\n";
+        return defaultValue;
+    }
+    return value;
+}
+
+/**
+ * A value that is not a number prints an error, and uses the default value.
+ */
+float Settings::getFloat(const std::string & name, float defaultValue) const
+{
+    auto it = m_values.find(name);
+    if (it == m_values.end())
+    {
+        return defaultValue;
+    }
+
+    std::istringstream iss (it->second);
+    float value;
+    if (!(iss >> value) || !(iss >> std::ws).eof())
+    {
+        std::cout << "Error: setting " << name << " is not a number, using " << defaultValue << ".\n";
+        return defaultValue;
+    }
+    return value;
+}
+
+/**
+ * Booleans can be given as 1/0, true/false, or on/off.
+ */
+bool Settings::getBool(const std::string & name, bool defaultValue) const
+{
+    auto it = m_values.find(name);
+    if (it == m_values.end())
+    {
+        return defaultValue;
+    }
+
+    const std::string & value = it->second;
+    return value == "1" || value == "true" || value == "on";
+}
+
+/**
+ * Returns all settings whose name starts with the given prefix, keyed by the rest of the name.
+ * 
+ * Example:
+ * With the settings "Parallax.BigMountain 0.5" and "Parallax.CloudMiddleTop 0.75",
+ * getGroup("Parallax.") returns { "BigMountain": "0.5", "CloudMiddleTop": "0.75" }.
+ */
+std::map<std::string, std::string> Settings::getGroup(const std::string & prefix) const
+{
+    std::map<std::string, std::string> group;
+
+    for (auto it = m_values.lower_bound(prefix); it != m_values.end() && it->first.compare(0, prefix.size(), prefix) == 0; it++)
+    {
+        group[it->first.substr(prefix.size())] = it->second;
+    }
+
+    return group;
+}
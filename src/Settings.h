@@ -0,0 +1,28 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+/**
+ * Engine settings read once at startup.
+ * 
+ * Settings are used to pick between alternative code paths (e.g. renderers)
+ * without recompiling, so that they can be compared against each other.
+ */
+class Settings
+{
+private:
+    std::map<std::string, std::string> m_values;
+public:
+    Settings();
+
+    void loadFromFile(const std::string & path);
+    void set(const std::string & name, const std::string & value);
+
+    bool has(const std::string & name) const;
+    std::string getString(const std::string & name, const std::string & defaultValue) const;
+    int getInt(const std::string & name, int defaultValue) const;
+    float getFloat(const std::string & name, float defaultValue) const;
+    bool getBool(const std::string & name, bool defaultValue) const;
+    std::map<std::string, std::string> getGroup(const std::string & prefix) const;
+};
@@ -0,0 +1,108 @@
+#include "SpriteBatch.h"
+#include <cmath>
+
+SpriteBatch::SpriteBatch(size_t layerCount)
+    : m_layers(layerCount)
+{
+}
+
+/**
+ * Returns the batch for the given layer and texture, creating it (and the layer) if needed.
+ * 
+ * A layer only has a handful of textures, so a linear search is fine.
+ */
+SpriteBatch::Batch & SpriteBatch::getBatch(size_t layer, const sf::Texture * texture)
+{
+    if (layer >= m_layers.size())
+    {
+        m_layers.resize(layer + 1);
+    }
+
+    std::vector<Batch> & batches = m_layers[layer];
+    for (Batch & batch : batches)
+    {
+        if (batch.texture == texture)
+        {
+            return batch;
+        }
+    }
+
+    batches.emplace_back();
+    batches.back().texture = texture;
+    return batches.back();
+}
+
+/**
+ * Removes all queued quads.
+ * 
+ * Batches are kept around (and keep their capacity), so after the first few frames
+ * no memory is allocated.
+ */
+void SpriteBatch::clear()
+{
+    for (auto & batches : m_layers)
+    {
+        for (Batch & batch : batches)
+        {
+            batch.vertices.clear();
+        }
+    }
+}
+
+/**
+ * Queues the sprite as it currently is (texture, texture rect, and transform).
+ */
+void SpriteBatch::draw(size_t layer, const sf::Sprite & sprite)
+{
+    draw(layer, sprite.getTexture(), sprite.getTextureRect(), sprite.getTransform());
+}
+
+/**
+ * Queues a quad showing the texture rect, transformed by the given transform.
+ */
+void SpriteBatch::draw(size_t layer, const sf::Texture * texture, const sf::IntRect & textureRect, const sf::Transform & transform)
+{
+    Batch & batch = getBatch(layer, texture);
+
+    const float width = std::abs((float) textureRect.width);
+    const float height = std::abs((float) textureRect.height);
+    const float left = textureRect.left;
+    const float right = left + textureRect.width;
+    const float top = textureRect.top;
+    const float bottom = top + textureRect.height;
+
+    batch.vertices.append(sf::Vertex(transform.transformPoint(0, 0), sf::Vector2f(left, top)));
+    batch.vertices.append(sf::Vertex(transform.transformPoint(width, 0), sf::Vector2f(right, top)));
+    batch.vertices.append(sf::Vertex(transform.transformPoint(width, height), sf::Vector2f(right, bottom)));
+    batch.vertices.append(sf::Vertex(transform.transformPoint(0, height), sf::Vector2f(left, bottom)));
+}
+
+/**
+ * Draws all queued quads, one draw call per non-empty (layer, texture) batch.
+ */
+void SpriteBatch::render(sf::RenderTarget & target)
+{
+    m_drawCalls = 0;
+
+    for (auto & batches : m_layers)
+    {
+        for (Batch & batch : batches)
+        {
+            if (batch.vertices.getVertexCount() == 0)
+            {
+                continue;
+            }
+
+            target.draw(batch.vertices, sf::RenderStates(batch.texture));
+            m_drawCalls++;
+        }
+    }
+}
+
+/**
+ * Returns the number of draw calls made by the last render.
+ */
+size_t SpriteBatch::drawCalls() const
+{
+    return m_drawCalls;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+/**
+ * Collects textured quads for a frame and submits them with as few draw calls as possible.
+ * 
+ * Quads are grouped by layer, and inside a layer by texture. Layers are drawn in
+ * increasing order, so a layer is always drawn on top of the layers before it.
+ * Sprite transforms (position, origin, scale, rotation) are applied on the CPU.
+ */
+class SpriteBatch
+{
+private:
+    struct Batch
+    {
+        const sf::Texture * texture = nullptr;
+        sf::VertexArray vertices { sf::Quads };
+    };
+
+    std::vector<std::vector<Batch>> m_layers;
+    size_t m_drawCalls = 0;
+
+    Batch & getBatch(size_t layer, const sf::Texture * texture);
+public:
+    SpriteBatch(size_t layerCount = 1);
+
+    void clear();
+    void draw(size_t layer, const sf::Sprite & sprite);
+    void draw(size_t layer, const sf::Texture * texture, const sf::IntRect & textureRect, const sf::Transform & transform);
+    void render(sf::RenderTarget & target);
+    size_t drawCalls() const;
+};
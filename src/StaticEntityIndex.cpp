@@ -0,0 +1,75 @@
+#include "StaticEntityIndex.h"
+#include <algorithm>
+
+StaticEntityIndex::StaticEntityIndex(const std::string & tag)
+    : m_tag(tag)
+{
+}
+
+/**
+ * Forgets the index. Use when the entity manager is replaced (e.g. level reload).
+ */
+void StaticEntityIndex::reset()
+{
+    m_sorted.clear();
+    m_isBuilt = false;
+    m_cursor = 0;
+    m_lastLeft = 0;
+}
+
+void StaticEntityIndex::rebuild(EntityManager & entityManager)
+{
+    m_sorted = entityManager.getEntities(m_tag);
+    std::stable_sort(m_sorted.begin(), m_sorted.end(), [](const std::shared_ptr<Entity> & a, const std::shared_ptr<Entity> & b)
+    {
+        return a->getComponent<CTransform>().pos.x < b->getComponent<CTransform>().pos.x;
+    });
+
+    m_maxHalfWidth = 0;
+    for (auto & e : m_sorted)
+    {
+        const float animationHalfWidth = e->getComponent<CAnimation>().animation.getSize().x / 2;
+        const float boxHalfWidth = e->getComponent<CBoundingBox>().halfSize.x;
+        m_maxHalfWidth = std::max(m_maxHalfWidth, std::max(animationHalfWidth, boxHalfWidth));
+    }
+
+    m_cursor = 0;
+    m_lastLeft = 0;
+    m_revision = entityManager.getRevision(m_tag);
+    m_isBuilt = true;
+}
+
+/**
+ * Returns the entities that may overlap the horizontal range [left, right].
+ * 
+ * The range is conservative (based on the widest entity), so callers still need
+ * to do their own overlap test on each entity.
+ */
+EntityRange StaticEntityIndex::query(EntityManager & entityManager, float left, float right)
+{
+    if (!m_isBuilt || m_revision != entityManager.getRevision(m_tag))
+    {
+        rebuild(entityManager);
+    }
+
+    // Camera went back (shouldn't happen, but don't break if it does)
+    if (left < m_lastLeft)
+    {
+        m_cursor = 0;
+    }
+    m_lastLeft = left;
+
+    // Skip entities that are fully left of the range
+    while (m_cursor < m_sorted.size() && m_sorted[m_cursor]->getComponent<CTransform>().pos.x + m_maxHalfWidth < left)
+    {
+        m_cursor++;
+    }
+
+    size_t end = m_cursor;
+    while (end < m_sorted.size() && m_sorted[end]->getComponent<CTransform>().pos.x - m_maxHalfWidth <= right)
+    {
+        end++;
+    }
+
+    return EntityRange(m_sorted.begin() + m_cursor, m_sorted.begin() + end);
+}
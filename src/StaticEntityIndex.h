@@ -0,0 +1,35 @@
+#pragma once
+
+#include "EntityManager.h"
+#include <string>
+#include <utility>
+
+typedef std::pair<EntityVec::iterator, EntityVec::iterator> EntityRange;
+
+/**
+ * Index over entities that never move (e.g. tiles and decorations), sorted by x position.
+ * 
+ * The camera only scrolls right, so a cursor to the first entity that can be visible
+ * only ever moves forward. This makes finding the entities in the camera proportional
+ * to what is on the screen, instead of to the length of the level.
+ * 
+ * The index is rebuilt when entities are added to, or removed from the tag's list.
+ */
+class StaticEntityIndex
+{
+private:
+    std::string m_tag;
+    EntityVec   m_sorted;
+    float       m_maxHalfWidth = 0;   // widest entity, so an entity's left and right edges can be bounded by its x position
+    size_t      m_cursor = 0;         // first entity that can be visible
+    float       m_lastLeft = 0;
+    size_t      m_revision = 0;
+    bool        m_isBuilt = false;
+
+    void rebuild(EntityManager & entityManager);
+public:
+    StaticEntityIndex(const std::string & tag);
+
+    void reset();
+    EntityRange query(EntityManager & entityManager, float left, float right);
+};
@@ -0,0 +1,42 @@
+#include "SystemScheduler.h"
+
+SystemScheduler::SystemScheduler()
+{
+}
+
+void SystemScheduler::addSystem(const std::string & name, AccessMask reads, AccessMask writes, std::function<void()> run)
+{
+    System system;
+    system.name = name;
+    system.reads = reads;
+    system.writes = writes;
+    system.run = std::move(run);
+    m_systems.push_back(std::move(system));
+}
+
+void SystemScheduler::runSystem(System & system)
+{
+#ifdef SYSTEM_ACCESS_CHECKS
+    t_declaredAccess = system.reads | system.writes;
+    system.run();
+    t_declaredAccess = ~AccessMask(0);
+#else
+    system.run();
+#endif
+}
+
+void SystemScheduler::clear()
+{
+    m_systems.clear();
+}
+
+/**
+ * Runs every system once, in the order they were added.
+ */
+void SystemScheduler::run()
+{
+    for (System & system : m_systems)
+    {
+        runSystem(system);
+    }
+}
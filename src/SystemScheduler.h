@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Entity.h"
+#include <functional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Shared state, besides components, that systems can declare access to
+struct EntityChanges {}; // adding, destroying, or moving entities
+struct SceneState {};    // the scene's own members (camera, tile map, ...)
+
+// Everything a system can declare access to. Components keep their ComponentTuple index.
+typedef decltype(std::tuple_cat(std::declval<ComponentTuple>(), std::declval<std::tuple<EntityChanges, SceneState>>())) AccessTuple;
+static_assert(std::tuple_size<AccessTuple>::value <= sizeof(AccessMask) * 8, "Too many types for AccessMask");
+
+template <typename... Ts>
+struct Access
+{
+    static constexpr AccessMask mask = (AccessMask(0) | ... | (AccessMask(1) << TypeIndex<Ts, AccessTuple>::value));
+};
+
+template <typename... Ts>
+struct Reads : Access<Ts...> {};
+
+template <typename... Ts>
+struct Writes : Access<Ts...> {};
+
+/**
+ * Runs systems, and checks that they only touch the components they read and write.
+ * 
+ * Each system declares, at compile time, what it reads and writes:
+ *     scheduler.add<Reads<CInput>, Writes<CTransform, CState>>("PlayerState", [this]() { sPlayerState(); });
+ * 
+ * Systems run one at a time, in the order they were added. Declaring access at a component
+ * granularity doesn't let them run concurrently: every game system reads or writes CTransform.
+ * 
+ * Built with SYSTEM_ACCESS_CHECKS (make debug), getComponent() asserts that the running
+ * system declared the component. Jobs started by a system are not checked.
+ */
+class SystemScheduler
+{
+private:
+    struct System
+    {
+        std::string           name;
+        AccessMask            reads = 0;
+        AccessMask            writes = 0;
+        std::function<void()> run;
+    };
+
+    std::vector<System> m_systems;
+
+    void addSystem(const std::string & name, AccessMask reads, AccessMask writes, std::function<void()> run);
+    void runSystem(System & system);
+public:
+    SystemScheduler();
+
+    template <typename R, typename W>
+    void add(const std::string & name, std::function<void()> run)
+    {
+        addSystem(name, R::mask, W::mask, std::move(run));
+    }
+
+    void clear();
+    void run();
+};
@@ -0,0 +1,206 @@
+#include "TextureResidency.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+TextureResidency::TextureResidency(Assets & assets, JobSystem * jobs, size_t budgetBytes)
+    : m_assets(assets)
+    , m_jobs(jobs)
+    , m_budget(budgetBytes)
+{
+}
+
+/**
+ * Waits for images still being decoded, since the decode jobs write into the entries.
+ */
+TextureResidency::~TextureResidency()
+{
+    for (auto & entry : m_entries)
+    {
+        waitForDecode(*entry);
+    }
+}
+
+/**
+ * Starts tracking a texture, just after it was loaded into Assets (its animations must be made
+ * before the next trim(), while it is still loaded). Adding it again, e.g. after it was hot
+ * reloaded, updates its path and size.
+ */
+void TextureResidency::add(const std::string & name, const std::string & path)
+{
+    sf::Texture * texture = &m_assets.getTexture(name);
+    auto it = m_byTexture.find(texture);
+    Entry * entry = it == m_byTexture.end() ? nullptr : it->second;
+
+    if (entry == nullptr)
+    {
+        m_entries.emplace_back(new Entry());
+        entry = m_entries.back().get();
+        entry->name = name;
+        entry->texture = texture;
+        m_byTexture[texture] = entry;
+    }
+    else if (entry->isResident)
+    {
+        m_residentBytes -= entry->bytes;
+    }
+
+    entry->path = path;
+    entry->bytes = (size_t) texture->getSize().x * texture->getSize().y * 4;
+    entry->lastUsed = m_frame;
+    entry->isResident = true;
+    m_residentBytes += entry->bytes;
+    m_peakBytes = std::max(m_peakBytes, m_residentBytes);
+}
+
+/**
+ * Starts a new frame. Prints stats every REPORT_FRAMES frames, if textures were loaded or evicted.
+ */
+void TextureResidency::beginFrame()
+{
+    m_frame++;
+
+    const bool hasChanged = m_loads != m_reportedLoads || m_evictions != m_reportedEvictions;
+    if (m_frame % REPORT_FRAMES == 0 && hasChanged)
+    {
+        std::cout << "Textures: " << m_residentBytes / 1024 << " KB resident (peak " << m_peakBytes / 1024 << " KB, budget "
+                  << m_budget / 1024 << " KB), " << m_loads << " loads (" << m_prefetchedLoads << " prefetched), "
+                  << m_evictions << " evictions\n";
+        m_reportedLoads = m_loads;
+        m_reportedEvictions = m_evictions;
+    }
+}
+
+void TextureResidency::waitForDecode(Entry & entry)
+{
+    while (entry.isPrefetching && !entry.isDecoded)
+    {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * Loads the texture, from its prefetched image if there is one.
+ */
+void TextureResidency::load(Entry & entry)
+{
+    bool result;
+    if (entry.isPrefetching)
+    {
+        waitForDecode(entry);
+        result = entry.result && entry.texture->loadFromImage(entry.image);
+        entry.image = sf::Image(); // free decoded pixels
+        entry.isPrefetching = false;
+        entry.isDecoded = false;
+        m_prefetchedLoads++;
+    }
+    else
+    {
+        result = entry.texture->loadFromFile(entry.path);
+    }
+
+    if (!result)
+    {
+        std::cout << "Error: could not load texture " << entry.name << "\n";
+    }
+
+    entry.isResident = true;
+    m_residentBytes += entry.bytes;
+    m_peakBytes = std::max(m_peakBytes, m_residentBytes);
+    m_loads++;
+}
+
+void TextureResidency::evict(Entry & entry)
+{
+    *entry.texture = sf::Texture();
+    entry.isResident = false;
+    m_residentBytes -= entry.bytes;
+    m_evictions++;
+}
+
+/**
+ * Marks the texture as used in this frame, loading it if it was evicted.
+ */
+void TextureResidency::use(const sf::Texture * texture)
+{
+    auto it = m_byTexture.find(texture);
+    if (it == m_byTexture.end())
+    {
+        return;
+    }
+
+    Entry & entry = *it->second;
+    entry.lastUsed = m_frame;
+    if (!entry.isResident)
+    {
+        load(entry);
+    }
+}
+
+/**
+ * Starts decoding the image of an evicted texture, that will likely be used soon.
+ */
+void TextureResidency::prefetch(const sf::Texture * texture)
+{
+    auto it = m_byTexture.find(texture);
+    if (it == m_byTexture.end())
+    {
+        return;
+    }
+
+    Entry * entry = it->second;
+    if (entry->isResident || entry->isPrefetching)
+    {
+        return;
+    }
+
+    entry->isPrefetching = true;
+    auto decode = [entry]()
+    {
+        entry->result = entry->image.loadFromFile(entry->path);
+        entry->isDecoded = true;
+    };
+
+    if (m_jobs != nullptr)
+    {
+        m_jobs->submit(decode);
+    }
+    else
+    {
+        decode();
+    }
+}
+
+/**
+ * Evicts the least recently used textures, until the resident ones fit in the budget.
+ */
+void TextureResidency::trim()
+{
+    while (m_residentBytes > m_budget)
+    {
+        Entry * oldest = nullptr;
+        for (auto & entry : m_entries)
+        {
+            if (entry->isResident && entry->lastUsed < m_frame && (oldest == nullptr || entry->lastUsed < oldest->lastUsed))
+            {
+                oldest = entry.get();
+            }
+        }
+
+        if (oldest == nullptr)
+        {
+            return; // everything left was used in this frame
+        }
+        evict(*oldest);
+    }
+}
+
+size_t TextureResidency::residentBytes() const
+{
+    return m_residentBytes;
+}
+
+size_t TextureResidency::peakBytes() const
+{
+    return m_peakBytes;
+}
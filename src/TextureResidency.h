@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Assets.h"
+#include "JobSystem.h"
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Keeps texture memory under a budget, by evicting the least recently used textures.
+ *
+ * Textures stay in Assets, so sprites and animations keep pointing at them: an evicted texture is
+ * emptied in place, and loaded again (from its image file) the next time it is used. Textures
+ * used in the current frame are never evicted, so the budget can be exceeded by what one frame needs.
+ *
+ * prefetch() decodes a texture's image on the job system ahead of use, so that using it only
+ * needs an upload.
+ */
+class TextureResidency
+{
+private:
+    struct Entry
+    {
+        std::string        name;
+        std::string        path;
+        sf::Texture *      texture = nullptr;
+        size_t             bytes = 0;
+        size_t             lastUsed = 0; // frame
+        bool               isResident = false;
+
+        // Prefetching
+        sf::Image          image;
+        bool               isPrefetching = false; // decode job submitted, and image not yet used
+        std::atomic<bool>  isDecoded { false };
+        bool               result = false;
+    };
+
+    Assets &    m_assets;
+    JobSystem * m_jobs = nullptr;
+    size_t      m_budget = 0;  // bytes
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    std::unordered_map<const sf::Texture *, Entry *> m_byTexture;
+    size_t      m_frame = 1;
+
+    // Stats
+    size_t m_residentBytes = 0;
+    size_t m_peakBytes = 0;
+    size_t m_loads = 0;
+    size_t m_prefetchedLoads = 0;
+    size_t m_evictions = 0;
+    size_t m_reportedLoads = 0;
+    size_t m_reportedEvictions = 0;
+
+    void load(Entry & entry);
+    void evict(Entry & entry);
+    void waitForDecode(Entry & entry);
+public:
+    static const size_t REPORT_FRAMES = 300;
+
+    TextureResidency(Assets & assets, JobSystem * jobs, size_t budgetBytes);
+    ~TextureResidency();
+
+    void add(const std::string & name, const std::string & path);
+    void beginFrame();
+    void use(const sf::Texture * texture);
+    void prefetch(const sf::Texture * texture);
+    void trim();
+
+    size_t residentBytes() const;
+    size_t peakBytes() const;
+};
@@ -0,0 +1,158 @@
+#include "TileMap.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+TileMap::TileMap()
+{
+}
+
+/**
+ * Empties every cell. Tile types are kept.
+ */
+void TileMap::reset(const Vec2 & cellSize, float worldHeight)
+{
+    m_cells.clear();
+    m_columns = 0;
+    m_rows = 0;
+    m_cellSize = cellSize;
+    m_worldHeight = worldHeight;
+}
+
+/**
+ * Adds a tile type, and returns its id. If the animation already has a type, its id is returned.
+ */
+TileId TileMap::addType(const std::string & animation, uint8_t flags)
+{
+    auto it = m_typeIds.find(animation);
+    if (it != m_typeIds.end())
+    {
+        return it->second;
+    }
+
+    assert(m_types.size() <= 255 && "Too many tile types");
+
+    TileType type;
+    type.animation = animation;
+    type.flags = flags;
+    m_types.push_back(type);
+
+    const TileId id = m_types.size() - 1;
+    m_typeIds[animation] = id;
+    return id;
+}
+
+/**
+ * Returns the id of the animation's tile type, or EMPTY if it has none.
+ */
+TileId TileMap::getTypeId(const std::string & animation) const
+{
+    auto it = m_typeIds.find(animation);
+    return it == m_typeIds.end() ? EMPTY : it->second;
+}
+
+const TileType & TileMap::getType(TileId id) const
+{
+    return m_types[id];
+}
+
+size_t TileMap::typeCount() const
+{
+    return m_types.size();
+}
+
+void TileMap::resize(int columns, int rows)
+{
+    std::vector<TileId> cells (columns * rows, EMPTY);
+
+    for (int x = 0; x < m_columns; x++)
+    {
+        for (int y = 0; y < m_rows; y++)
+        {
+            cells[x * rows + y] = m_cells[x * m_rows + y];
+        }
+    }
+
+    m_cells.swap(cells);
+    m_columns = columns;
+    m_rows = rows;
+}
+
+/**
+ * Sets the tile in a cell, growing the map if needed. Cells left of, or below, the map are ignored.
+ */
+void TileMap::setTile(int gx, int gy, TileId id)
+{
+    if (gx < 0 || gy < 0)
+    {
+        return;
+    }
+
+    if (gx >= m_columns || gy >= m_rows)
+    {
+        if (id == EMPTY)
+        {
+            return;
+        }
+
+        // Grow columns geometrically, since levels are loaded from left to right
+        const int columns = gx >= m_columns ? std::max(gx + 1, m_columns * 2) : m_columns;
+        const int rows = std::max(gy + 1, m_rows);
+        resize(columns, rows);
+    }
+
+    m_cells[gx * m_rows + gy] = id;
+}
+
+/**
+ * Returns the tile in a cell, or EMPTY if the cell is outside the map.
+ */
+TileId TileMap::getTile(int gx, int gy) const
+{
+    if (gx < 0 || gy < 0 || gx >= m_columns || gy >= m_rows)
+    {
+        return EMPTY;
+    }
+
+    return m_cells[gx * m_rows + gy];
+}
+
+int TileMap::columns() const
+{
+    return m_columns;
+}
+
+int TileMap::rows() const
+{
+    return m_rows;
+}
+
+float TileMap::worldHeight() const
+{
+    return m_worldHeight;
+}
+
+/**
+ * Center of a cell, in cartesian coordinates.
+ */
+Vec2 TileMap::cellCenter(int gx, int gy) const
+{
+    return Vec2(m_cellSize.x * gx + m_cellSize.x / 2, m_worldHeight - m_cellSize.y * gy - m_cellSize.y / 2);
+}
+
+Vec2 TileMap::cellHalfSize() const
+{
+    return m_cellSize / 2;
+}
+
+/**
+ * Gets the range of cells (inclusive) that a box, centered at pos, can overlap.
+ * The range can be outside of the map.
+ */
+void TileMap::getCellRange(const Vec2 & pos, const Vec2 & halfSize, int & firstX, int & lastX, int & firstY, int & lastY) const
+{
+    firstX = (int) std::floor((pos.x - halfSize.x) / m_cellSize.x);
+    lastX = (int) std::floor((pos.x + halfSize.x) / m_cellSize.x);
+    firstY = (int) std::floor((m_worldHeight - pos.y - halfSize.y) / m_cellSize.y);
+    lastY = (int) std::floor((m_worldHeight - pos.y + halfSize.y) / m_cellSize.y);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Vec2.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef uint8_t TileId;
+
+// Tile behaviour flags
+enum TileFlag : uint8_t
+{
+    TILE_SOLID     = 1 << 0,
+    TILE_BREAKABLE = 1 << 1, // breaks when hit from below (bricks)
+    TILE_QUESTION  = 1 << 2  // gives a coin when hit from below, and turns into a hit block
+};
+
+struct TileType
+{
+    std::string animation;
+    uint8_t     flags = 0;
+};
+
+/**
+ * Dense grid of static tiles, one tile id per grid cell.
+ * 
+ * Cells use grid coordinates (see LevelSpecification.txt): column gx from the left, and
+ * row gy from the bottom. Cells are stored column by column, so a level can keep growing
+ * to the right. Collision queries only look at the cells a box overlaps.
+ */
+class TileMap
+{
+private:
+    std::vector<TileType>         m_types { TileType() }; // tile id -> type, id 0 is empty
+    std::map<std::string, TileId> m_typeIds;              // animation name -> tile id
+    std::vector<TileId>           m_cells;
+    int   m_columns = 0;
+    int   m_rows = 0;
+    Vec2  m_cellSize = { 64.f, 64.f };
+    float m_worldHeight = 0; // cartesian y of the bottom of row 0
+
+    void resize(int columns, int rows);
+public:
+    static constexpr TileId EMPTY = 0;
+
+    TileMap();
+
+    void reset(const Vec2 & cellSize, float worldHeight);
+
+    TileId addType(const std::string & animation, uint8_t flags);
+    TileId getTypeId(const std::string & animation) const;
+    const TileType & getType(TileId id) const;
+    size_t typeCount() const;
+
+    void setTile(int gx, int gy, TileId id);
+    TileId getTile(int gx, int gy) const;
+    int columns() const;
+    int rows() const;
+    float worldHeight() const;
+
+    Vec2 cellCenter(int gx, int gy) const;
+    Vec2 cellHalfSize() const;
+    void getCellRange(const Vec2 & pos, const Vec2 & halfSize, int & firstX, int & lastX, int & firstY, int & lastY) const;
+};
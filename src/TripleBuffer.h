@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * Lock-free handoff of values from one producer thread to one consumer thread.
+ * 
+ * The producer writes into back() and calls publish(). The consumer calls update()
+ * to get the most recently published value into front(). Neither side ever waits
+ * for the other: the producer always has a buffer to write into, and the consumer
+ * always has a complete value to read (values in between may be skipped).
+ */
+template <typename T>
+class TripleBuffer
+{
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH_BIT = 4; // set when the middle buffer holds a value the consumer hasn't seen
+
+    T                m_buffers[3];
+    int              m_back = 0;         // only used by the producer
+    int              m_front = 1;        // only used by the consumer
+    std::atomic<int> m_middle { 2 };     // shared, index of the middle buffer and the fresh bit
+
+public:
+    // Producer: buffer to write the next value into.
+    T & back()
+    {
+        return m_buffers[m_back];
+    }
+
+    // Producer: makes the value in back() available to the consumer.
+    void publish()
+    {
+        m_back = m_middle.exchange(m_back | FRESH_BIT) & INDEX_MASK;
+    }
+
+    // Consumer: moves the latest published value to front(). Returns false if there was none.
+    bool update()
+    {
+        if ((m_middle.load() & FRESH_BIT) == 0)
+        {
+            return false;
+        }
+
+        m_front = m_middle.exchange(m_front) & INDEX_MASK;
+        return true;
+    }
+
+    // Consumer: latest value received by update().
+    const T & front() const
+    {
+        return m_buffers[m_front];
+    }
+};
@@ -0,0 +1,228 @@
+#include "../src/AgentBatch.h"
+#include "../src/EntityManager.h"
+#include "../src/Physics.h"
+#include "../src/PlayerKinematics.h"
+#include "../src/PhysicsConstants.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+// Builds a level with a floor with gaps, walls, and floating platforms (896 pixels high, like the game).
+static void buildLevel(TileMap & tileMap)
+{
+    const int LEVEL_WIDTH = 400;
+    tileMap.reset(Vec2(64, 64), 896);
+    const TileId ground = tileMap.addType("Ground", TILE_SOLID);
+
+    for (int gx = 0; gx < LEVEL_WIDTH; gx++)
+    {
+        if (gx % 37 != 36) // gaps to fall into
+        {
+            tileMap.setTile(gx, 0, ground);
+            tileMap.setTile(gx, 1, ground);
+        }
+        if (gx % 23 == 0) // walls
+        {
+            tileMap.setTile(gx, 2, ground);
+            tileMap.setTile(gx, 3, ground);
+        }
+        if (gx % 11 < 4) // platforms
+        {
+            tileMap.setTile(gx, 5, ground);
+        }
+    }
+}
+
+static std::vector<InputScript> makeScripts(int count, int frames)
+{
+    std::mt19937 random(12345);
+    std::vector<InputScript> scripts;
+    for (int i = 0; i < count; i++)
+    {
+        // Mostly running right, with random jumps and turns, each held for a few frames
+        InputScript script(frames);
+        uint8_t buttons = AGENT_RIGHT;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            if (random() % 10 == 0)
+            {
+                const unsigned int r = random();
+                buttons = (r % 5 == 0 ? AGENT_LEFT : AGENT_RIGHT) | (r & 8 ? AGENT_RUN : 0) | (r & 16 ? AGENT_JUMP : 0);
+            }
+            script[frame] = buttons;
+        }
+        scripts.push_back(script);
+    }
+    return scripts;
+}
+
+static void addAgents(AgentBatch & batch, const std::vector<InputScript> & scripts)
+{
+    for (const InputScript & script : scripts)
+    {
+        batch.addAgent(Vec2(4 * 64 + 28, 896 - 2 * 64 - 32), script);
+    }
+}
+
+// Makes a Tile entity for every solid cell, like a level loaded without the tile map
+static void buildTiles(const TileMap & tileMap, EntityManager & entityManager)
+{
+    for (int gx = 0; gx < tileMap.columns(); gx++)
+    {
+        for (int gy = 0; gy < tileMap.rows(); gy++)
+        {
+            const TileType & type = tileMap.getType(tileMap.getTile(gx, gy));
+            if (type.flags & TILE_SOLID)
+            {
+                auto tile = entityManager.addEntity("Tile");
+                tile->addComponent<CTransform>(tileMap.cellCenter(gx, gy));
+                tile->addComponent<CBoundingBox>(tileMap.cellHalfSize() * 2);
+                tile->addComponent<CTile>(type.flags);
+            }
+        }
+    }
+    entityManager.update();
+}
+
+// Steps a player the way Scene_Play does, against Tile entities: player state, movement, then player-block collisions
+static void stepPlayer(const std::shared_ptr<Entity> & player, EntityManager & entityManager, uint8_t buttons, float worldHeight)
+{
+    CTransform & cTransform = player->getComponent<CTransform>();
+    CInput & cInput = player->getComponent<CInput>();
+    CState & cState = player->getComponent<CState>();
+    const Vec2 halfSize = player->getComponent<CBoundingBox>().halfSize;
+
+    cInput.left = buttons & AGENT_LEFT;
+    cInput.right = buttons & AGENT_RIGHT;
+    cInput.B = buttons & AGENT_RUN;
+    cInput.A = buttons & AGENT_JUMP;
+
+    PlayerKinematics::updateState(cTransform, cInput, cState);
+    PlayerKinematics::move(cTransform, cInput, cState);
+
+    if (cTransform.pos.y - halfSize.y > worldHeight)
+    {
+        player->destroy();
+        return;
+    }
+    if (cTransform.pos.x - halfSize.x < 0)
+    {
+        cTransform.pos.x = halfSize.x;
+    }
+
+    BlockHit hits[COLLISION_DIRECTION_COUNT];
+    for (auto & tile : entityManager.getEntities("Tile"))
+    {
+        Physics::PickBlockHit(BlockHit(tile, tile->getComponent<CTile>().flags), cTransform, halfSize, hits);
+    }
+    Physics::ResolveBlockHits(hits, halfSize, cTransform, cInput, cState, nullptr);
+}
+
+static double run(AgentBatch & batch, JobSystem * jobs, int frames)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        batch.step(jobs);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main()
+{
+    const int AGENTS = 1000;
+    const int FRAMES = 2000;
+
+    TileMap tileMap;
+    buildLevel(tileMap);
+
+    AgentBatch serialBatch(tileMap);
+    AgentBatch parallelBatch(tileMap);
+    const std::vector<InputScript> scripts = makeScripts(AGENTS, FRAMES);
+    addAgents(serialBatch, scripts);
+    addAgents(parallelBatch, scripts);
+
+    JobSystem jobs(JobSystem::defaultWorkerCount());
+    const double serialSeconds = run(serialBatch, nullptr, FRAMES);
+    const double parallelSeconds = run(parallelBatch, &jobs, FRAMES);
+
+    // T1: agents stepped in parallel must be bit-identical to agents stepped serially
+    int mismatches = 0;
+    for (size_t i = 0; i < serialBatch.size(); i++)
+    {
+        const Vec2 a = serialBatch.position(i);
+        const Vec2 b = parallelBatch.position(i);
+        if (std::memcmp(&a, &b, sizeof(Vec2)) != 0 || serialBatch.isAlive(i) != parallelBatch.isAlive(i))
+        {
+            mismatches++;
+        }
+    }
+    if (mismatches > 0)
+    {
+        std::cout << "T1: Error: " << mismatches << " agents differ between serial and parallel step\n";
+    }
+
+    // T2: agents must stay out of solid cells, and some must make it past the first walls and gaps
+    int farAgents = 0;
+    for (size_t i = 0; i < serialBatch.size(); i++)
+    {
+        const Vec2 pos = serialBatch.position(i);
+        if (serialBatch.isAlive(i) && tileMap.getTile((int) (pos.x / 64), (int) ((896 - pos.y) / 64)) != TileMap::EMPTY)
+        {
+            std::cout << "T2: Error: agent " << i << " is inside a solid cell\n";
+            break;
+        }
+        farAgents += serialBatch.maxX(i) > 50 * 64;
+    }
+    if (farAgents == 0)
+    {
+        std::cout << "T2: Error: no agent got past the first walls and gaps\n";
+    }
+
+    // T3: agents must move exactly like players stepped against Tile entities, as in Scene_Play
+    const int PLAYERS = 20;
+    EntityManager entityManager;
+    buildTiles(tileMap, entityManager);
+    AgentBatch playerBatch(tileMap);
+    const std::vector<InputScript> playerScripts = makeScripts(PLAYERS, FRAMES);
+    addAgents(playerBatch, playerScripts);
+    std::vector<std::shared_ptr<Entity>> players;
+    for (int i = 0; i < PLAYERS; i++)
+    {
+        auto player = entityManager.addEntity("Player");
+        player->addComponent<CTransform>(playerBatch.position(i));
+        player->getComponent<CTransform>().acc_y = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_S;
+        player->addComponent<CBoundingBox>(Vec2(56, 64));
+        player->addComponent<CInput>();
+        player->addComponent<CState>();
+        players.push_back(player);
+    }
+    entityManager.update();
+
+    int diverged = 0;
+    for (int frame = 0; frame < FRAMES && diverged == 0; frame++)
+    {
+        playerBatch.step(nullptr);
+        for (int i = 0; i < PLAYERS; i++)
+        {
+            if (!players[i]->isActive())
+            {
+                continue;
+            }
+            stepPlayer(players[i], entityManager, playerScripts[i][frame], tileMap.worldHeight());
+
+            const Vec2 a = players[i]->getComponent<CTransform>().pos;
+            const Vec2 b = playerBatch.position(i);
+            if (players[i]->isActive() != playerBatch.isAlive(i) || (players[i]->isActive() && std::memcmp(&a, &b, sizeof(Vec2)) != 0))
+            {
+                std::cout << "T3: Error: agent " << i << " differs from the player at frame " << frame << "\n";
+                diverged++;
+            }
+        }
+    }
+
+    const double agentFrames = (double) AGENTS * FRAMES;
+    std::cout << "Agent batch: " << agentFrames / serialSeconds << " agent-frames/s serial, "
+              << agentFrames / parallelSeconds << " agent-frames/s on " << jobs.workerCount() + 1 << " threads\n";
+}
@@ -50,4 +50,44 @@ int main()
     if (!(a.getSprite().getTextureRect().left == 0)) {
         std:: cout << "T4: Error: animation should be at frame 1\n";
     }
+
+    // Multi-row sheet in a sub-rect of the texture: 2 rows of 2 frames of 50x25 at (100, 50), 3 frames played
+    Animation sheet("", t, sf::IntRect(100, 50, 100, 50), 2, 2, 3, 5, 1.f, 1.f, -1, -1);
+    const int expectedLeft[] = { 100, 150, 100, 100 };
+    const int expectedTop[] = { 50, 50, 75, 50 };
+    for (int i = 0; i < 4; i++)
+    {
+        const sf::IntRect & rect = sheet.getSprite().getTextureRect();
+        if (rect.left != expectedLeft[i] || rect.top != expectedTop[i] || rect.width != 50 || rect.height != 25 || sheet.getCurrentAnimationFrameIndex() != i % 3) {
+            std::cout << "T5: Error: sheet animation should be at frame " << i % 3 << " " << rect.left << "," << rect.top << "\n";
+        }
+        for (int j = 0; j < 5; j++) {
+            sheet.update();
+        }
+    }
+    if (sheet.getSize().x != 50 || sheet.getSize().y != 25 || !sheet.hasEnded()) {
+        std::cout << "T6: Error: sheet animation size or end is wrong\n";
+    }
+
+    // Frames of different sizes, origins, and durations
+    std::vector<Animation::Frame> frames(2);
+    frames[0].rect = sf::IntRect(0, 0, 40, 100);
+    frames[0].origin = sf::Vector2f(20, 100);
+    frames[0].duration = 2;
+    frames[1].rect = sf::IntRect(40, 0, 60, 80);
+    frames[1].origin = sf::Vector2f(30, 80);
+    frames[1].duration = 6;
+    Animation custom("", t, frames, 1.f, 1.f);
+    custom.setCurrentFrame(7);
+    if (custom.getSprite().getTextureRect().left != 40 || custom.getSprite().getOrigin().x != 30 || custom.hasEnded()) {
+        std::cout << "T7: Error: custom animation should be at frame 2\n";
+    }
+    custom.setCurrentFrame(8);
+    if (custom.getSprite().getTextureRect().left != 0 || custom.getSprite().getOrigin().y != 100 || !custom.hasEnded()) {
+        std::cout << "T8: Error: custom animation should be back at frame 1\n";
+    }
+    custom.setCurrentAnimationFrame(1);
+    if (custom.getCurrentFrame() != 2) {
+        std::cout << "T9: Error: frame 2 of custom animation should start at game frame 2\n";
+    }
 }
\ No newline at end of file
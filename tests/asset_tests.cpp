@@ -0,0 +1,157 @@
+#include "../src/Assets.h"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+
+// Names from bin/texts/assets.txt
+static const char * NAMES[] =
+{
+    "Block", "Brick", "Ground", "MarioStand", "MarioAir", "MarioRun", "MarioWalk", "QuestionMarkBlink",
+    "QuestionMarkBlockHit", "MarioSkid", "FlagTop", "FlagPole", "BigMountain", "SmallMountain", "SmallCastle",
+    "PipeTopLeft", "PipeTopRight", "PipeLeft", "PipeRight", "BushFront", "BushMiddle", "BushEnd", "CloudFrontTop",
+    "CloudMiddleTop", "CloudEndTop", "CloudFrontBottom", "CloudMiddleBottom", "CloudEndBottom", "GoombaWalk",
+    "GoombaDead", "KoopaWalk", "KoopaShell", "CoinBlink", "BrokenBrick"
+};
+static const int NAME_COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+// The map based storage Assets used before, with its getters (a find for the assert, then an at)
+struct MapAssets
+{
+    std::map<std::string, sf::Texture> textures;
+    std::map<std::string, Animation> animations;
+
+    const sf::Texture & getTexture(const std::string & name) const
+    {
+        if (textures.find(name) == textures.end())
+        {
+            std::cout << "Error: texture " << name << " does not exist\n";
+        }
+        return textures.at(name);
+    }
+
+    const Animation & getAnimation(const std::string & name) const
+    {
+        if (animations.find(name) == animations.end())
+        {
+            std::cout << "Error: animation " << name << " does not exist\n";
+        }
+        return animations.at(name);
+    }
+};
+
+template <class F>
+static double seconds(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    sf::Texture t;
+    if (!t.create(128,64))
+    {
+        std::cout << "Could not create texture.\n";
+        return 0;
+    }
+
+    Assets assets;
+    MapAssets mapAssets;
+    for (int i = 0; i < NAME_COUNT; i++)
+    {
+        sf::Image image;
+        image.create(64 * (i % 4 + 1), 64);
+        assets.addTexture(NAMES[i], image);
+        mapAssets.textures[NAMES[i]].loadFromImage(image);
+        assets.addAnimation(NAMES[i], Animation(NAMES[i], assets.getTexture(NAMES[i]), i % 4 + 1, 8));
+        mapAssets.animations[NAMES[i]] = Animation(NAMES[i], mapAssets.getTexture(NAMES[i]), i % 4 + 1, 8);
+    }
+
+    // T1: names, ids, and assets must agree
+    for (int i = 0; i < NAME_COUNT; i++)
+    {
+        const AnimationId id = assets.getAnimationId(NAMES[i]);
+        const bool isSame = assets.getAnimation(id).getName() == NAMES[i]
+            && assets.getAnimation(id).getId() == id
+            && assets.getAnimation(id).getSize() == mapAssets.getAnimation(NAMES[i]).getSize()
+            && &assets.getTexture(assets.getTextureId(NAMES[i])) == &assets.getTexture(NAMES[i]);
+        if (!isSame)
+        {
+            std::cout << "T1: Error: asset " << NAMES[i] << " is wrong\n";
+        }
+    }
+    if (assets.hasTexture("Missing") || !assets.hasTexture("Block"))
+    {
+        std::cout << "T1: Error: hasTexture is wrong\n";
+    }
+
+    // T2: adding assets again must keep their ids, and textures their addresses (sprites point at them)
+    const sf::Texture * block = &assets.getTexture("Block");
+    const AnimationId coin = assets.getAnimationId("CoinBlink");
+    sf::Image image;
+    image.create(32, 32);
+    assets.addTexture("Block", image);
+    assets.addTexture("Extra", image);
+    assets.addAnimation("CoinBlink", Animation("CoinBlink", assets.getTexture("Block")));
+    mapAssets.textures["Block"].loadFromImage(image);
+    mapAssets.animations["CoinBlink"] = Animation("CoinBlink", mapAssets.getTexture("Block"));
+    if (&assets.getTexture("Block") != block || assets.getTexture("Block").getSize().x != 32 || assets.getAnimationId("CoinBlink") != coin)
+    {
+        std::cout << "T2: Error: adding an asset again moved it, or changed its id\n";
+    }
+
+    // T3: the name table must find every name after growing, and no others
+    NameTable table;
+    for (int i = 0; i < 5000; i++)
+    {
+        table.insert("Name" + std::to_string(i), (uint16_t) i);
+    }
+    for (int i = 0; i < 5000; i++)
+    {
+        if (table.find("Name" + std::to_string(i)) != i || table.find("Other" + std::to_string(i)) != NameTable::NONE)
+        {
+            std::cout << "T3: Error: name table lookup of Name" << i << " is wrong\n";
+            break;
+        }
+    }
+    if (table.size() != 5000)
+    {
+        std::cout << "T3: Error: name table has " << table.size() << " names\n";
+    }
+
+    // Lookups in a random order, by name through the map and the hash table, and by id
+    const int LOOKUPS = 2000000;
+    std::mt19937 random(12345);
+    std::vector<std::string> names(LOOKUPS);
+    std::vector<AnimationId> animationIds(LOOKUPS);
+    std::vector<TextureId> textureIds(LOOKUPS);
+    for (int i = 0; i < LOOKUPS; i++)
+    {
+        names[i] = NAMES[random() % NAME_COUNT];
+        animationIds[i] = assets.getAnimationId(names[i]);
+        textureIds[i] = assets.getTextureId(names[i]);
+    }
+
+    float mapSum = 0;
+    float nameSum = 0;
+    float idSum = 0;
+    const double mapAnimationSeconds = seconds([&]() { for (int i = 0; i < LOOKUPS; i++) { mapSum += mapAssets.getAnimation(names[i]).getSize().x; } });
+    const double nameAnimationSeconds = seconds([&]() { for (int i = 0; i < LOOKUPS; i++) { nameSum += assets.getAnimation(names[i]).getSize().x; } });
+    const double idAnimationSeconds = seconds([&]() { for (int i = 0; i < LOOKUPS; i++) { idSum += assets.getAnimation(animationIds[i]).getSize().x; } });
+    const double mapTextureSeconds = seconds([&]() { for (int i = 0; i < LOOKUPS; i++) { mapSum += mapAssets.getTexture(names[i]).getSize().y; } });
+    const double nameTextureSeconds = seconds([&]() { for (int i = 0; i < LOOKUPS; i++) { nameSum += assets.getTexture(names[i]).getSize().y; } });
+    const double idTextureSeconds = seconds([&]() { for (int i = 0; i < LOOKUPS; i++) { idSum += assets.getTexture(textureIds[i]).getSize().y; } });
+
+    if (mapSum != nameSum || mapSum != idSum)
+    {
+        std::cout << "T4: Error: lookups by map, name, and id found different assets\n";
+    }
+
+    const auto ns = [](double s) { return s * 1e9 / LOOKUPS; };
+    std::cout << "getAnimation: " << ns(mapAnimationSeconds) << " ns by name in a map, " << ns(nameAnimationSeconds)
+              << " ns by name in the hash table, " << ns(idAnimationSeconds) << " ns by id\n";
+    std::cout << "getTexture: " << ns(mapTextureSeconds) << " ns by name in a map, " << ns(nameTextureSeconds)
+              << " ns by name in the hash table, " << ns(idTextureSeconds) << " ns by id\n";
+}
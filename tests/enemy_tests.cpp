@@ -0,0 +1,202 @@
+#include "../src/EnemySystems.h"
+#include "../src/PhysicsConstants.h"
+#include <iostream>
+#include <cstring>
+
+// Builds a level with a floor, some walls, and many goombas and koopas.
+static void buildWorld(EntityManager & entityManager, const Animation & walk, const Animation & shell)
+{
+    const int LEVEL_WIDTH = 400;
+
+    for (int gx = 0; gx < LEVEL_WIDTH; gx++)
+    {
+        auto tile = entityManager.addEntity("Tile");
+        tile->addComponent<CTransform>(Vec2(gx * 64 + 32, 800));
+        tile->addComponent<CBoundingBox>(Vec2(64, 64));
+
+        // Walls every 20 blocks, so enemies bounce back and forth
+        if (gx % 20 == 0)
+        {
+            auto wall = entityManager.addEntity("Tile");
+            wall->addComponent<CTransform>(Vec2(gx * 64 + 32, 736));
+            wall->addComponent<CBoundingBox>(Vec2(64, 64));
+        }
+    }
+
+    for (int i = 0; i < 1000; i++)
+    {
+        const float x = 100 + (i * 97) % (LEVEL_WIDTH * 64 - 200);
+        const float y = 600 - (i % 7) * 13;
+        const bool isKoopa = i % 3 == 0;
+
+        auto enemy = entityManager.addEntity("Enemy");
+        enemy->addComponent<CAnimation>(walk, true);
+        enemy->addComponent<CBoundingBox>(isKoopa ? Vec2(64, 92) : Vec2(64, 64));
+        enemy->addComponent<CTransform>(Vec2(x, y), Vec2(i % 2 == 0 ? -ENEMY_KINEMATICS::GOOMBA_SPEED : ENEMY_KINEMATICS::GOOMBA_SPEED, 0), Vec2(i % 2 == 0 ? 1 : -1, 1), 0, 0, ENEMY_KINEMATICS::GRAVITY);
+        enemy->addComponent<CEnemy>(isKoopa ? EnemyType::KOOPA : EnemyType::GOOMBA, false, x - 64 * (i % 50));
+
+        // Some koopas are in their shell, and wake up during the test
+        if (isKoopa && i % 2 == 0)
+        {
+            enemy->getComponent<CAnimation>().animation = shell;
+            enemy->getComponent<CTransform>().velocity.x = 0;
+            enemy->addComponent<CLifeSpan>(1 + i % 120, 0);
+            enemy->addComponent<CBoundingBox>(Vec2(64, 64));
+        }
+    }
+
+    entityManager.update();
+}
+
+// Puts the world's tiles in a tile map (896 pixels high, so the floor is row 1, and walls row 2).
+static void buildTileMap(EntityManager & entityManager, TileMap & tileMap)
+{
+    tileMap.reset(Vec2(64, 64), 896);
+    const TileId ground = tileMap.addType("Ground", TILE_SOLID);
+
+    for (auto & tile : entityManager.getEntities("Tile"))
+    {
+        const Vec2 & pos = tile->getComponent<CTransform>().pos;
+        tileMap.setTile((int) (pos.x / 64), (int) ((896 - pos.y) / 64), ground);
+    }
+}
+
+static void simulate(EntityManager & entityManager, const Animation & walk, JobSystem * jobs, int frames, const TileMap * tileMap = nullptr)
+{
+    EntityVec & enemies = entityManager.getEntities("Enemy");
+    EntityVec & tiles = entityManager.getEntities("Tile");
+
+    for (int frame = 0; frame < frames; frame++)
+    {
+        const float playerX = frame * 40.f;
+        EnemySystems::updateStateAll(enemies, playerX, walk, jobs);
+        EnemySystems::moveAll(enemies, jobs);
+        if (tileMap != nullptr)
+        {
+            EnemySystems::collideWithTileMapAll(enemies, *tileMap, jobs);
+        }
+        else
+        {
+            EnemySystems::collideWithTilesAll(enemies, tiles, jobs);
+        }
+    }
+}
+
+static bool isSame(const CTransform & a, const CTransform & b)
+{
+    return std::memcmp(&a.pos, &b.pos, sizeof(Vec2)) == 0
+        && std::memcmp(&a.prevPos, &b.prevPos, sizeof(Vec2)) == 0
+        && std::memcmp(&a.velocity, &b.velocity, sizeof(Vec2)) == 0;
+}
+
+int main()
+{
+    sf::Texture t;
+    if (!t.create(128,64))
+    {
+        std::cout << "Could not create texture.\n";
+        return 0;
+    }
+
+    Animation walk("KoopaWalk", t, 2, 7);
+    Animation shell("KoopaShell", t);
+    const int FRAMES = 600;
+
+    // T1: parallel enemy update must be bit-identical to the serial one
+    EntityManager serialWorld;
+    EntityManager parallelWorld;
+    buildWorld(serialWorld, walk, shell);
+    buildWorld(parallelWorld, walk, shell);
+
+    JobSystem jobs(4);
+    simulate(serialWorld, walk, nullptr, FRAMES);
+    simulate(parallelWorld, walk, &jobs, FRAMES);
+
+    EntityVec & serialEnemies = serialWorld.getEntities("Enemy");
+    EntityVec & parallelEnemies = parallelWorld.getEntities("Enemy");
+    int mismatches = 0;
+    for (size_t i = 0; i < serialEnemies.size(); i++)
+    {
+        const bool isSameState = isSame(serialEnemies[i]->getComponent<CTransform>(), parallelEnemies[i]->getComponent<CTransform>())
+            && serialEnemies[i]->getComponent<CEnemy>().isActive == parallelEnemies[i]->getComponent<CEnemy>().isActive
+            && serialEnemies[i]->hasComponent<CLifeSpan>() == parallelEnemies[i]->hasComponent<CLifeSpan>()
+            && serialEnemies[i]->getComponent<CBoundingBox>().size == parallelEnemies[i]->getComponent<CBoundingBox>().size;
+
+        if (!isSameState)
+        {
+            mismatches++;
+        }
+    }
+    if (mismatches > 0)
+    {
+        std::cout << "T1: Error: " << mismatches << " enemies differ between serial and parallel update\n";
+    }
+
+    // T2: parallelFor must visit every index exactly once
+    std::vector<int> visits(10007, 0);
+    jobs.parallelFor(visits.size(), 64, [&visits](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            visits[i]++;
+        }
+    });
+    for (size_t i = 0; i < visits.size(); i++)
+    {
+        if (visits[i] != 1)
+        {
+            std::cout << "T2: Error: index " << i << " visited " << visits[i] << " times\n";
+            break;
+        }
+    }
+
+    // T3: enemy collisions against a tile map must match collisions against Tile entities
+    EntityManager tileMapWorld;
+    TileMap tileMap;
+    buildWorld(tileMapWorld, walk, shell);
+    buildTileMap(tileMapWorld, tileMap);
+    simulate(tileMapWorld, walk, nullptr, FRAMES, &tileMap);
+
+    EntityVec & tileMapEnemies = tileMapWorld.getEntities("Enemy");
+    mismatches = 0;
+    for (size_t i = 0; i < serialEnemies.size(); i++)
+    {
+        if (!isSame(serialEnemies[i]->getComponent<CTransform>(), tileMapEnemies[i]->getComponent<CTransform>()))
+        {
+            mismatches++;
+        }
+    }
+    if (mismatches > 0)
+    {
+        std::cout << "T3: Error: " << mismatches << " enemies differ between tile map and Tile entity collisions\n";
+    }
+
+    // T4: moving entities between tags keeps the same entities, and every list consistent
+    EntityManager moveWorld;
+    buildWorld(moveWorld, walk, shell);
+    EntityVec & movedFrom = moveWorld.getEntities("Enemy");
+    const size_t enemyCount = movedFrom.size();
+    std::vector<std::shared_ptr<Entity>> moved;
+    for (size_t i = 0; i < enemyCount; i += 3)
+    {
+        moveWorld.move(movedFrom[i], "Animation");
+        moved.push_back(movedFrom[i]);
+    }
+    moved.front()->destroy();
+    moveWorld.update();
+
+    EntityVec & movedTo = moveWorld.getEntities("Animation");
+    bool isMoveOk = movedTo.size() == moved.size() - 1 && movedFrom.size() == enemyCount - moved.size();
+    for (auto & e : movedTo)
+    {
+        isMoveOk = isMoveOk && e->tag() == "Animation" && e->isActive();
+    }
+    for (auto & e : movedFrom)
+    {
+        isMoveOk = isMoveOk && e->tag() == "Enemy";
+    }
+    if (!isMoveOk)
+    {
+        std::cout << "T4: Error: tag lists are wrong after moving entities\n";
+    }
+}
@@ -0,0 +1,474 @@
+#include "../src/PlayerKinematics.h"
+#include "../src/PhysicsConstants.h"
+#include <iostream>
+#include <cstring>
+#include <random>
+
+// The branching player state and movement code that PlayerKinematics replaced, kept as the reference.
+static void referenceUpdateState(const CTransform & cTransform, const CInput & cInput, CState & cState)
+{
+
+    const bool isAirborne      = !cState.isGrounded;
+    const bool isPressingLeft  = cInput.left;
+    const bool isPressingRight = cInput.right;
+    const bool isStandingStill = cTransform.velocity.x == 0;
+    const bool isMovingRight   = cTransform.velocity.x > 0;
+    const bool isMovingLeft    = cTransform.velocity.x < 0;
+
+    // Decelerating: speed is decreasing (going to zero)
+    // Accelerating: speed is increasing (going away from zero)
+    bool isDeceleratingLeft  = false; 
+    bool isDeceleratingRight = false; 
+    bool isAcceleratingLeft  = false;
+    bool isAcceleratingRight = false;
+    bool isSkidding          = false;
+    Direction newFacingDirection = cState.facingDir;
+
+    if (isAirborne)
+    {
+        const bool isChangingMovementDirection    = (isMovingLeft && (isPressingRight && !isPressingLeft)) || (isMovingRight && (isPressingLeft && !isPressingRight)); // turning only, doesn't include stopping
+        const bool isAboveInitialSpeedThresholdForVel = (cState.initialJumpXSpeed <= -AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL || cState.initialJumpXSpeed >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL);
+        const double maxXSpeed                    = isAboveInitialSpeedThresholdForVel ? AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL : AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL;
+        const bool isBellowMaxSpeed               = (cTransform.velocity.x < maxXSpeed) && (cTransform.velocity.x > -maxXSpeed);
+
+        isDeceleratingLeft  = (isMovingRight && isChangingMovementDirection);
+        isDeceleratingRight = (isMovingLeft && isChangingMovementDirection);
+        isAcceleratingLeft  = (isPressingLeft && !isPressingRight) && (isMovingLeft || isStandingStill) && isBellowMaxSpeed;
+        isAcceleratingRight = isPressingRight && !isPressingLeft && (isStandingStill || isMovingRight) && isBellowMaxSpeed;
+    }
+    else // grounded
+    {
+        const bool isRunning                    = cInput.B;
+        const bool isAtMaxWalkSpeed             = cTransform.velocity.x == GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x == -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
+        const bool isAtMaxRunSpeed              = cTransform.velocity.x == GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED || cTransform.velocity.x == -GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;
+        const bool isWalkingButPastMaxWalkSpeed = (cTransform.velocity.x > GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x < -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED) && !isRunning;
+        const bool isChangingMovementDirection  = (isMovingLeft && (isPressingRight || !isPressingLeft)) || (isMovingRight && (isPressingLeft || !isPressingRight)); // stopping, or turning
+        const bool isSkiddingInPreviousFrame    = cState.isSkidding;
+        
+        isDeceleratingLeft  = (isMovingRight && (isChangingMovementDirection || isWalkingButPastMaxWalkSpeed));
+        isDeceleratingRight = (isMovingLeft && (isChangingMovementDirection || isWalkingButPastMaxWalkSpeed));
+        isAcceleratingLeft  = (isPressingLeft && !isPressingRight) && (isMovingLeft || isStandingStill) && (!isAtMaxWalkSpeed || isRunning) && !isAtMaxRunSpeed && !isWalkingButPastMaxWalkSpeed;
+        isAcceleratingRight = isPressingRight && !isPressingLeft && (isStandingStill || isMovingRight) && (!isAtMaxWalkSpeed || isRunning) && !isAtMaxRunSpeed && !isWalkingButPastMaxWalkSpeed;
+        isSkidding          = ((isMovingRight && isPressingLeft && !isPressingRight) || (isMovingLeft && isPressingRight && !isPressingLeft)) || ((isDeceleratingLeft || isDeceleratingRight) && isSkiddingInPreviousFrame);
+
+        if (isSkidding)
+        {
+            if (isDeceleratingLeft)
+            {
+                newFacingDirection = Direction::LEFT;
+            }
+            else // decelerating right
+            {
+                newFacingDirection = Direction::RIGHT;
+            }
+        }
+        else if (cTransform.velocity.x < 0)
+        {
+            newFacingDirection = Direction::LEFT;
+        }
+        else if (cTransform.velocity.x > 0)
+        {
+            newFacingDirection = Direction::RIGHT;
+        }
+    }
+
+    if (isDeceleratingLeft)
+    {
+        cState.acceleration = Acceleration::DECELERATING_LEFT;
+    }
+    else if (isDeceleratingRight)
+    {
+        cState.acceleration = Acceleration::DECELERATING_RIGHT;
+    }
+    else if (isAcceleratingLeft)
+    {
+        cState.acceleration = Acceleration::ACCELERATING_LEFT;
+    }
+    else if (isAcceleratingRight)
+    {
+        cState.acceleration = Acceleration::ACCELERATING_RIGHT;
+    }
+    else
+    {
+        cState.acceleration = Acceleration::ZERO;
+    }
+
+    cState.isSkidding = isSkidding;
+    cState.facingDir = newFacingDirection;
+}
+
+static void referenceMoveAirborne(CTransform & cTransform, const CInput & cInput, const CState & cState)
+{
+
+    const bool isAboveInitialSpeedThresholdForVel = (cState.initialJumpXSpeed <= -AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL || cState.initialJumpXSpeed >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_VEL);
+    const bool isAboveCurrentSpeedThresholdForAcc = (cTransform.velocity.x <= -AIRBORNE_HORIZONTAL_KINEMATICS::CURRENT_SPEED_THRESHOLD_FOR_ACC || cTransform.velocity.x >= AIRBORNE_HORIZONTAL_KINEMATICS::CURRENT_SPEED_THRESHOLD_FOR_ACC);
+    const bool isAboveInitialSpeedThresholdForAcc = (cState.initialJumpXSpeed <= -AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_ACC || cState.initialJumpXSpeed >= AIRBORNE_HORIZONTAL_KINEMATICS::INITIAL_SPEED_THRESHOLD_FOR_ACC);
+
+    // Step 1: Figure out X acceleration for current frame
+    double accelerationX = 0;
+    if (isAboveCurrentSpeedThresholdForAcc)
+    {
+        accelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_CST_ACC;
+    }
+    else
+    {
+        accelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::BELOW_CST_ACC;
+    }
+    double decelerationX = 0;
+    if (isAboveCurrentSpeedThresholdForAcc)
+    {
+        decelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_CST_DEC;
+    }
+    else if (isAboveInitialSpeedThresholdForAcc)
+    {
+        decelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_DEC;
+    }
+    else
+    {
+        decelerationX = AIRBORNE_HORIZONTAL_KINEMATICS::BELOW_IST_DEC;
+    }
+
+    if (cState.acceleration == Acceleration::ACCELERATING_LEFT)
+    {
+        cTransform.acc_x = -accelerationX;
+    }
+    else if (cState.acceleration == Acceleration::ACCELERATING_RIGHT)
+    {
+        cTransform.acc_x = accelerationX;
+    }
+    else if (cState.acceleration == Acceleration::DECELERATING_LEFT)
+    {
+        cTransform.acc_x = -decelerationX;
+    }
+    else if (cState.acceleration == Acceleration::DECELERATING_RIGHT)
+    {
+        cTransform.acc_x = decelerationX;
+    }
+    else
+    {
+        cTransform.acc_x = 0;
+    }
+
+    // Step 2: Use X acceleration to calculate X velocity
+    cTransform.velocity.x += cTransform.acc_x;
+
+    // Step 3: Apply speed limits or exception for X velocity
+    if (isAboveInitialSpeedThresholdForVel)
+    {
+        if (cTransform.velocity.x > AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL)
+        {
+            cTransform.velocity.x = AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL;
+        }
+        else if (cTransform.velocity.x < -AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL)
+        {
+            cTransform.velocity.x = -AIRBORNE_HORIZONTAL_KINEMATICS::ABOVE_IST_SPEED_LIMIT_VEL;
+        }
+    }
+    else
+    {
+        if (cTransform.velocity.x > AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL)
+        {
+            cTransform.velocity.x = AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL;
+        }
+        else if (cTransform.velocity.x < -AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL)
+        {
+            cTransform.velocity.x = -AIRBORNE_HORIZONTAL_KINEMATICS::BELLOW_ISP_SPEED_LIMIT_VEL;
+        }
+    }
+    
+    const bool isPressingJump                         = cInput.A;
+    const bool hadReducedGravity                      = (cTransform.acc_y == AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_S) || (cTransform.acc_y == AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_M);
+    const bool isFalling                              = (cTransform.velocity.y >= 0);
+    const bool isJustStartingNormalGravityPhaseOfJump = hadReducedGravity && (!isPressingJump || isFalling);
+
+    // Step 4: Figure out Y acceleration
+    if (isJustStartingNormalGravityPhaseOfJump)
+    {
+        if (cTransform.acc_y == AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_S)
+        {
+            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_S;
+        }
+        else if (cTransform.acc_y == AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_M)
+        {
+            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_M;
+        }
+        else
+        {
+            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_L;
+        }
+    }
+
+    // Step 5: Use Y acceleration to calculate Y velocity
+    cTransform.velocity.y += cTransform.acc_y;
+
+    // Step 6: Apply speed limits or exception for Y velocity
+    if (cTransform.velocity.y > AIRBORNE_VERTICAL_KINEMATICS::MAX_DOWNWARD_SPEED)
+    {
+        cTransform.velocity.y = AIRBORNE_VERTICAL_KINEMATICS::RESET_DOWNWARD_SPEED;
+    }
+
+    // Step 7: Use velocity to calculate player position
+    cTransform.prevPos =  cTransform.pos;
+    cTransform.pos += cTransform.velocity;
+}
+
+static void referenceMoveGrounded(CTransform & cTransform, CInput & cInput, CState & cState)
+{
+
+    const bool isRunning       = cInput.B;
+    const bool isWalking       = !cInput.B;
+    const bool isSkidding      = cState.isSkidding;
+
+    // Decelerating: speed is decreasing (going to zero)
+    // Accelerating: speed is increasing (going away from zero)
+    const bool isDeceleratingLeft  = (cState.acceleration == Acceleration::DECELERATING_LEFT);
+    const bool isDeceleratingRight = (cState.acceleration == Acceleration::DECELERATING_RIGHT);
+    const bool isAcceleratingLeft  = (cState.acceleration == Acceleration::ACCELERATING_LEFT);
+    const bool isAcceleratingRight = (cState.acceleration == Acceleration::ACCELERATING_RIGHT);
+
+    // Step 1: Figure out X acceleration for current frame
+    double accelerationX = 0;
+    if (isRunning)
+    {
+        accelerationX = GROUNDED_HORIZONTAL_KINEMATICS::RUN_ACC;
+    }
+    else
+    {
+        accelerationX = GROUNDED_HORIZONTAL_KINEMATICS::WALK_ACC;
+    }
+    double decelerationX = 0;
+    if (isSkidding) 
+    {
+        decelerationX = GROUNDED_HORIZONTAL_KINEMATICS::SKID_DEC;
+    }
+    else
+    {
+        decelerationX = GROUNDED_HORIZONTAL_KINEMATICS::RELEASE_DEC;
+    }
+
+    if (isDeceleratingRight)
+    {
+        cTransform.acc_x = decelerationX;
+    }
+    else if (isDeceleratingLeft)
+    {
+        cTransform.acc_x = -decelerationX;
+    }
+    else if (isAcceleratingRight)
+    {
+        cTransform.acc_x = accelerationX;
+    }
+    else if (isAcceleratingLeft)
+    {
+        cTransform.acc_x = -accelerationX;
+    }
+    else
+    {
+        cTransform.acc_x = 0;
+    }
+
+    // Step 2: Use X acceleration to calculate X velocity
+    cTransform.velocity.x += cTransform.acc_x;
+
+    const bool isPastMaxWalkSpeed      = cTransform.velocity.x > GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED || cTransform.velocity.x < -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
+    const bool isPastMaxRunSpeed       = cTransform.velocity.x > GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED || cTransform.velocity.x < -GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;
+    const bool isBellowMinWalkSpeed    = cTransform.velocity.x < GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED && cTransform.velocity.x > -GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED;
+    const bool isBellowTurnAroundSpeed = cTransform.velocity.x < GROUNDED_HORIZONTAL_KINEMATICS::SKID_TURNAROUND_SPEED && cTransform.velocity.x > -GROUNDED_HORIZONTAL_KINEMATICS::SKID_TURNAROUND_SPEED;
+
+    // Step 3: Apply speed limits or exception for X velocity
+    // Mario is walking right and past max walk speed
+    if (isPastMaxWalkSpeed && isAcceleratingRight && isWalking)
+    {
+        cTransform.velocity.x = GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
+    }
+    // Mario is walking left and past max walk speed
+    else if (isPastMaxWalkSpeed && isAcceleratingLeft && isWalking)
+    {
+        cTransform.velocity.x = -GROUNDED_HORIZONTAL_KINEMATICS::MAX_WALK_SPEED;
+    }
+    // Mario is running right and past max run speed
+    else if (isPastMaxRunSpeed && isAcceleratingRight && isRunning)
+    {
+        cTransform.velocity.x = GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;   
+    }
+    // Mario is running left and past max run speed
+    else if (isPastMaxRunSpeed && isAcceleratingLeft && isRunning)
+    {
+        cTransform.velocity.x = -GROUNDED_HORIZONTAL_KINEMATICS::MAX_RUN_SPEED;   
+    }
+    // Mario is accelerating right and is bellow min x speed
+    else if (isBellowMinWalkSpeed && isAcceleratingRight)
+    {
+        cTransform.velocity.x = GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED;
+    }
+    // Mario is accelerating left and is bellow min x speed
+    else if (isBellowMinWalkSpeed && isAcceleratingLeft)
+    {
+        cTransform.velocity.x = -GROUNDED_HORIZONTAL_KINEMATICS::MIN_WALK_SPEED;
+    }
+    // Mario is decelerating and is bellow min x speed
+    else if ((isBellowMinWalkSpeed || (isBellowTurnAroundSpeed && isSkidding)) && (isDeceleratingLeft || isDeceleratingRight))
+    {
+        cTransform.velocity.x = 0;
+    }
+
+    const double xSpeed                  = cTransform.velocity.x;
+    const bool canJump                   = cInput.canJump;
+    const bool isPressingJump            = cInput.A;
+    const bool isAtSmallHorizontalSpeed  = (AIRBORNE_VERTICAL_KINEMATICS::SMALL_SPEED_THRESHOLD > xSpeed) && (-AIRBORNE_VERTICAL_KINEMATICS::SMALL_SPEED_THRESHOLD < xSpeed);
+    const bool isAtMediumHorizontalSpeed = (AIRBORNE_VERTICAL_KINEMATICS::MEDIUM_SPEED_THRESHOLD >= xSpeed) && (-AIRBORNE_VERTICAL_KINEMATICS::MEDIUM_SPEED_THRESHOLD <= xSpeed) && (!isAtSmallHorizontalSpeed);
+    const bool isJustStartingJump        = canJump && isPressingJump;
+
+    // Step 4: Check if player is about to jump
+    if (isJustStartingJump)
+    {
+        if (isAtSmallHorizontalSpeed)
+        {
+            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_S;
+        }
+        else if (isAtMediumHorizontalSpeed)
+        {
+            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_M;
+        }
+        else
+        {
+            cTransform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::REDUCED_GRAVITY_L;
+        }
+    }
+
+    // Step 5: Use Y acceleration to calculate Y velocity
+    cTransform.velocity.y += cTransform.acc_y;
+
+    // Step 6: Apply speed limits or exception for Y velocity
+    if (isJustStartingJump)
+    {
+        if (isAtSmallHorizontalSpeed)
+        {
+            cTransform.velocity.y = -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_S;
+        }
+        else if (isAtMediumHorizontalSpeed)
+        {
+            cTransform.velocity.y = -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_M;
+        }
+        else
+        {
+            cTransform.velocity.y = -AIRBORNE_VERTICAL_KINEMATICS::INITIAL_VELOCITY_L;
+        }
+
+        cInput.canJump = false;
+        cState.initialJumpXSpeed = cTransform.velocity.x;
+        cState.isGrounded = false;
+    }
+
+    // Step 7: Use velocity to calculate player position
+    cTransform.prevPos =  cTransform.pos;
+    cTransform.pos += cTransform.velocity;
+}
+
+struct Agent
+{
+    CTransform transform;
+    CInput     input;
+    CState     state;
+};
+
+static bool isSame(const Agent & a, const Agent & b)
+{
+    return std::memcmp(&a.transform.pos, &b.transform.pos, sizeof(Vec2)) == 0
+        && std::memcmp(&a.transform.prevPos, &b.transform.prevPos, sizeof(Vec2)) == 0
+        && std::memcmp(&a.transform.velocity, &b.transform.velocity, sizeof(Vec2)) == 0
+        && std::memcmp(&a.transform.acc_x, &b.transform.acc_x, sizeof(double)) == 0
+        && std::memcmp(&a.transform.acc_y, &b.transform.acc_y, sizeof(double)) == 0
+        && std::memcmp(&a.state.initialJumpXSpeed, &b.state.initialJumpXSpeed, sizeof(float)) == 0
+        && a.state.isGrounded == b.state.isGrounded
+        && a.state.isSkidding == b.state.isSkidding
+        && a.state.facingDir == b.state.facingDir
+        && a.state.acceleration == b.state.acceleration
+        && a.input.canJump == b.input.canJump;
+}
+
+// Stands in for the collision system: lands agents on a floor, and sometimes walks them off a ledge.
+static void collide(Agent & agent, bool isLedge)
+{
+    const float FLOOR_Y = 800;
+    if (!agent.state.isGrounded && agent.transform.pos.y >= FLOOR_Y && agent.transform.velocity.y >= 0)
+    {
+        agent.transform.pos.y = FLOOR_Y;
+        agent.transform.velocity.y = 0;
+        agent.state.isGrounded = true;
+    }
+    else if (agent.state.isGrounded && isLedge)
+    {
+        agent.state.isGrounded = false;
+    }
+}
+
+int main()
+{
+    const int AGENTS = 2000;
+    const int FRAMES = 2000;
+    const float START_SPEEDS[] = { 0, 0.296875f, 2.25f, 4, 6.25f, 7.25f, 9.2490234375f, 9.25f, 10.25f, 12, 3.9f, 9.3f };
+
+    std::mt19937 random(12345);
+    std::vector<Agent> reference(AGENTS);
+    for (int i = 0; i < AGENTS; i++)
+    {
+        Agent & agent = reference[i];
+        const float speed = START_SPEEDS[i % (sizeof(START_SPEEDS) / sizeof(float))];
+        agent.transform.pos = Vec2(0, 800);
+        agent.transform.velocity.x = i % 2 == 0 ? speed : -speed;
+        agent.transform.acc_y = AIRBORNE_VERTICAL_KINEMATICS::GRAVITY_S;
+        agent.state.isGrounded = i % 3 != 0;
+        agent.state.initialJumpXSpeed = i % 3 == 0 ? agent.transform.velocity.x : 0;
+    }
+    std::vector<Agent> tables = reference;
+
+    // T1: table driven kinematics must be bit-identical to the branching code, for random input
+    int mismatches = 0;
+    for (int frame = 0; frame < FRAMES && mismatches == 0; frame++)
+    {
+        for (int i = 0; i < AGENTS; i++)
+        {
+            // Hold each input for a few frames at a time
+            if (random() % 8 == 0)
+            {
+                const unsigned int buttons = random();
+                CInput & input = reference[i].input;
+                input.left = buttons & 1;
+                input.right = buttons & 2;
+                input.B = buttons & 4;
+                input.A = (buttons & 24) != 0;
+                if (!input.A)
+                {
+                    input.canJump = true;
+                }
+                tables[i].input = input;
+            }
+            const bool isLedge = random() % 200 == 0;
+
+            Agent & a = reference[i];
+            referenceUpdateState(a.transform, a.input, a.state);
+            if (!a.state.isGrounded)
+            {
+                referenceMoveAirborne(a.transform, a.input, a.state);
+            }
+            else
+            {
+                referenceMoveGrounded(a.transform, a.input, a.state);
+            }
+            collide(a, isLedge);
+
+            Agent & b = tables[i];
+            PlayerKinematics::updateState(b.transform, b.input, b.state);
+            PlayerKinematics::move(b.transform, b.input, b.state);
+            collide(b, isLedge);
+
+            if (!isSame(a, b))
+            {
+                std::cout << "T1: Error: agent " << i << " differs from the reference on frame " << frame << "\n";
+                mismatches++;
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#include "../src/RewindBuffer.h"
+#include <iostream>
+
+static const char * ANIMATIONS[] = { "Ground", "Brick", "QuestionMarkBlink", "QuestionMarkBlockHit", "MarioRun", "GoombaWalk", "BushFront" };
+
+// A small level: a row of Tile entities, a bush, tile map cells, a player, and goombas
+static void buildLevel(World & world, const Assets & assets)
+{
+    EntityManager & entityManager = world.entityManager;
+    world.tileMap.reset(Vec2(64, 64), 896);
+    const TileId ground = world.tileMap.addType("Ground", TILE_SOLID);
+    const TileId question = world.tileMap.addType("QuestionMarkBlink", TILE_SOLID | TILE_QUESTION);
+    world.tileAnimations = { Animation(), assets.getAnimation("Ground"), assets.getAnimation("QuestionMarkBlink") };
+
+    for (int gx = 0; gx < 30; gx++)
+    {
+        world.tileMap.setTile(gx, 0, ground);
+        world.tileMap.setTile(gx, 4, gx % 5 == 0 ? question : ground);
+
+        auto tile = entityManager.addEntity("Tile");
+        tile->addComponent<CTransform>(Vec2(gx * 64 + 32, 896 - 5 * 64 - 32));
+        tile->addComponent<CBoundingBox>(Vec2(64, 64));
+        tile->addComponent<CTile>().flags = TILE_SOLID | TILE_BREAKABLE;
+        tile->addComponent<CAnimation>(assets.getAnimation("Brick"), true);
+    }
+
+    auto bush = entityManager.addEntity("Decoration");
+    bush->addComponent<CTransform>(Vec2(300, 800));
+    bush->addComponent<CAnimation>(assets.getAnimation("BushFront"), true);
+
+    world.player = entityManager.addEntity("Player");
+    world.player->addComponent<CTransform>(Vec2(100, 700));
+    world.player->addComponent<CBoundingBox>(Vec2(48, 64));
+    world.player->addComponent<CAnimation>(assets.getAnimation("MarioRun"), true);
+
+    for (int i = 0; i < 3; i++)
+    {
+        auto goomba = entityManager.addEntity("Enemy");
+        goomba->addComponent<CTransform>(Vec2(600 + i * 200, 800));
+        goomba->addComponent<CAnimation>(assets.getAnimation("GoombaWalk"), true);
+    }
+    entityManager.update();
+}
+
+// Plays a frame, with something for the rewind buffer to save in most of them
+static void step(World & world, const Assets & assets)
+{
+    EntityManager & entityManager = world.entityManager;
+    const size_t frame = world.currentFrame;
+
+    for (auto & e : entityManager.getEntities())
+    {
+        e->getComponent<CAnimation>().animation.update();
+    }
+    for (auto & animation : world.tileAnimations)
+    {
+        animation.update();
+    }
+
+    // Only every other goomba moves, so some entities are saved as unchanged
+    world.player->getComponent<CTransform>().pos.x += 3;
+    for (auto & e : entityManager.getEntities("Enemy"))
+    {
+        if (frame % 2 == 0)
+        {
+            e->getComponent<CTransform>().pos.x -= 2;
+        }
+    }
+    world.cameraPosition.x = world.player->getComponent<CTransform>().pos.x;
+
+    if (frame == 30) // a static tile is destroyed
+    {
+        entityManager.getEntities("Tile")[4]->destroy();
+    }
+    if (frame == 40) // a static tile changes animation
+    {
+        entityManager.getEntities("Tile")[7]->addComponent<CAnimation>(assets.getAnimation("QuestionMarkBlockHit"), false);
+    }
+    if (frame == 45) // a cell is emptied, and another added
+    {
+        world.tileMap.setTile(10, 4, TileMap::EMPTY);
+        world.tileMap.setTile(12, 7, world.tileMap.getTypeId("Ground"));
+    }
+    if (frame == 55) // a goomba dies
+    {
+        entityManager.getEntities("Enemy")[1]->destroy();
+    }
+    if (frame == 65) // a coin pops out of a block
+    {
+        auto coin = entityManager.addEntity("Decoration");
+        coin->addComponent<CTransform>(Vec2(640, 500));
+        coin->addComponent<CAnimation>(assets.getAnimation("QuestionMarkBlink"), false);
+    }
+
+    entityManager.update();
+
+    // Left pending when the frame is saved
+    if (frame % 10 == 9)
+    {
+        auto e = entityManager.addEntity("Enemy");
+        e->addComponent<CTransform>(Vec2(1000, 800));
+        e->addComponent<CAnimation>(assets.getAnimation("GoombaWalk"), true);
+    }
+    if (frame % 10 == 0 && !entityManager.getEntities("Enemy").empty())
+    {
+        entityManager.move(entityManager.getEntities("Enemy").back(), "Shell");
+    }
+
+    world.currentFrame++;
+}
+
+int main()
+{
+    Assets assets;
+    for (const char * name : ANIMATIONS)
+    {
+        sf::Image image;
+        image.create(64 * 4, 64);
+        assets.addTexture(name, image);
+        assets.addAnimation(name, Animation(name, assets.getTexture(name), 4, 3));
+    }
+
+    EntityManager entityManager;
+    TileMap tileMap;
+    Vec2 cameraPosition;
+    size_t currentFrame = 0;
+    std::shared_ptr<Entity> player;
+    std::vector<Animation> tileAnimations;
+    World world { entityManager, tileMap, cameraPosition, currentFrame, player, tileAnimations };
+    buildLevel(world, assets);
+
+    RewindBuffer buffer;
+    buffer.setCapacity(200);
+    ByteVec saved50;
+    ByteVec saved70;
+    for (int frame = 0; frame < 90; frame++)
+    {
+        buffer.record(world);
+        if (currentFrame == 50)
+        {
+            saved50 = buffer.save(world);
+        }
+        if (currentFrame == 70)
+        {
+            saved70 = buffer.save(world);
+        }
+        step(world, assets);
+    }
+
+    // T1: rewinding to a frame after a keyframe must restore the world saved at that frame
+    if (!buffer.rewind(19, world, assets) || currentFrame != 70 || buffer.save(world) != saved70)
+    {
+        std::cout << "T1: Error: rewinding to frame 70 restored frame " << currentFrame << ", or a different world\n";
+    }
+
+    // T2: the same, back to the first keyframe, from before the static tile was destroyed
+    if (!buffer.rewind(20, world, assets) || currentFrame != 50 || buffer.save(world) != saved50)
+    {
+        std::cout << "T2: Error: rewinding to frame 50 restored frame " << currentFrame << ", or a different world\n";
+    }
+
+    // T3: playing on from a rewound frame must play out as it did
+    for (int frame = 50; frame < 70; frame++)
+    {
+        buffer.record(world);
+        step(world, assets);
+    }
+    if (buffer.save(world) != saved70)
+    {
+        std::cout << "T3: Error: the world played on from frame 50 differs at frame 70\n";
+    }
+
+    // T4: a loaded save state must save the same
+    if (!buffer.load(saved50, world, assets) || buffer.save(world) != saved50)
+    {
+        std::cout << "T4: Error: loading the state of frame 50 did not restore it\n";
+    }
+
+    // T5: damaged save states must not load, and must leave the world as it was
+    std::vector<ByteVec> damaged;
+    damaged.emplace_back(saved70.begin(), saved70.end() - 3); // cut short
+    damaged.emplace_back(saved70.begin(), saved70.begin() + saved70.size() / 2);
+    damaged.push_back(saved70);
+    damaged.back()[8] = damaged.back()[9] = 0; // no names
+    damaged.push_back(saved70);
+    damaged.back()[0]++; // another version
+    for (size_t i = 0; i < damaged.size(); i++)
+    {
+        if (buffer.load(damaged[i], world, assets) || buffer.save(world) != saved50)
+        {
+            std::cout << "T5: Error: damaged save state " << i << " was loaded\n";
+        }
+    }
+}